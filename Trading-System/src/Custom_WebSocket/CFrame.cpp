@@ -0,0 +1,269 @@
+#include "../Custom_WebSocket/CFrame.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <chrono>
+#include <immintrin.h>
+#include <openssl/sha.h>
+#include <openssl/rand.h>
+#include <arpa/inet.h>  // for htons
+
+namespace CustomWebSocket {
+
+// Helper: Base64 encode a given binary string
+static std::string base64Encode(const std::string& input) {
+    static const char* b64_chars =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string output;
+    output.reserve(((input.size() + 2) / 3) * 4);
+    unsigned val = 0;
+    int valb = -6;
+    for (uint8_t c : input) {
+        val = (val << 8) + c;
+        valb += 8;
+        while (valb >= 0) {
+            output.push_back(b64_chars[(val >> valb) & 0x3F]);
+            valb -= 6;
+        }
+    }
+    if (valb > -6) {
+        output.push_back(b64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
+    }
+    while (output.size() % 4) {
+        output.push_back('=');
+    }
+    return output;
+}
+
+// Generate Sec-WebSocket-Accept given a Sec-WebSocket-Key
+static std::string generateAcceptKey(const std::string& key) {
+    std::string magic = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    std::string input = key + magic;
+    unsigned char hash[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(input.c_str()), input.size(), hash);
+    std::string hashed(reinterpret_cast<char*>(hash), SHA_DIGEST_LENGTH);
+    return base64Encode(hashed);
+}
+
+void parseUrl(const std::string& url, std::string& host, std::string& port, std::string& path, bool& secure) {
+    host = url;
+    path = "/";
+    port = "443";
+    secure = true;
+    // Strip scheme
+    if (host.rfind("wss://", 0) == 0) {
+        host = host.substr(6);
+    } else if (host.rfind("ws://", 0) == 0) {
+        host = host.substr(5);
+        port = "80";
+        secure = false;
+    }
+    // Split host and path
+    size_t pos = host.find('/');
+    if (pos != std::string::npos) {
+        path = host.substr(pos);
+        host = host.substr(0, pos);
+    }
+    // Optional explicit port: host:port
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+        port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+    }
+}
+
+std::string makeSecKey() {
+    // 16 random bytes, base64
+    unsigned char randKey[16];
+    RAND_bytes(randKey, 16);
+    return base64Encode(std::string(reinterpret_cast<char*>(randKey), 16));
+}
+
+std::string upgradeRequest(const std::string& host, const std::string& path, const std::string& secKey) {
+    std::ostringstream req;
+    req << "GET " << path << " HTTP/1.1\r\n"
+        << "Host: " << host << "\r\n"
+        << "Upgrade: websocket\r\n"
+        << "Connection: Upgrade\r\n"
+        << "Sec-WebSocket-Key: " << secKey << "\r\n"
+        << "Sec-WebSocket-Version: 13\r\n"
+        << "\r\n";
+    return req.str();
+}
+
+bool checkUpgradeResponse(std::string_view response, const std::string& secKey) {
+    std::string_view responseLine = response.substr(0, response.find("\r\n"));
+    if (responseLine.find("101") == std::string_view::npos) {
+        std::cerr << "WebSocket handshake failed: " << responseLine << std::endl;
+        return false;
+    }
+    std::string acceptKey;
+    static constexpr std::string_view ACCEPT_HEADER = "Sec-WebSocket-Accept:";
+    size_t pos = response.find(ACCEPT_HEADER);
+    if (pos != std::string_view::npos) {
+        size_t begin = response.find_first_not_of(' ', pos + ACCEPT_HEADER.size());
+        size_t end = response.find("\r\n", begin);
+        acceptKey = std::string(response.substr(begin, end - begin));
+    }
+    std::string expectedAccept = generateAcceptKey(secKey);
+    if (acceptKey != expectedAccept) {
+        std::cerr << "Sec-WebSocket-Accept mismatch, expected " << expectedAccept
+                  << ", got " << acceptKey << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Copy src to dst XOR-ing the frame mask (RFC 6455 5.3), 8 bytes at a time
+static void maskCopyScalar(char* dst, const char* src, size_t len, const uint8_t mask[4]) {
+    uint32_t key32;
+    std::memcpy(&key32, mask, 4);
+    uint64_t key64 = (static_cast<uint64_t>(key32) << 32) | key32;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, src + i, 8);
+        v ^= key64;
+        std::memcpy(dst + i, &v, 8);
+    }
+    for (; i < len; ++i) {
+        dst[i] = static_cast<char>(src[i] ^ mask[i % 4]);
+    }
+}
+
+// 16 bytes at a time (SSE2 is part of x86-64)
+static void maskCopySse2(char* dst, const char* src, size_t len, const uint8_t mask[4]) {
+    uint32_t key32;
+    std::memcpy(&key32, mask, 4);
+    __m128i key = _mm_set1_epi32(static_cast<int>(key32));
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(v, key));
+    }
+    // i is a multiple of 4, so the mask phase carries over
+    maskCopyScalar(dst + i, src + i, len - i, mask);
+}
+
+__attribute__((target("avx2")))
+static void maskCopyAvx2(char* dst, const char* src, size_t len, const uint8_t mask[4]) {
+    uint32_t key32;
+    std::memcpy(&key32, mask, 4);
+    __m256i key = _mm256_set1_epi32(static_cast<int>(key32));
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(v, key));
+    }
+    maskCopySse2(dst + i, src + i, len - i, mask);
+}
+
+using MaskCopyFn = void (*)(char*, const char*, size_t, const uint8_t*);
+
+static MaskCopyFn selectMaskCopy() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &maskCopyAvx2 : &maskCopySse2;
+}
+
+static const MaskCopyFn maskCopyImpl = selectMaskCopy();
+
+void maskCopy(char* dst, const char* src, size_t len, const uint8_t mask[4]) {
+    maskCopyImpl(dst, src, len, mask);
+}
+
+// Convert 64-bit value from host to network byte order
+static uint64_t hostToNetwork64(uint64_t val) {
+    uint64_t result = 0;
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&val);
+    // Append bytes in reverse order (big-endian)
+    for (int i = 0; i < 8; ++i) {
+        result = (result << 8) | bytes[i];
+    }
+    return result;
+}
+
+size_t writeFrameHeader(uint8_t* header, uint8_t opcode, size_t length, const uint8_t mask[4]) {
+    size_t headerLen = 0;
+    header[0] = 0x80 | opcode; // FIN=1
+    // Determine payload length
+    if (length <= 125) {
+        header[1] = static_cast<uint8_t>(length) | 0x80;
+        headerLen = 2;
+    } else if (length <= 0xFFFF) {
+        header[1] = 126 | 0x80;
+        uint16_t lenN = htons(static_cast<uint16_t>(length));
+        std::memcpy(header + 2, &lenN, 2);
+        headerLen = 4;
+    } else {
+        header[1] = 127 | 0x80;
+        uint64_t lenN = hostToNetwork64(static_cast<uint64_t>(length));
+        std::memcpy(header + 2, &lenN, 8);
+        headerLen = 10;
+    }
+    std::memcpy(header + headerLen, mask, 4);
+    return headerLen + 4;
+}
+
+size_t parseFrameHeader(const uint8_t* p, size_t avail, FrameHeader& frame) {
+    if (avail < 2) return 0;
+    frame.fin = (p[0] & 0x80) != 0;
+    frame.opcode = p[0] & 0x0F;
+    frame.masked = (p[1] & 0x80) != 0;
+    uint64_t payloadLen = p[1] & 0x7F;
+    size_t pos = 2;
+    if (payloadLen == 126) {
+        if (avail < 4) return 0;
+        payloadLen = (static_cast<uint64_t>(p[2]) << 8) | p[3];
+        pos = 4;
+    } else if (payloadLen == 127) {
+        if (avail < 10) return 0;
+        payloadLen = 0;
+        for (int i = 0; i < 8; ++i) {
+            payloadLen = (payloadLen << 8) | p[2 + i];
+        }
+        pos = 10;
+        frame.payloadLen = payloadLen;
+        if (payloadLen >> 63) {
+            frame.closeCode = CLOSE_PROTOCOL_ERROR;
+            return INVALID_FRAME;
+        }
+    }
+    // Checked before the caller adds the header length or grows its buffer
+    if (payloadLen > MAX_MESSAGE_SIZE) {
+        frame.payloadLen = payloadLen;
+        frame.closeCode = CLOSE_MESSAGE_TOO_BIG;
+        return INVALID_FRAME;
+    }
+    if (frame.masked) {
+        // Server frames should not be masked, but accept them
+        if (avail < pos + 4) return 0;
+        std::memcpy(frame.maskKey, p + pos, 4);
+        pos += 4;
+    }
+    frame.payloadLen = payloadLen;
+    return pos;
+}
+
+void closePayload(uint16_t code, char out[2]) {
+    out[0] = static_cast<char>(code >> 8);
+    out[1] = static_cast<char>(code & 0xFF);
+}
+
+MaskKeys::MaskKeys() {
+    // Seed the mask generator once from the CSPRNG
+    if (RAND_bytes(reinterpret_cast<unsigned char*>(&state), sizeof(state)) != 1 || state == 0) {
+        state = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) | 1;
+    }
+}
+
+uint32_t MaskKeys::next() {
+    // xorshift64*: a few cycles, never blocks
+    uint64_t x = state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    state = x;
+    return static_cast<uint32_t>((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+} // namespace CustomWebSocket
@@ -0,0 +1,73 @@
+#ifndef CFRAME_HPP
+#define CFRAME_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// WebSocket client handshake and framing (RFC 6455), shared by the
+// hand-rolled transports
+namespace CustomWebSocket {
+
+// Decoded WebSocket frame header
+struct FrameHeader {
+    bool fin;
+    uint8_t opcode;
+    bool masked;
+    uint8_t maskKey[4];
+    uint64_t payloadLen;
+    // Close code to fail the connection with when the header is rejected
+    uint16_t closeCode;
+};
+
+// Largest client frame header: 2 + 8 byte length + 4 byte mask
+constexpr size_t MAX_HEADER_LEN = 14;
+// Largest payload accepted in one frame, and in one reassembled message
+constexpr uint64_t MAX_MESSAGE_SIZE = 64ull << 20;
+// parseFrameHeader result for a frame the connection must be failed on
+constexpr size_t INVALID_FRAME = static_cast<size_t>(-1);
+// RFC 6455 close codes
+constexpr uint16_t CLOSE_PROTOCOL_ERROR = 1002;
+constexpr uint16_t CLOSE_MESSAGE_TOO_BIG = 1009;
+
+// Parse a frame header at p; returns its length, 0 if more bytes are needed,
+// or INVALID_FRAME (with frame.closeCode set) if the length is not allowed:
+// a 64-bit length with the top bit set, or a payload over MAX_MESSAGE_SIZE
+size_t parseFrameHeader(const uint8_t* p, size_t avail, FrameHeader& frame);
+// Payload of a close frame carrying code
+void closePayload(uint16_t code, char out[2]);
+
+// Write a masked client frame header (FIN set); returns its length
+size_t writeFrameHeader(uint8_t* out, uint8_t opcode, size_t length, const uint8_t mask[4]);
+
+// Copy src to dst XOR-ing the frame mask; dst may equal src. Vectorized
+// with AVX2 or SSE2, chosen once for the CPU.
+void maskCopy(char* dst, const char* src, size_t len, const uint8_t mask[4]);
+
+// Frame mask keys: xorshift64*, seeded once from the CSPRNG. Not
+// thread-safe; callers serialize sends anyway.
+class MaskKeys {
+public:
+    MaskKeys();
+    uint32_t next();
+
+private:
+    uint64_t state;
+};
+
+// Split ws[s]://host[:port]/path; secure is false only for ws://, the port
+// defaults to 443 (80 for ws://) and the path to /
+void parseUrl(const std::string& url, std::string& host, std::string& port, std::string& path, bool& secure);
+
+// Random Sec-WebSocket-Key
+std::string makeSecKey();
+// HTTP upgrade request for host/path
+std::string upgradeRequest(const std::string& host, const std::string& path, const std::string& secKey);
+// Check the response headers (up to and including the blank line);
+// logs and returns false if the upgrade was refused
+bool checkUpgradeResponse(std::string_view response, const std::string& secKey);
+
+} // namespace CustomWebSocket
+
+#endif // CFRAME_HPP
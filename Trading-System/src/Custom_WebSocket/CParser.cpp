@@ -1,88 +1,27 @@
 #include "CParser.hpp"
-#include <iostream>
+#include "../WebSocketpp/Dispatch.hpp"
 
-using json = nlohmann::json;
+bool CParser::parseMessage(std::string_view rawMessage, CParserListener& listener) {
+    if (!parser.parse(rawMessage, message)) return false;
 
-CParser::CParser() {}
-
-CParser::~CParser() {}
-
-json CParser::parseMessage(const std::string& rawMessage) {
-    try {
-        if (!isValidJson(rawMessage)) {
-            throw std::runtime_error("Invalid JSON format");
-        }
-        return json::parse(rawMessage);
-    } catch (const std::exception& e) {
-        std::cerr << "❌ Error parsing message: " << e.what() << std::endl;
-        return json();  // Return empty JSON on failure
+    if (message.kind == DeribitMessage::Kind::Error) {
+        listener.onError(message.errorCode, message.errorMessage);
+        return true;
     }
-}
 
-std::vector<std::pair<double, double>> CParser::extractOrderBook(const json& parsedJson) {
-    std::vector<std::pair<double, double>> orderBook;
-
-    try {
-        if (parsedJson.contains("params") && parsedJson["params"].contains("data")) {
-            for (const auto& entry : parsedJson["params"]["data"]) {
-                if (entry.contains("price") && entry.contains("amount")) {
-                    double price = entry["price"].get<double>();
-                    double amount = entry["amount"].get<double>();
-                    orderBook.emplace_back(price, amount);
-                }
-            }
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "❌ Error extracting order book: " << e.what() << std::endl;
+    for (const auto& trade : message.trades) {
+        listener.onTrade(trade);
     }
 
-    return orderBook;
-}
-
-std::vector<std::string> CParser::extractTradeUpdates(const json& parsedJson) {
-    std::vector<std::string> tradeUpdates;
-
-    try {
-        if (parsedJson.contains("params") && parsedJson["params"].contains("data")) {
-            for (const auto& entry : parsedJson["params"]["data"]) {
-                if (entry.contains("trade_id") && entry.contains("price") && entry.contains("amount")) {
-                    std::string tradeId = entry["trade_id"].get<std::string>();
-                    double price = entry["price"].get<double>();
-                    double amount = entry["amount"].get<double>();
-
-                    std::string tradeInfo = "Trade ID: " + tradeId + " | Price: " + std::to_string(price) +
-                                            " | Amount: " + std::to_string(amount);
-                    tradeUpdates.push_back(tradeInfo);
-                }
-            }
+    if (message.kind == DeribitMessage::Kind::Subscription && channelKind(message.channel) == ChannelKind::Book) {
+        std::string_view instrument = message.instrumentName;
+        for (const auto& level : message.bids) {
+            listener.onBookLevel(instrument, OrderBook::Side::Bid, level);
         }
-    } catch (const std::exception& e) {
-        std::cerr << "❌ Error extracting trade updates: " << e.what() << std::endl;
-    }
-
-    return tradeUpdates;
-}
-
-std::string CParser::handleWebSocketError(const json& errorJson) {
-    try {
-        if (errorJson.contains("error")) {
-            std::string errorMessage = errorJson["error"]["message"].get<std::string>();
-            int errorCode = errorJson["error"]["code"].get<int>();
-
-            return "⚠ WebSocket Error (" + std::to_string(errorCode) + "): " + errorMessage;
+        for (const auto& level : message.asks) {
+            listener.onBookLevel(instrument, OrderBook::Side::Ask, level);
         }
-    } catch (const std::exception& e) {
-        std::cerr << "❌ Error handling WebSocket error: " << e.what() << std::endl;
+        listener.onBookEnd(instrument, message.changeId);
     }
-
-    return "⚠ Unknown WebSocket error";
+    return true;
 }
-
-bool CParser::isValidJson(const std::string& rawMessage) {
-    try {
-        json::parse(rawMessage);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
\ No newline at end of file
@@ -1,31 +1,37 @@
 #ifndef CPARSER_HPP
 #define CPARSER_HPP
 
-#include <string>
-#include <vector>
-#include <nlohmann/json.hpp>
+#include <string_view>
+#include <cstdint>
+#include "../WebSocketpp/DeribitParser.hpp"
 
-class CParser {
+// Receives the typed events decoded from one message. Views point into the
+// message and are only valid during the callback.
+class CParserListener {
 public:
-    // Constructor & Destructor
-    CParser();
-    ~CParser();
-
-    // Parses incoming WebSocket JSON messages
-    nlohmann::json parseMessage(const std::string& rawMessage);
-
-    // Extracts order book data from JSON response
-    std::vector<std::pair<double, double>> extractOrderBook(const nlohmann::json& parsedJson);
+    virtual ~CParserListener() = default;
+
+    virtual void onTrade(const Trade& /*trade*/) {}
+    // One bids/asks entry of a book notification
+    virtual void onBookLevel(std::string_view /*instrument*/, OrderBook::Side /*side*/, const BookLevel& /*level*/) {}
+    // All levels of a book notification have been delivered
+    virtual void onBookEnd(std::string_view /*instrument*/, uint64_t /*changeId*/) {}
+    virtual void onError(int64_t /*code*/, std::string_view /*message*/) {}
+};
 
-    // Extracts trade updates from JSON response
-    std::vector<std::string> extractTradeUpdates(const nlohmann::json& parsedJson);
+class CParser {
+public:
+    // Decodes a WebSocket message in a single pass and emits its events to
+    // listener. Returns false if the message is malformed.
+    bool parseMessage(std::string_view rawMessage, CParserListener& listener);
 
-    // Handles errors from WebSocket messages
-    std::string handleWebSocketError(const nlohmann::json& errorJson);
+    // Fields of the last message, for callers that need more than the events
+    const DeribitMessage& lastMessage() const { return message; }
 
 private:
-    // Helper function to validate JSON
-    bool isValidJson(const std::string& rawMessage);
+    DeribitParser parser;
+    // Reused between messages, so decoding does not allocate once warmed up
+    DeribitMessage message;
 };
 
-#endif 
\ No newline at end of file
+#endif
@@ -1,128 +1,72 @@
 #include "../Custom_WebSocket/CSocket.hpp"
 #include <iostream>
-#include <sstream>
 #include <cstring>
-#include <openssl/sha.h>
-#include <openssl/rand.h>
-#include <arpa/inet.h>  // for htons
+#include <cerrno>
+#include <sys/socket.h>
 
 namespace CustomWebSocket {
 
-// Helper: Base64 encode a given binary string
-static std::string base64Encode(const std::string& input) {
-    static const char* b64_chars = 
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::string output;
-    output.reserve(((input.size() + 2) / 3) * 4);
-    unsigned val = 0;
-    int valb = -6;
-    for (uint8_t c : input) {
-        val = (val << 8) + c;
-        valb += 8;
-        while (valb >= 0) {
-            output.push_back(b64_chars[(val >> valb) & 0x3F]);
-            valb -= 6;
-        }
-    }
-    if (valb > -6) {
-        output.push_back(b64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-    }
-    while (output.size() % 4) {
-        output.push_back('=');
-    }
-    return output;
-}
-
-// Generate Sec-WebSocket-Accept given a Sec-WebSocket-Key
-static std::string generateAcceptKey(const std::string& key) {
-    std::string magic = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
-    std::string input = key + magic;
-    unsigned char hash[SHA_DIGEST_LENGTH];
-    SHA1(reinterpret_cast<const unsigned char*>(input.c_str()), input.size(), hash);
-    std::string hashed(reinterpret_cast<char*>(hash), SHA_DIGEST_LENGTH);
-    return base64Encode(hashed);
-}
-
-// Convert 64-bit value from host to network byte order
-static uint64_t hostToNetwork64(uint64_t val) {
-    uint64_t result = 0;
-    uint8_t* bytes = reinterpret_cast<uint8_t*>(&val);
-    // Append bytes in reverse order (big-endian)
-    for (int i = 0; i < 8; ++i) {
-        result = (result << 8) | bytes[i];
-    }
-    return result;
-}
+// Read at least this much free space into, compacting the buffer if needed
+static constexpr size_t MIN_READ_SPACE = 16 * 1024;
 
 CSocket::CSocket()
     : tcpSocket(io), sslContext(boost::asio::ssl::context::tlsv12_client),
-      sslStream(tcpSocket, sslContext), running(false) {
+      sslStream(tcpSocket, sslContext), running(false), recvBuffer(RECV_BUFFER_SIZE),
+      sendBuffer(SEND_BUFFER_SIZE) {
     sslContext.set_verify_mode(boost::asio::ssl::verify_none);
+    ConnectionCache::enableResumption(sslContext.native_handle());
 }
 
 CSocket::~CSocket() {
     close();
 }
 
-bool CSocket::connect(const std::string& host, const std::string& path) {
-    try {
-        // Resolve host address
-        boost::asio::ip::tcp::resolver resolver(io);
-        auto endpoints = resolver.resolve(host, "443");
-        boost::asio::connect(tcpSocket, endpoints);
-        // TLS handshake
-        sslStream.handshake(boost::asio::ssl::stream_base::client);
-
-        // Generate Sec-WebSocket-Key (16 random bytes base64)
-        unsigned char randKey[16];
-        RAND_bytes(randKey, 16);
-        std::string secKey = base64Encode(std::string(reinterpret_cast<char*>(randKey), 16));
+bool CSocket::connect(const std::string& url) {
+    std::string host, port, path;
+    bool secure;
+    parseUrl(url, host, port, path, secure);
+    return connect(host, path, port, secure);
+}
 
-        // Build WebSocket handshake request
-        std::ostringstream req;
-        req << "GET " << path << " HTTP/1.1\r\n"
-            << "Host: " << host << "\r\n"
-            << "Upgrade: websocket\r\n"
-            << "Connection: Upgrade\r\n"
-            << "Sec-WebSocket-Key: " << secKey << "\r\n"
-            << "Sec-WebSocket-Version: 13\r\n"
-            << "\r\n";
-        std::string request = req.str();
-        boost::asio::write(sslStream, boost::asio::buffer(request));
+bool CSocket::connect(const std::string& host, const std::string& path, const std::string& port, bool secure) {
+    this->secure = secure;
+    try {
+        // Connect through the cached addresses (resolved on first use)
+        int family = AF_INET;
+        int fd = ConnectionCache::instance().connect(host, port, &family);
+        if (fd < 0) return false;
+        tcpSocket.assign(family == AF_INET6 ? boost::asio::ip::tcp::v6() : boost::asio::ip::tcp::v4(), fd);
+        tuneSocket(fd, lowLatency);
+        // TLS handshake, resuming the last session with this server if there is one
+        if (secure) {
+            SSL* ssl = sslStream.native_handle();
+            SSL_set_tlsext_host_name(ssl, host.c_str());
+            ConnectionCache::instance().prepareSession(ssl, host + ":" + port);
+            sslStream.handshake(boost::asio::ssl::stream_base::client);
+            ConnectionCache::instance().recordHandshake(ssl);
+        }
 
-        // Read handshake response
+        // WebSocket upgrade
+        std::string secKey = makeSecKey();
+        std::string request = upgradeRequest(host, path, secKey);
+        writeAll(request.data(), request.size());
         boost::asio::streambuf responseBuf;
-        boost::asio::read_until(sslStream, responseBuf, "\r\n\r\n");
-        std::istream responseStream(&responseBuf);
-        std::string responseLine;
-        std::getline(responseStream, responseLine);
-        if (responseLine.find("101") == std::string::npos) {
-            std::cerr << "WebSocket handshake failed: " << responseLine << std::endl;
-            return false;
-        }
-        std::string header;
-        std::string acceptKey;
-        while (std::getline(responseStream, header) && header != "\r") {
-            if (header.rfind("Sec-WebSocket-Accept:", 0) == 0) {
-                acceptKey = header.substr(header.find(":") + 2);
-                // Remove any trailing CR or LF
-                if (!acceptKey.empty() && acceptKey.back() == '\r') {
-                    acceptKey.pop_back();
-                }
-            }
-        }
-        std::string expectedAccept = generateAcceptKey(secKey);
-        if (acceptKey != expectedAccept) {
-            std::cerr << "Sec-WebSocket-Accept mismatch, expected " << expectedAccept 
-                      << ", got " << acceptKey << std::endl;
-            return false;
+        size_t headerEnd = secure ? boost::asio::read_until(sslStream, responseBuf, "\r\n\r\n")
+                                  : boost::asio::read_until(tcpSocket, responseBuf, "\r\n\r\n");
+        std::string_view response(static_cast<const char*>(responseBuf.data().data()), headerEnd);
+        if (!checkUpgradeResponse(response, secKey)) return false;
+        responseBuf.consume(headerEnd);
+        // Frames the server sent right after the handshake were read along with it
+        recvRead = 0;
+        recvWrite = 0;
+        size_t early = responseBuf.size();
+        recvNs = clockNs();
+        if (early > 0) {
+            compactRecvBuffer(early);
+            recvWrite = boost::asio::buffer_copy(boost::asio::buffer(recvBuffer), responseBuf.data());
         }
         // WebSocket handshake successful
         running = true;
-        // Subscribe to order book channel (e.g., top 10 levels, 100ms interval)
-        std::string subscribeMsg = 
-            "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"public/subscribe\",\"params\":{\"channels\":[\"book.BTC-PERPETUAL.none.10.100ms\"]}}";
-        send(subscribeMsg);
         // Start reader thread
         recvThread = std::thread(&CSocket::readerLoop, this);
         return true;
@@ -132,44 +76,23 @@ bool CSocket::connect(const std::string& host, const std::string& path) {
     }
 }
 
-bool CSocket::send(const std::string& message) {
+bool CSocket::send(std::string_view message) {
     if (!running) return false;
+    return sendFrame(0x1, message.data(), message.size());
+}
+
+bool CSocket::sendFrame(uint8_t opcode, const char* payload, size_t length) {
     std::lock_guard<std::mutex> lock(sendMutex);
-    // Prepare WebSocket frame for client-to-server message
-    uint8_t header[14]; // maximum header size for 64-bit length
-    size_t headerLen = 0;
-    header[0] = 0x81; // FIN=1, opcode=1 (text)
-    // Determine payload length
-    size_t payloadLen = message.size();
-    if (payloadLen <= 125) {
-        header[1] = static_cast<uint8_t>(payloadLen) | 0x80;
-        headerLen = 2;
-    } else if (payloadLen <= 0xFFFF) {
-        header[1] = 126 | 0x80;
-        uint16_t lenN = htons(static_cast<uint16_t>(payloadLen));
-        std::memcpy(header + 2, &lenN, 2);
-        headerLen = 4;
-    } else {
-        header[1] = 127 | 0x80;
-        uint64_t lenN = hostToNetwork64(static_cast<uint64_t>(payloadLen));
-        std::memcpy(header + 2, &lenN, 8);
-        headerLen = 10;
-    }
-    // Generate random mask
+    // Header and masked payload go into one buffer and out in one write,
+    // so a small frame is a single TLS record
+    if (sendBuffer.size() < length + MAX_HEADER_LEN) sendBuffer.resize(length + MAX_HEADER_LEN);
     uint8_t mask[4];
-    RAND_bytes(mask, 4);
-    std::memcpy(header + headerLen, mask, 4);
-    headerLen += 4;
-    // Mask the payload
-    std::string maskedPayload = message;
-    for (size_t i = 0; i < payloadLen; ++i) {
-        maskedPayload[i] ^= mask[i % 4];
-    }
+    uint32_t key = maskKeys.next();
+    std::memcpy(mask, &key, 4);
+    size_t headerLen = writeFrameHeader(reinterpret_cast<uint8_t*>(sendBuffer.data()), opcode, length, mask);
+    maskCopy(sendBuffer.data() + headerLen, payload, length, mask);
     try {
-        boost::asio::write(sslStream, boost::asio::buffer(header, headerLen));
-        if (payloadLen > 0) {
-            boost::asio::write(sslStream, boost::asio::buffer(maskedPayload));
-        }
+        writeAll(sendBuffer.data(), headerLen + length);
     } catch (const std::exception& ex) {
         std::cerr << "CSocket send error: " << ex.what() << std::endl;
         return false;
@@ -177,72 +100,160 @@ bool CSocket::send(const std::string& message) {
     return true;
 }
 
+void CSocket::writeAll(const char* data, size_t length) {
+    if (secure) {
+        boost::asio::write(sslStream, boost::asio::buffer(data, length));
+    } else {
+        boost::asio::write(tcpSocket, boost::asio::buffer(data, length));
+    }
+}
+
+size_t CSocket::readSome(char* data, size_t length) {
+    if (secure) return sslStream.read_some(boost::asio::buffer(data, length));
+    return tcpSocket.read_some(boost::asio::buffer(data, length));
+}
+
+void CSocket::compactRecvBuffer(size_t needed) {
+    size_t unread = recvWrite - recvRead;
+    if (recvRead > 0) {
+        std::memmove(recvBuffer.data(), recvBuffer.data() + recvRead, unread);
+        recvRead = 0;
+        recvWrite = unread;
+    }
+    if (recvBuffer.size() < needed) {
+        size_t size = recvBuffer.size();
+        while (size < needed) size *= 2;
+        recvBuffer.resize(size);
+    }
+}
+
+void CSocket::spinUntilReadable(SpinWait& spin) {
+    SSL* ssl = sslStream.native_handle();
+    while (running) {
+        // Records already buffered by TLS need no socket read
+        if (secure && (SSL_has_pending(ssl) || BIO_ctrl_pending(SSL_get_rbio(ssl)) > 0)) return;
+        // Non-blocking peek; the socket itself stays blocking for senders
+        char byte;
+        ssize_t n = ::recv(tcpSocket.native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        // Data, EOF or an error: read_some returns or reports it at once
+        if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return;
+        spin.idle();
+    }
+}
+
 void CSocket::readerLoop() {
+    pinThread(lowLatency.ioCpu);
+    SpinWait spin(lowLatency.spinsBeforeYield);
     try {
         while (running) {
-            // Read frame header (at least 2 bytes)
-            uint8_t hdr[2];
-            boost::asio::read(sslStream, boost::asio::buffer(hdr, 2));
-            uint8_t byte1 = hdr[0];
-            uint8_t byte2 = hdr[1];
-            bool fin = (byte1 & 0x80) != 0;
-            uint8_t opcode = byte1 & 0x0F;
-            bool mask = (byte2 & 0x80) != 0;
-            uint64_t payloadLen = byte2 & 0x7F;
-            if (payloadLen == 126) {
-                uint8_t ext[2];
-                boost::asio::read(sslStream, boost::asio::buffer(ext, 2));
-                payloadLen = (ext[0] << 8) | ext[1];
-            } else if (payloadLen == 127) {
-                uint8_t ext[8];
-                boost::asio::read(sslStream, boost::asio::buffer(ext, 8));
-                payloadLen = 0;
-                for (int i = 0; i < 8; ++i) {
-                    payloadLen = (payloadLen << 8) | ext[i];
+            // Hand over every complete frame already in the buffer, in place
+            while (running) {
+                FrameHeader frame;
+                size_t avail = recvWrite - recvRead;
+                size_t headerLen = parseFrameHeader(reinterpret_cast<const uint8_t*>(recvBuffer.data() + recvRead),
+                                                    avail, frame);
+                if (headerLen == 0) break;
+                if (headerLen == INVALID_FRAME) {
+                    std::cerr << "[CustomWS] Invalid frame length " << frame.payloadLen << std::endl;
+                    failConnection(frame.closeCode);
+                    break;
                 }
-            }
-            uint8_t maskKey[4] = {0,0,0,0};
-            if (mask) {
-                // Read mask (though server frames should not be masked)
-                boost::asio::read(sslStream, boost::asio::buffer(maskKey, 4));
-            }
-            if (opcode == 0x8) { // close frame
-                // Received close frame from server
-                running = false;
-                break;
-            }
-            // Read payload
-            std::vector<char> payload;
-            if (payloadLen > 0) {
-                payload.resize(payloadLen);
-                boost::asio::read(sslStream, boost::asio::buffer(payload.data(), payloadLen));
-            }
-            if (mask) {
-                for (size_t i = 0; i < payload.size(); ++i) {
-                    payload[i] ^= maskKey[i % 4];
+                size_t frameLen = headerLen + frame.payloadLen;
+                if (frameLen > avail) {
+                    // Make room for the rest of this frame before reading on
+                    if (recvRead + frameLen > recvBuffer.size()) compactRecvBuffer(frameLen);
+                    break;
                 }
+                char* payload = recvBuffer.data() + recvRead + headerLen;
+                if (frame.masked) maskCopy(payload, payload, frame.payloadLen, frame.maskKey);
+                recvRead += frameLen;
+                handleFrame(frame.opcode, frame.fin, payload, frame.payloadLen);
             }
-            std::string message(payload.begin(), payload.end());
-            if (message.find("\"channel\":\"book.") != std::string::npos) {
-                parser.parseOrderBookUpdate(message);
-                // Example: output best bid/ask for verification
-                OrderBook ob = parser.getOrderBook();
-                if (!ob.bids.empty() && !ob.asks.empty()) {
-                    double bestBid = ob.bids.begin()->first;
-                    double bestAsk = ob.asks.begin()->first;
-                    std::cout << "[CustomWS] BestBid=" << bestBid 
-                              << ", BestAsk=" << bestAsk << std::endl;
-                }
-            } else {
-                // Print other messages (e.g., subscription ack or heartbeats)
-                std::cout << "[CustomWS] Received: " << message << std::endl;
+            if (!running) break;
+            if (recvRead == recvWrite) {
+                recvRead = 0;
+                recvWrite = 0;
+            } else if (recvBuffer.size() - recvWrite < MIN_READ_SPACE) {
+                compactRecvBuffer(0);
+            }
+            if (lowLatency.spin) {
+                spinUntilReadable(spin);
+                if (!running) break;
             }
+            // One read takes whatever the socket has, often many frames
+            recvWrite += readSome(recvBuffer.data() + recvWrite, recvBuffer.size() - recvWrite);
+            recvNs = clockNs();
         }
     } catch (const std::exception& ex) {
         if (running) {
             std::cerr << "Reader loop exception: " << ex.what() << std::endl;
+            running = false;
+            notifyDisconnect();
+        }
+    }
+}
+
+void CSocket::handleFrame(uint8_t opcode, bool fin, char* payload, size_t length) {
+    switch (opcode) {
+    case 0x1: // text
+    case 0x2: // binary
+        if (fin) {
+            deliver(std::string_view(payload, length));
+        } else {
+            fragments.assign(payload, length);
+        }
+        break;
+    case 0x0: // continuation
+        if (fragments.size() + length > MAX_MESSAGE_SIZE) {
+            std::cerr << "[CustomWS] Fragmented message over " << MAX_MESSAGE_SIZE << " bytes" << std::endl;
+            failConnection(CLOSE_MESSAGE_TOO_BIG);
+            break;
         }
-        running = false;
+        fragments.append(payload, length);
+        if (fin) {
+            deliver(fragments);
+            fragments.clear();
+        }
+        break;
+    case 0x8: { // close: echo it back, then stop
+        sendFrame(0x8, payload, length < 2 ? 0 : 2);
+        // Unless close() got there first, this is the server dropping us
+        bool dropped = running.exchange(false);
+        // The server waits for our close_notify before it lets go of the connection
+        boost::system::error_code ec;
+        if (secure) sslStream.shutdown(ec);
+        tcpSocket.close(ec);
+        if (dropped) notifyDisconnect();
+        break;
+    }
+    case 0x9: // ping
+        sendFrame(0xA, payload, length);
+        break;
+    default: // pong
+        break;
+    }
+}
+
+void CSocket::failConnection(uint16_t code) {
+    char payload[2];
+    closePayload(code, payload);
+    sendFrame(0x8, payload, sizeof(payload));
+    bool dropped = running.exchange(false);
+    boost::system::error_code ec;
+    if (secure) sslStream.shutdown(ec);
+    tcpSocket.close(ec);
+    fragments.clear();
+    if (dropped) notifyDisconnect();
+}
+
+void CSocket::deliver(std::string_view payload) {
+    if (messageHandler) {
+        messageHandler(payload, recvNs);
+        return;
+    }
+    if (!listener) return;
+    if (!parser.parseMessage(payload, *listener)) {
+        std::cerr << "[CustomWS] Unparsed message: " << payload << std::endl;
     }
 }
 
@@ -252,20 +263,16 @@ void CSocket::close() {
         return;
     }
     running = false;
-    try {
-        // Send a close frame to server
-        uint8_t closeFrame[6];
-        closeFrame[0] = 0x88; // FIN + opcode 8 (Close)
-        closeFrame[1] = 0x80; // Masked, length=0
-        uint8_t mask[4];
-        RAND_bytes(mask, 4);
-        std::memcpy(closeFrame+2, mask, 4);
-        boost::asio::write(sslStream, boost::asio::buffer(closeFrame, 6));
-    } catch (...) {
-        // ignore send errors on close
+    // Send a close frame to server
+    sendFrame(0x8, nullptr, 0);
+    boost::system::error_code ec;
+    if (secure) {
+        sslStream.shutdown(ec);
+    } else {
+        // Wakes the reader out of a blocking read
+        tcpSocket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
     }
-    try { sslStream.shutdown(); } catch (...) {}
-    try { tcpSocket.close(); } catch (...) {}
+    tcpSocket.close(ec);
     if (recvThread.joinable()) {
         recvThread.join();
     }
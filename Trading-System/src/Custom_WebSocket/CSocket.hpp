@@ -2,35 +2,84 @@
 #define CSOCKET_HPP
 
 #include <boost/asio.hpp>
-#include <boost/beast/websocket.hpp>
-#include <nlohmann/json.hpp>
+#include <boost/asio/ssl.hpp>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
+#include "../Custom_WebSocket/CFrame.hpp"
 #include "../Custom_WebSocket/CParser.hpp"
+#include "../WebSocketpp/BSocket.hpp"
+#include "../WebSocketpp/ConnectionCache.hpp"
 
-using boost::asio::ip::tcp;
-namespace websocket = boost::beast::websocket;
+namespace CustomWebSocket {
 
-class CSocket {
+// Minimal WebSocket client, framing done by hand; over TLS, or plain TCP for
+// ws:// URLs
+class CSocket : public BSocket {
 public:
-    CSocket(const std::string& host, const std::string& port);
-    ~CSocket();
+    // Initial receive buffer; grows only for a frame larger than this
+    static constexpr size_t RECV_BUFFER_SIZE = 1 << 20;
+    // Initial send buffer; grows only for a larger message
+    static constexpr size_t SEND_BUFFER_SIZE = 64 * 1024;
 
-    void connect();
-    void sendMessage(const std::string& message);
-    void listen();
-    void close();
+    CSocket();
+    ~CSocket() override;
+
+    // ws[s]://host[:port]/path
+    bool connect(const std::string& url) override;
+    bool connect(const std::string& host, const std::string& path, const std::string& port = "443",
+                 bool secure = true);
+    bool send(std::string_view message) override;
+    void close() override;
+
+    // Without a message handler, decoded trades/book levels/errors are
+    // delivered here from the reader thread instead
+    void setListener(CParserListener* listener) { this->listener = listener; }
 
 private:
-    std::string host_;
-    std::string port_;
-    boost::asio::io_context io_context_;
-    tcp::resolver resolver_;
-    websocket::stream<tcp::socket> ws_;
-    std::thread listener_thread_;
-    CParser parser_;
-
-    void handleIncomingMessage(const std::string& message);
+    void readerLoop();
+    // Spin mode: poll without blocking until a read_some would not sleep
+    void spinUntilReadable(SpinWait& spin);
+    // Act on one complete frame; payload is unmasked and may be modified
+    void handleFrame(uint8_t opcode, bool fin, char* payload, size_t length);
+    // Send a close frame with code and drop the connection (bad frame from the server)
+    void failConnection(uint16_t code);
+    void deliver(std::string_view payload);
+    bool sendFrame(uint8_t opcode, const char* payload, size_t length);
+    // Socket I/O through TLS or straight to TCP
+    void writeAll(const char* data, size_t length);
+    size_t readSome(char* data, size_t length);
+    // Move unread bytes to the front, growing the buffer if needed bytes do not fit
+    void compactRecvBuffer(size_t needed);
+
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::socket tcpSocket;
+    boost::asio::ssl::context sslContext;
+    boost::asio::ssl::stream<boost::asio::ip::tcp::socket&> sslStream;
+    bool secure = true;
+    std::atomic<bool> running;
+    std::mutex sendMutex;
+    std::thread recvThread;
+    CParser parser;
+    CParserListener* listener = nullptr;
+
+    // Receive buffer: [recvRead, recvWrite) holds bytes not yet framed
+    std::vector<char> recvBuffer;
+    size_t recvRead = 0;
+    size_t recvWrite = 0;
+    // When the bytes being framed were read
+    long long recvNs = 0;
+    // Reassembly of fragmented messages (rare)
+    std::string fragments;
+
+    // Outgoing frame (header + masked payload), guarded by sendMutex
+    std::vector<char> sendBuffer;
+    MaskKeys maskKeys;
 };
 
-#endif // CSOCKET_HPP
\ No newline at end of file
+} // namespace CustomWebSocket
+
+#endif // CSOCKET_HPP
@@ -0,0 +1,535 @@
+#include "../Custom_WebSocket/UringSocket.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <openssl/err.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace CustomWebSocket {
+
+// Buffer group of the provided receive buffers
+static constexpr int RECV_GROUP = 0;
+// The send buffer's index among the registered buffers
+static constexpr int SEND_BUFFER_INDEX = 0;
+// Decrypt into at least this much free space, compacting the buffer if needed
+static constexpr size_t MIN_READ_SPACE = 16 * 1024;
+
+UringSocket::UringSocket()
+    : recvPool(RECV_BUFFERS * RECV_BUFFER_SIZE), sendPool(SEND_BUFFER_SIZE), frameBuffer(FRAME_BUFFER_SIZE) {
+    frameOut.reserve(SEND_BUFFER_SIZE);
+    sslCtx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_min_proto_version(sslCtx, TLS1_2_VERSION);
+    // Same as CSocket: no certificate verification
+    SSL_CTX_set_verify(sslCtx, SSL_VERIFY_NONE, nullptr);
+    ConnectionCache::enableResumption(sslCtx);
+}
+
+UringSocket::~UringSocket() {
+    close();
+    SSL_CTX_free(sslCtx);
+}
+
+bool UringSocket::connect(const std::string& url) {
+    std::string host, port, path;
+    parseUrl(url, host, port, path, secure);
+    int rc = io_uring_queue_init(RING_ENTRIES, &ring, 0);
+    if (rc < 0) {
+        std::cerr << "UringSocket ring setup failed: " << std::strerror(-rc) << std::endl;
+        return false;
+    }
+    ringReady = true;
+    if (!secure) {
+        // Plain ws://: the write BIO is just the outgoing byte queue
+        writeBio = BIO_new(BIO_s_mem());
+    }
+    if (!tcpConnect(host, port) || (secure && !tlsHandshake(host, port)) || !upgrade(host, path) || !setupBuffers()) {
+        release();
+        return false;
+    }
+    running = true;
+    {
+        std::lock_guard<std::mutex> lock(ioMutex);
+        armRecv();
+        io_uring_submit(&ring);
+    }
+    completionThread = std::thread(&UringSocket::completionLoop, this);
+    return true;
+}
+
+bool UringSocket::tcpConnect(const std::string& host, const std::string& port) {
+    fd = ConnectionCache::instance().connect(host, port);
+    if (fd < 0) return false;
+    tuneSocket(fd, lowLatency);
+    return true;
+}
+
+bool UringSocket::sendAllSync(const char* data, size_t length) {
+    while (length > 0) {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        io_uring_prep_send(sqe, fd, data, length, MSG_NOSIGNAL);
+        io_uring_submit_and_wait(&ring, 1);
+        io_uring_cqe* cqe;
+        if (io_uring_wait_cqe(&ring, &cqe) < 0) return false;
+        int res = cqe->res;
+        io_uring_cqe_seen(&ring, cqe);
+        if (res <= 0) {
+            std::cerr << "UringSocket send error: " << std::strerror(-res) << std::endl;
+            return false;
+        }
+        data += res;
+        length -= static_cast<size_t>(res);
+    }
+    return true;
+}
+
+ssize_t UringSocket::recvSync(char* data, size_t length) {
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_recv(sqe, fd, data, length, 0);
+    io_uring_submit_and_wait(&ring, 1);
+    io_uring_cqe* cqe;
+    if (io_uring_wait_cqe(&ring, &cqe) < 0) return -1;
+    int res = cqe->res;
+    io_uring_cqe_seen(&ring, cqe);
+    if (res < 0) {
+        std::cerr << "UringSocket receive error: " << std::strerror(-res) << std::endl;
+    }
+    return res;
+}
+
+bool UringSocket::flushTlsSync() {
+    char chunk[16 * 1024];
+    while (BIO_ctrl_pending(writeBio) > 0) {
+        int n = BIO_read(writeBio, chunk, sizeof(chunk));
+        if (n <= 0 || !sendAllSync(chunk, static_cast<size_t>(n))) return false;
+    }
+    return true;
+}
+
+bool UringSocket::fillTlsSync() {
+    char chunk[RECV_BUFFER_SIZE];
+    ssize_t n = recvSync(chunk, sizeof(chunk));
+    if (n <= 0) {
+        if (n == 0) std::cerr << "UringSocket connection closed during handshake" << std::endl;
+        return false;
+    }
+    BIO_write(readBio, chunk, static_cast<int>(n));
+    recvNs = clockNs();
+    return true;
+}
+
+bool UringSocket::tlsHandshake(const std::string& host, const std::string& port) {
+    ssl = SSL_new(sslCtx);
+    readBio = BIO_new(BIO_s_mem());
+    writeBio = BIO_new(BIO_s_mem());
+    // The SSL object owns both BIOs from here on
+    SSL_set_bio(ssl, readBio, writeBio);
+    SSL_set_tlsext_host_name(ssl, host.c_str());
+    ConnectionCache::instance().prepareSession(ssl, host + ":" + port);
+    SSL_set_connect_state(ssl);
+    for (;;) {
+        int r = SSL_do_handshake(ssl);
+        if (!flushTlsSync()) return false;
+        if (r == 1) {
+            ConnectionCache::instance().recordHandshake(ssl);
+            return true;
+        }
+        if (SSL_get_error(ssl, r) != SSL_ERROR_WANT_READ) {
+            std::cerr << "UringSocket TLS handshake failed: " << ERR_error_string(ERR_get_error(), nullptr) << std::endl;
+            return false;
+        }
+        if (!fillTlsSync()) return false;
+    }
+}
+
+bool UringSocket::upgrade(const std::string& host, const std::string& path) {
+    std::string secKey = makeSecKey();
+    std::string request = upgradeRequest(host, path, secKey);
+    if (secure) {
+        SSL_write(ssl, request.data(), static_cast<int>(request.size()));
+        if (!flushTlsSync()) return false;
+    } else if (!sendAllSync(request.data(), request.size())) {
+        return false;
+    }
+    frameRead = 0;
+    frameWrite = 0;
+    for (;;) {
+        char* dest = frameBuffer.data() + frameWrite;
+        size_t space = frameBuffer.size() - frameWrite;
+        if (secure) {
+            int n = SSL_read(ssl, dest, static_cast<int>(space));
+            if (n <= 0) {
+                if (SSL_get_error(ssl, n) != SSL_ERROR_WANT_READ) {
+                    std::cerr << "UringSocket upgrade failed: " << ERR_error_string(ERR_get_error(), nullptr) << std::endl;
+                    return false;
+                }
+                if (!flushTlsSync() || !fillTlsSync()) return false;
+                continue;
+            }
+            frameWrite += static_cast<size_t>(n);
+        } else {
+            ssize_t n = recvSync(dest, space);
+            if (n <= 0) {
+                if (n == 0) std::cerr << "UringSocket connection closed during upgrade" << std::endl;
+                return false;
+            }
+            recvNs = clockNs();
+            frameWrite += static_cast<size_t>(n);
+        }
+        std::string_view received(frameBuffer.data(), frameWrite);
+        size_t end = received.find("\r\n\r\n");
+        if (end == std::string_view::npos) continue;
+        end += 4;
+        if (!checkUpgradeResponse(received.substr(0, end), secKey)) return false;
+        // Frames the server sent right after the handshake stay buffered
+        frameRead = end;
+        return true;
+    }
+}
+
+bool UringSocket::setupBuffers() {
+    int ret = 0;
+    bufRing = io_uring_setup_buf_ring(&ring, RECV_BUFFERS, RECV_GROUP, 0, &ret);
+    if (!bufRing) {
+        std::cerr << "UringSocket buffer ring setup failed: " << std::strerror(-ret) << std::endl;
+        return false;
+    }
+    int mask = io_uring_buf_ring_mask(RECV_BUFFERS);
+    for (unsigned i = 0; i < RECV_BUFFERS; ++i) {
+        io_uring_buf_ring_add(bufRing, recvPool.data() + i * RECV_BUFFER_SIZE, RECV_BUFFER_SIZE, i, mask, i);
+    }
+    io_uring_buf_ring_advance(bufRing, RECV_BUFFERS);
+    iovec iov{sendPool.data(), sendPool.size()};
+    ret = io_uring_register_buffers(&ring, &iov, 1);
+    if (ret < 0) {
+        std::cerr << "UringSocket buffer registration failed: " << std::strerror(-ret) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void UringSocket::armRecv() {
+    // One request keeps delivering completions, each into a buffer the kernel picks
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_GROUP;
+    io_uring_sqe_set_data64(sqe, OP_RECV);
+}
+
+void UringSocket::completionLoop() {
+    pinThread(lowLatency.ioCpu);
+    SpinWait spin(lowLatency.spinsBeforeYield);
+    // Frames that arrived along with the upgrade response
+    deliverFrames();
+    while (running) {
+        io_uring_cqe* cqe;
+        int rc;
+        if (lowLatency.spin) {
+            // The completion queue is shared memory: peeking needs no syscall
+            rc = io_uring_peek_cqe(&ring, &cqe);
+            if (rc == -EAGAIN) {
+                spin.idle();
+                continue;
+            }
+        } else {
+            rc = io_uring_wait_cqe(&ring, &cqe);
+        }
+        if (rc < 0) {
+            if (rc == -EINTR) continue;
+            std::cerr << "UringSocket wait error: " << std::strerror(-rc) << std::endl;
+            break;
+        }
+        recvNs = clockNs();
+        // Reap everything that is ready in one pass
+        unsigned head;
+        unsigned count = 0;
+        io_uring_for_each_cqe(&ring, head, cqe) {
+            ++count;
+            switch (io_uring_cqe_get_data64(cqe)) {
+            case OP_RECV:
+                onRecv(cqe);
+                break;
+            case OP_SEND:
+                onSendComplete(cqe->res);
+                break;
+            default: // wake-up from close()
+                break;
+            }
+        }
+        io_uring_cq_advance(&ring, count);
+        deliverFrames();
+        // Re-arms and follow-up writes queued above go out in one submission
+        std::lock_guard<std::mutex> lock(ioMutex);
+        if (io_uring_sq_ready(&ring) > 0) io_uring_submit(&ring);
+    }
+    running = false;
+    if (!closing) notifyDisconnect();
+}
+
+void UringSocket::onRecv(const io_uring_cqe* cqe) {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    int res = cqe->res;
+    if (res > 0 && (cqe->flags & IORING_CQE_F_BUFFER)) {
+        unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        char* buffer = recvPool.data() + static_cast<size_t>(bid) * RECV_BUFFER_SIZE;
+        size_t length = static_cast<size_t>(res);
+        if (secure) {
+            BIO_write(readBio, buffer, res);
+        } else {
+            if (frameBuffer.size() - frameWrite < length) compactFrameBuffer(frameWrite - frameRead + length);
+            std::memcpy(frameBuffer.data() + frameWrite, buffer, length);
+            frameWrite += length;
+        }
+        // Hand the buffer straight back to the kernel
+        io_uring_buf_ring_add(bufRing, buffer, RECV_BUFFER_SIZE, bid, io_uring_buf_ring_mask(RECV_BUFFERS), 0);
+        io_uring_buf_ring_advance(bufRing, 1);
+        if (secure) readPlaintext();
+    } else if (res == 0) {
+        running = false;
+        return;
+    } else if (res != -ENOBUFS) {
+        std::cerr << "UringSocket receive error: " << std::strerror(-res) << std::endl;
+        running = false;
+        return;
+    }
+    // The kernel ends a multishot receive when it runs out of buffers
+    if (!(cqe->flags & IORING_CQE_F_MORE) && running) armRecv();
+}
+
+void UringSocket::readPlaintext() {
+    for (;;) {
+        if (frameBuffer.size() - frameWrite < MIN_READ_SPACE) compactFrameBuffer(frameWrite - frameRead + MIN_READ_SPACE);
+        int n = SSL_read(ssl, frameBuffer.data() + frameWrite, static_cast<int>(frameBuffer.size() - frameWrite));
+        if (n > 0) {
+            frameWrite += static_cast<size_t>(n);
+            continue;
+        }
+        int err = SSL_get_error(ssl, n);
+        if (err == SSL_ERROR_ZERO_RETURN) {
+            running = false;
+        } else if (err != SSL_ERROR_WANT_READ) {
+            std::cerr << "UringSocket TLS read error: " << ERR_error_string(ERR_get_error(), nullptr) << std::endl;
+            running = false;
+        }
+        break;
+    }
+    // Reading can produce TLS output of its own (key updates, alerts)
+    flushTls();
+}
+
+void UringSocket::compactFrameBuffer(size_t needed) {
+    size_t unread = frameWrite - frameRead;
+    if (frameRead > 0) {
+        std::memmove(frameBuffer.data(), frameBuffer.data() + frameRead, unread);
+        frameRead = 0;
+        frameWrite = unread;
+    }
+    if (frameBuffer.size() < needed) {
+        size_t size = frameBuffer.size();
+        while (size < needed) size *= 2;
+        frameBuffer.resize(size);
+    }
+}
+
+void UringSocket::deliverFrames() {
+    // Hand over every complete frame in the buffer, in place
+    while (running) {
+        FrameHeader frame;
+        size_t avail = frameWrite - frameRead;
+        size_t headerLen = parseFrameHeader(reinterpret_cast<const uint8_t*>(frameBuffer.data() + frameRead), avail, frame);
+        if (headerLen == 0) break;
+        if (headerLen == INVALID_FRAME) {
+            std::cerr << "UringSocket invalid frame length " << frame.payloadLen << std::endl;
+            failConnection(frame.closeCode);
+            break;
+        }
+        size_t frameLen = headerLen + frame.payloadLen;
+        if (frameLen > avail) {
+            // Make room for the rest of this frame before decrypting on
+            if (frameRead + frameLen > frameBuffer.size()) compactFrameBuffer(frameLen);
+            break;
+        }
+        char* payload = frameBuffer.data() + frameRead + headerLen;
+        if (frame.masked) maskCopy(payload, payload, frame.payloadLen, frame.maskKey);
+        frameRead += frameLen;
+        handleFrame(frame.opcode, frame.fin, payload, frame.payloadLen);
+    }
+    if (frameRead == frameWrite) {
+        frameRead = 0;
+        frameWrite = 0;
+    }
+}
+
+void UringSocket::handleFrame(uint8_t opcode, bool fin, char* payload, size_t length) {
+    switch (opcode) {
+    case 0x1: // text
+    case 0x2: // binary
+        if (fin) {
+            if (messageHandler) messageHandler(std::string_view(payload, length), recvNs);
+        } else {
+            fragments.assign(payload, length);
+        }
+        break;
+    case 0x0: // continuation
+        if (fragments.size() + length > MAX_MESSAGE_SIZE) {
+            std::cerr << "UringSocket fragmented message over " << MAX_MESSAGE_SIZE << " bytes" << std::endl;
+            failConnection(CLOSE_MESSAGE_TOO_BIG);
+            break;
+        }
+        fragments.append(payload, length);
+        if (fin) {
+            if (messageHandler) messageHandler(fragments, recvNs);
+            fragments.clear();
+        }
+        break;
+    case 0x8: { // close: echo it back, then stop
+        sendFrame(0x8, payload, length < 2 ? 0 : 2);
+        running = false;
+        if (!secure) break;
+        std::lock_guard<std::mutex> lock(ioMutex);
+        SSL_shutdown(ssl);
+        flushTls();
+        break;
+    }
+    case 0x9: // ping
+        sendFrame(0xA, payload, length);
+        break;
+    default: // pong
+        break;
+    }
+}
+
+void UringSocket::failConnection(uint16_t code) {
+    char payload[2];
+    closePayload(code, payload);
+    sendFrame(0x8, payload, sizeof(payload));
+    // The completion loop sees running drop and reports the disconnect
+    running = false;
+    fragments.clear();
+}
+
+bool UringSocket::send(std::string_view message) {
+    if (!running) return false;
+    return sendFrame(0x1, message.data(), message.size());
+}
+
+bool UringSocket::sendFrame(uint8_t opcode, const char* payload, size_t length) {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    if (frameOut.size() < length + MAX_HEADER_LEN) frameOut.resize(length + MAX_HEADER_LEN);
+    uint8_t mask[4];
+    uint32_t key = maskKeys.next();
+    std::memcpy(mask, &key, 4);
+    size_t headerLen = writeFrameHeader(reinterpret_cast<uint8_t*>(frameOut.data()), opcode, length, mask);
+    maskCopy(frameOut.data() + headerLen, payload, length, mask);
+    // The write BIO is memory: this never blocks and takes the whole frame
+    int frameLength = static_cast<int>(headerLen + length);
+    if (!secure) {
+        BIO_write(writeBio, frameOut.data(), frameLength);
+    } else if (SSL_write(ssl, frameOut.data(), frameLength) <= 0) {
+        std::cerr << "UringSocket TLS write error: " << ERR_error_string(ERR_get_error(), nullptr) << std::endl;
+        return false;
+    }
+    flushTls();
+    if (io_uring_sq_ready(&ring) > 0) io_uring_submit(&ring);
+    return true;
+}
+
+void UringSocket::flushTls() {
+    // One write at a time keeps the byte stream in order; anything encrypted
+    // meanwhile goes out with the next one
+    if (sendInFlight) return;
+    size_t pending = BIO_ctrl_pending(writeBio);
+    if (pending == 0) return;
+    int n = BIO_read(writeBio, sendPool.data(), static_cast<int>(std::min(pending, SEND_BUFFER_SIZE)));
+    if (n <= 0) return;
+    sendLength = static_cast<size_t>(n);
+    sendOffset = 0;
+    sendInFlight = true;
+    submitSend();
+}
+
+void UringSocket::submitSend() {
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_write_fixed(sqe, fd, sendPool.data() + sendOffset, static_cast<unsigned>(sendLength - sendOffset), 0,
+                              SEND_BUFFER_INDEX);
+    io_uring_sqe_set_data64(sqe, OP_SEND);
+}
+
+void UringSocket::onSendComplete(int result) {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    if (result < 0) {
+        std::cerr << "UringSocket send error: " << std::strerror(-result) << std::endl;
+        sendInFlight = false;
+        running = false;
+        return;
+    }
+    sendOffset += static_cast<size_t>(result);
+    if (sendOffset < sendLength) {
+        // Short write: the rest of the same buffer goes first
+        submitSend();
+        return;
+    }
+    sendInFlight = false;
+    flushTls();
+}
+
+void UringSocket::close() {
+    closing = true;
+    if (running) {
+        // Send a close frame to server
+        sendFrame(0x8, nullptr, 0);
+        std::lock_guard<std::mutex> lock(ioMutex);
+        if (secure) {
+            SSL_shutdown(ssl);
+            flushTls();
+        }
+        running = false;
+        // Wake the completion thread out of io_uring_wait_cqe
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data64(sqe, OP_WAKE);
+        io_uring_submit(&ring);
+    }
+    if (completionThread.joinable()) completionThread.join();
+    release();
+}
+
+void UringSocket::release() {
+    if (ringReady) {
+        // Let the last write (close frame, close_notify) finish before the buffers go
+        while (sendInFlight) {
+            io_uring_cqe* cqe;
+            if (io_uring_wait_cqe(&ring, &cqe) < 0) break;
+            if (io_uring_cqe_get_data64(cqe) == OP_SEND) onSendComplete(cqe->res);
+            io_uring_cqe_seen(&ring, cqe);
+            io_uring_submit(&ring);
+        }
+    }
+    if (fd >= 0) {
+        ::shutdown(fd, SHUT_RDWR);
+        ::close(fd);
+        fd = -1;
+    }
+    if (ssl) {
+        SSL_free(ssl);
+        ssl = nullptr;
+        readBio = nullptr;
+        writeBio = nullptr;
+    } else if (writeBio) {
+        BIO_free(writeBio);
+        writeBio = nullptr;
+    }
+    if (bufRing) {
+        io_uring_free_buf_ring(&ring, bufRing, RECV_BUFFERS, RECV_GROUP);
+        bufRing = nullptr;
+    }
+    if (ringReady) {
+        io_uring_queue_exit(&ring);
+        ringReady = false;
+    }
+}
+
+} // namespace CustomWebSocket
@@ -0,0 +1,116 @@
+#ifndef URINGSOCKET_HPP
+#define URINGSOCKET_HPP
+
+#include <liburing.h>
+#include <openssl/ssl.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../Custom_WebSocket/CFrame.hpp"
+#include "../WebSocketpp/BSocket.hpp"
+#include "../WebSocketpp/ConnectionCache.hpp"
+
+namespace CustomWebSocket {
+
+// WebSocket client on io_uring (built with USE_URING). Experimental: only
+// the transport harnesses construct it, main.cpp does not offer it. The socket
+// is driven by one ring: a multishot receive fills kernel-selected buffers
+// from a provided buffer ring, and sends go out from a registered buffer.
+// TLS runs over memory BIOs (skipped for ws:// URLs) and framing is shared
+// with CSocket.
+//
+// One thread reaps completions, decrypts and delivers frames. send() may be
+// called from any thread: it encrypts into the write BIO and submits
+// immediately if no write is in flight; otherwise the bytes ride along with
+// the next write, which the completion of the current one submits.
+// write_fixed cannot pass MSG_NOSIGNAL, so the process should ignore SIGPIPE.
+class UringSocket : public BSocket {
+public:
+    static constexpr unsigned RING_ENTRIES = 256;
+    // Provided receive buffers, each large enough for a full TLS record
+    static constexpr unsigned RECV_BUFFERS = 64;
+    static constexpr size_t RECV_BUFFER_SIZE = 16 * 1024 + 512;
+    // Registered send buffer; larger backlogs go out in several writes
+    static constexpr size_t SEND_BUFFER_SIZE = 256 * 1024;
+    // Decrypted bytes awaiting framing; grows only for a larger frame
+    static constexpr size_t FRAME_BUFFER_SIZE = 1 << 20;
+
+    UringSocket();
+    ~UringSocket() override;
+
+    // ws[s]://host[:port]/path
+    bool connect(const std::string& url) override;
+    bool send(std::string_view message) override;
+    void close() override;
+
+private:
+    enum : uint64_t { OP_RECV = 1, OP_SEND = 2, OP_WAKE = 3 };
+
+    bool tcpConnect(const std::string& host, const std::string& port);
+    // Blocking steps used by connect(), before the completion thread starts
+    bool sendAllSync(const char* data, size_t length);
+    ssize_t recvSync(char* data, size_t length);
+    bool flushTlsSync();
+    bool fillTlsSync();
+    bool tlsHandshake(const std::string& host, const std::string& port);
+    bool upgrade(const std::string& host, const std::string& path);
+    bool setupBuffers();
+
+    void completionLoop();
+    void onRecv(const io_uring_cqe* cqe);
+    void onSendComplete(int result);
+    // With ioMutex held: arm the multishot receive
+    void armRecv();
+    // With ioMutex held: start a write of pending TLS output unless one is in flight
+    void flushTls();
+    void submitSend();
+    // Decrypt what the read BIO holds into the frame buffer
+    void readPlaintext();
+    void deliverFrames();
+    void handleFrame(uint8_t opcode, bool fin, char* payload, size_t length);
+    // Send a close frame with code and stop (bad frame from the server)
+    void failConnection(uint16_t code);
+    bool sendFrame(uint8_t opcode, const char* payload, size_t length);
+    void compactFrameBuffer(size_t needed);
+    void release();
+
+    io_uring ring;
+    bool ringReady = false;
+    io_uring_buf_ring* bufRing = nullptr;
+    int fd = -1;
+    bool secure = true;
+    SSL_CTX* sslCtx = nullptr;
+    SSL* ssl = nullptr;
+    BIO* readBio = nullptr;  // ciphertext from the socket
+    BIO* writeBio = nullptr; // ciphertext for the socket (plain frames for ws://)
+
+    // Guards the SSL object, the BIOs, the send state and the submission queue
+    std::mutex ioMutex;
+    std::atomic<bool> running{false};
+    // Set by close(), so the completion thread does not report a drop
+    std::atomic<bool> closing{false};
+    std::thread completionThread;
+
+    std::vector<char> recvPool;
+    std::vector<char> sendPool;
+    size_t sendLength = 0;
+    size_t sendOffset = 0;
+    bool sendInFlight = false;
+    // Frame being built by sendFrame (header + masked payload)
+    std::vector<char> frameOut;
+    MaskKeys maskKeys;
+
+    // Plaintext: [frameRead, frameWrite) holds bytes not yet framed
+    std::vector<char> frameBuffer;
+    size_t frameRead = 0;
+    size_t frameWrite = 0;
+    std::string fragments;
+    long long recvNs = 0;
+};
+
+} // namespace CustomWebSocket
+
+#endif // URINGSOCKET_HPP
@@ -1,17 +1,18 @@
 #include "Api.hpp"
 #include "Trader.hpp"
+#include "FlightRecorder.hpp"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <charconv>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
 Api::Api(BSocket* socket)
-    : socket(socket), trader(nullptr) {
+    : socket(socket), trader(nullptr), tracer(metrics) {
     requestIdCounter = 1;
     // Set this Api's onMessage as the socket callback
-    socket->setMessageHandler([this](const std::string& msg) {
-        this->onMessage(msg);
-    });
+    socket->setMessageHandler(MessageHandler::bind<Api, &Api::onMessage>(this));
 }
 
 Api::~Api() {
@@ -31,10 +32,44 @@ bool Api::connect(const std::string& url) {
     return true;
 }
 
+void Api::close() {
+    socket->close();
+}
+
+InstrumentId Api::addInstrument(const InstrumentSpec& spec) {
+    return addInstruments({spec}).front();
+}
+
+std::vector<InstrumentId> Api::addInstruments(const std::vector<InstrumentSpec>& specs) {
+    std::vector<InstrumentId> ids;
+    std::vector<std::pair<InstrumentId, std::string>> added;
+    for (const InstrumentSpec& spec : specs) {
+        InstrumentId id = books.add(spec.name, spec.tickSize);
+        ids.push_back(id);
+        if (id == INVALID_INSTRUMENT) continue;
+        added.emplace_back(id, spec.name);
+        metrics.addChannel(id, spec.name);
+        // Lets a replay register the same books under the same ids; the tick
+        // size in its shortest form that reads back as the same double
+        if (FlightRecorder::instance().enabled()) {
+            char tick[32];
+            auto result = std::to_chars(tick, tick + sizeof(tick), spec.tickSize);
+            FlightRecorder::record(FlightRecordType::InstrumentAdded, spec.name + " " + std::string(tick, result.ptr));
+        }
+    }
+    encoder.addInstruments(added);
+    return ids;
+}
+
 bool Api::authenticate(const std::string& client_id, const std::string& client_secret) {
     if (client_id.empty() || client_secret.empty()) {
         return false;
     }
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        clientId = client_id;
+        clientSecret = client_secret;
+    }
     // Build auth request
     int id = requestIdCounter.fetch_add(1);
     json authReq = {
@@ -47,123 +82,151 @@ bool Api::authenticate(const std::string& client_id, const std::string& client_s
             {"client_secret", client_secret}
         }}
     };
-    {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"auth", std::chrono::high_resolution_clock::now()};
-    }
+    pendingRequests.insert(id, {RequestKind::Auth, BSocket::clockNs()});
     std::string msg = authReq.dump();
-    socket->send(msg);
-    return true;
+    // The secret stays out of the flight recorder
+    FlightRecorder::record(FlightRecordType::Note, "public/auth id=" + std::to_string(id));
+    return socket->send(msg);
 }
 
 bool Api::subscribePublic(const std::string& channel) {
-    int id = requestIdCounter.fetch_add(1);
-    json req = {
-        {"jsonrpc", "2.0"},
-        {"id", id},
-        {"method", "public/subscribe"},
-        {"params", { {"channels", {channel}} }}
-    };
     {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"subscribe", std::chrono::high_resolution_clock::now()};
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        if (std::find(publicChannels.begin(), publicChannels.end(), channel) == publicChannels.end()) {
+            publicChannels.push_back(channel);
+        }
     }
-    return socket->send(req.dump());
+    return sendSubscribe("public/subscribe", {channel});
 }
 
 bool Api::subscribePrivate(const std::string& channel) {
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        if (std::find(privateChannels.begin(), privateChannels.end(), channel) == privateChannels.end()) {
+            privateChannels.push_back(channel);
+        }
+    }
+    // Note: require authentication done (accessToken not explicitly needed in subscribe call after auth)
+    return sendSubscribe("private/subscribe", {channel});
+}
+
+bool Api::sendSubscribe(const char* method, const std::vector<std::string>& channels) {
     int id = requestIdCounter.fetch_add(1);
     json req = {
         {"jsonrpc", "2.0"},
         {"id", id},
-        {"method", "private/subscribe"},
-        {"params", { {"channels", {channel}} }}
+        {"method", method},
+        {"params", { {"channels", channels} }}
     };
-    // Note: require authentication done (accessToken not explicitly needed in subscribe call after auth)
+    pendingRequests.insert(id, {RequestKind::Subscribe, BSocket::clockNs()});
+    return sendRequest(req.dump());
+}
+
+void Api::onReconnect() {
+    for (InstrumentId id = 0; id < books.size(); ++id) {
+        if (resetBooksOnReconnect) {
+            // Nothing is subscribed on the new connection yet, so no book update
+            // can race this: start over from the snapshot the channel sends
+            books.book(id).reset();
+        } else {
+            // The books stayed current; only a recovery snapshot requested on
+            // the dropped connection is lost, so let the next gap ask again
+            books.book(id).recoveryRequested = false;
+        }
+    }
+    std::string id, secret;
+    std::vector<std::string> publics, privates;
     {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"subscribe", std::chrono::high_resolution_clock::now()};
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        id = clientId;
+        secret = clientSecret;
+        publics = publicChannels;
+        privates = privateChannels;
+    }
+    EventRecord event(EventType::Reconnected);
+    event.ids[0] = publics.size();
+    event.ids[1] = privates.size();
+    EventLog::log(event);
+    FlightRecorder::record(FlightRecordType::Note, "reconnected");
+    // A failed send means the new connection dropped too; the next reconnect
+    // starts over, so there is no point in sending the rest
+    if (!id.empty() && !authenticate(id, secret)) {
+        std::cerr << "Reconnect: failed to send public/auth" << std::endl;
+        return;
+    }
+    if (!resubscribe("public/subscribe", publics)) return;
+    resubscribe("private/subscribe", privates);
+}
+
+bool Api::resubscribe(const char* method, const std::vector<std::string>& channels) {
+    // Channels go out in batches, so each request stays well under what a
+    // transport takes in one message, however many channels there are
+    std::vector<std::string> batch;
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        batch.push_back(channels[i]);
+        batchBytes += channels[i].size() + 3; // quotes and comma
+        bool last = i + 1 == channels.size();
+        if (!last && batchBytes + channels[i + 1].size() + 3 <= RESUBSCRIBE_BATCH_BYTES) continue;
+        if (!sendSubscribe(method, batch)) {
+            std::cerr << "Reconnect: failed to send " << method << " for " << batch.size() << " channels" << std::endl;
+            return false;
+        }
+        batch.clear();
+        batchBytes = 0;
     }
-    return socket->send(req.dump());
+    return true;
 }
 
 bool Api::placeOrder(const std::string& instrument, const std::string& side, double price, double amount) {
+    long long decidedNs = BSocket::clockNs();
+    // Orders placed in reaction to a book update carry its trace
+    const TraceContext* trace = Tracer::active;
+    char label[Tracer::LABEL_SIZE];
+    size_t labelSize = trace ? Tracer::formatLabel(trace->traceId, label) : 0;
     int id = requestIdCounter.fetch_add(1);
-    std::string method = (side == "buy") ? "private/buy" : "private/sell";
-    json params = {
-        {"instrument_name", instrument},
-        {"amount", amount},
-        {"type", "limit"},
-        {"price", price}
-    };
-    if (!accessToken.empty()) {
-        params["access_token"] = accessToken;
+    InstrumentId instrumentId = books.find(instrument);
+    std::string_view req = encoder.encodeOrder(instrumentId, side == "buy", id, price, amount, std::string_view(label, labelSize));
+    if (req.empty()) {
+        std::cerr << "placeOrder: instrument not registered: " << instrument << std::endl;
+        return false;
     }
-    json req = {
-        {"jsonrpc", "2.0"},
-        {"id", id},
-        {"method", method},
-        {"params", params}
-    };
-    {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"order", std::chrono::high_resolution_clock::now()};
+    long long encodedNs = BSocket::clockNs();
+    long long triggerNs = trace ? trace->receivedNs : 0;
+    pendingRequests.insert(id, {RequestKind::Order, encodedNs, instrumentId, triggerNs});
+    bool sent = sendRequest(req);
+    if (trace) {
+        long long sentNs = BSocket::clockNs();
+        metrics.recordTickToTrade(sentNs - triggerNs);
+        tracer.open(id, *trace, decidedNs, encodedNs, sentNs);
     }
-    bool sent = socket->send(req.dump());
     return sent;
 }
 
 bool Api::cancelOrder(const std::string& order_id) {
     int id = requestIdCounter.fetch_add(1);
-    json params = { {"order_id", order_id} };
-    if (!accessToken.empty()) params["access_token"] = accessToken;
-    json req = {
-        {"jsonrpc", "2.0"},
-        {"id", id},
-        {"method", "private/cancel"},
-        {"params", params}
-    };
-    {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"cancel", std::chrono::high_resolution_clock::now()};
-    }
-    return socket->send(req.dump());
+    std::string_view req = encoder.encodeCancel(id, order_id);
+    pendingRequests.insert(id, {RequestKind::Cancel, BSocket::clockNs()});
+    return sendRequest(req);
 }
 
 bool Api::editOrder(const std::string& order_id, double newPrice, double newAmount) {
     int id = requestIdCounter.fetch_add(1);
-    json params = {
-        {"order_id", order_id},
-        {"amount", newAmount},
-        {"price", newPrice}
-    };
-    if (!accessToken.empty()) params["access_token"] = accessToken;
-    json req = {
-        {"jsonrpc", "2.0"},
-        {"id", id},
-        {"method", "private/edit"},
-        {"params", params}
-    };
-    {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"edit", std::chrono::high_resolution_clock::now()};
-    }
-    return socket->send(req.dump());
+    std::string_view req = encoder.encodeEdit(id, order_id, newPrice, newAmount);
+    pendingRequests.insert(id, {RequestKind::Edit, BSocket::clockNs()});
+    return sendRequest(req);
 }
 
-bool Api::getOrderBook(const std::string& instrument) {
+bool Api::getOrderBook(const std::string& instrument, int depth) {
     int id = requestIdCounter.fetch_add(1);
     json req = {
         {"jsonrpc", "2.0"},
         {"id", id},
         {"method", "public/get_order_book"},
-        {"params", { {"instrument_name", instrument}, {"depth", 10} }}
+        {"params", { {"instrument_name", instrument}, {"depth", depth} }}
     };
-    {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"get_order_book", std::chrono::high_resolution_clock::now()};
-    }
-    return socket->send(req.dump());
+    pendingRequests.insert(id, {RequestKind::GetOrderBook, BSocket::clockNs(), books.find(instrument)});
+    return sendRequest(req.dump());
 }
 
 bool Api::getPositions(const std::string& currency) {
@@ -176,214 +239,333 @@ bool Api::getPositions(const std::string& currency) {
         {"method", "private/get_positions"},
         {"params", params}
     };
-    {
-        std::lock_guard<std::mutex> lock(reqMutex);
-        pendingRequests[id] = {"get_positions", std::chrono::high_resolution_clock::now()};
+    pendingRequests.insert(id, {RequestKind::GetPositions, BSocket::clockNs()});
+    return sendRequest(req.dump());
+}
+
+const OrderBook* Api::findBook(const std::string& instrument) const {
+    InstrumentId id = books.find(instrument);
+    return id == INVALID_INSTRUMENT ? nullptr : &books.book(id);
+}
+
+bool Api::trackRequest(std::string_view request) {
+    json req = json::parse(request, nullptr, false);
+    if (!req.is_object() || !req.contains("id") || !req["id"].is_number_integer()) return false;
+    static const std::unordered_map<std::string, RequestKind> kinds = {
+        {"public/auth", RequestKind::Auth},
+        {"public/subscribe", RequestKind::Subscribe},
+        {"private/subscribe", RequestKind::Subscribe},
+        {"private/buy", RequestKind::Order},
+        {"private/sell", RequestKind::Order},
+        {"private/cancel", RequestKind::Cancel},
+        {"private/edit", RequestKind::Edit},
+        {"public/get_order_book", RequestKind::GetOrderBook},
+        {"private/get_positions", RequestKind::GetPositions},
+    };
+    auto kind = kinds.find(req.value("method", ""));
+    if (kind == kinds.end()) return false;
+    InstrumentId instrument = INVALID_INSTRUMENT;
+    if (req.contains("params") && req["params"].is_object()) {
+        instrument = books.find(req["params"].value("instrument_name", ""));
+    }
+    pendingRequests.insert(req["id"].get<int>(), {kind->second, BSocket::clockNs(), instrument});
+    return true;
+}
+
+bool Api::sendRequest(std::string_view request) {
+    FlightRecorder::record(FlightRecordType::Outbound, request);
+    return socket->send(request);
+}
+
+void Api::recordBookApply(InstrumentId id, const OrderBook& book, bool snapshot) {
+    FlightBookApply apply{id, snapshot ? 1u : 0u, book.changeId, 0.0, 0.0};
+    if (book.hasBids()) {
+        apply.flags |= 2;
+        apply.bestBid = book.bestBid();
+    }
+    if (book.hasAsks()) {
+        apply.flags |= 4;
+        apply.bestAsk = book.bestAsk();
+    }
+    FlightRecorder::record(FlightRecordType::BookApply, &apply, sizeof(apply));
+}
+
+void Api::applyBookSide(OrderBook& book, OrderBook::Side side, const std::vector<BookLevel>& levels) {
+    for (const auto& level : levels) {
+        book.applyLevel(side, level.action, level.price, level.amount);
+    }
+}
+
+void Api::bufferBookSide(OrderBook& book, OrderBook::Side side, const std::vector<BookLevel>& levels,
+                         uint64_t changeId, uint64_t prevChangeId) {
+    for (const auto& level : levels) {
+        if (!book.bufferLevel(changeId, prevChangeId, side, level.action, level.price, level.amount)) {
+            return; // overflow: the next snapshot restarts recovery
+        }
+    }
+}
+
+void Api::requestBookSnapshot(OrderBook& book) {
+    if (book.recoveryRequested) return;
+    book.recoveryRequested = true;
+    getOrderBook(book.instrument, RECOVERY_SNAPSHOT_DEPTH);
+}
+
+void Api::resumeBook(OrderBook& book) {
+    if (book.replayBuffered()) {
+        EventRecord event(EventType::BookResync);
+        EventRecord::setText(event.key, book.instrument);
+        event.ids[0] = book.changeId;
+        EventLog::log(event);
+        return;
+    }
+    // The snapshot does not chain onto the buffered deltas (older than the
+    // gap, or the buffer overflowed): start over with a fresh snapshot
+    if (book.bufferOverflowed()) {
+        book.beginRecovery();
     }
-    return socket->send(req.dump());
+    requestBookSnapshot(book);
 }
 
-void Api::logJsonEvent(const json& j) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    std::cout << j.dump() << std::endl;
+void Api::setBestPrices(EventRecord& event, const OrderBook& book, int index) {
+    if (book.hasBids()) {
+        event.flags |= EventRecord::HasBestBid;
+        event.values[index] = book.bestBid();
+    }
+    if (book.hasAsks()) {
+        event.flags |= EventRecord::HasBestAsk;
+        event.values[index + 1] = book.bestAsk();
+    }
 }
 
-void Api::onMessage(const std::string& message) {
-    // Record receive time for latency measurements
-    auto receiveTime = std::chrono::high_resolution_clock::now();
-    // Parse message to JSON
-    json msgJson;
-    try {
-        msgJson = json::parse(message);
-    } catch (...) {
+void Api::onMessage(std::string_view message, long long receivedNs) {
+    long long deliveredNs = BSocket::clockNs();
+    FlightRecorder::record(FlightRecordType::Inbound, message);
+    // Decode the message into the reused inbound struct (no DOM, no allocation)
+    DeribitMessage& msg = inbound;
+    if (!parser.parse(message, msg)) {
         std::cerr << "Failed to parse incoming message as JSON: " << message << std::endl;
         return;
     }
+    long long parsedNs = BSocket::clockNs();
+    metrics.recordParse(parsedNs - receivedNs);
     // If this is a subscription update (no id, has method)
-    if (msgJson.contains("method") && msgJson["method"] == "subscription") {
-        std::string channel = msgJson["params"]["channel"];
+    if (msg.kind == DeribitMessage::Kind::Subscription) {
+        std::string_view channel = msg.channel;
+        switch (channelKind(channel)) {
         // Market data update (order book changes)
-        if (channel.rfind("book.", 0) == 0) {
-            // Calculate propagation delay if possible
-            long propagation_ms = 0;
-            if (msgJson["params"]["data"].contains("timestamp")) {
-                // timestamp is in milliseconds
-                long evtTs = msgJson["params"]["data"]["timestamp"];
-                auto evtTimePoint = std::chrono::system_clock::time_point(std::chrono::milliseconds(evtTs));
-                auto evtTimeLocal = std::chrono::time_point_cast<std::chrono::milliseconds>(evtTimePoint).time_since_epoch().count();
-                auto recvTimeLocal = std::chrono::time_point_cast<std::chrono::milliseconds>(receiveTime).time_since_epoch().count();
-                propagation_ms = recvTimeLocal - evtTimeLocal;
+        case ChannelKind::Book: {
+            InstrumentId instrumentId = books.findChannel(channel);
+            if (instrumentId == INVALID_INSTRUMENT) {
+                return; // not a registered instrument
             }
-            // Update internal order book snapshot (replace with latest top levels)
-            orderBook.bids.clear();
-            orderBook.asks.clear();
-            if (msgJson["params"]["data"].contains("bids")) {
-                for (auto& level : msgJson["params"]["data"]["bids"]) {
-                    double price = level[0];
-                    double size = level[1];
-                    if (size > 1e-12) {
-                        orderBook.bids[price] = size;
-                    }
-                }
+            OrderBook& orderBook = books.book(instrumentId);
+            // Propagation delay: exchange timestamp (ms) to socket receive
+            long long propagationNs = 0;
+            if (msg.hasTimestamp) {
+                propagationNs = TscClock::toWallNs(receivedNs) - static_cast<long long>(msg.timestamp) * 1'000'000;
+                metrics.recordPropagation(propagationNs);
             }
-            if (msgJson["params"]["data"].contains("asks")) {
-                for (auto& level : msgJson["params"]["data"]["asks"]) {
-                    double price = level[0];
-                    double size = level[1];
-                    if (size > 1e-12) {
-                        orderBook.asks[price] = size;
-                    }
+            // Update internal order book: raw/100ms channels send one "snapshot"
+            // followed by "change" deltas applied in place; grouped channels
+            // (no "type") always carry the full book
+            bool isSnapshot = msg.type.empty() || msg.type == "snapshot";
+            if (isSnapshot) {
+                orderBook.clear();
+                applyBookSide(orderBook, OrderBook::Side::Bid, msg.bids);
+                applyBookSide(orderBook, OrderBook::Side::Ask, msg.asks);
+                orderBook.changeId = msg.changeId;
+                if (orderBook.syncState == OrderBook::SyncState::Recovering) {
+                    resumeBook(orderBook);
+                } else {
+                    orderBook.syncState = OrderBook::SyncState::Synced;
+                }
+            } else {
+                if (orderBook.syncState != OrderBook::SyncState::Recovering &&
+                    !orderBook.continues(msg.prevChangeId)) {
+                    // Missed at least one delta: hold this instrument's updates
+                    // and resync it from a snapshot, other books keep running
+                    EventRecord gapEvent(EventType::BookGap);
+                    EventRecord::setText(gapEvent.key, orderBook.instrument);
+                    gapEvent.ids[0] = orderBook.changeId;
+                    gapEvent.ids[1] = msg.prevChangeId;
+                    EventLog::log(gapEvent);
+                    orderBook.beginRecovery();
                 }
+                if (orderBook.syncState == OrderBook::SyncState::Recovering) {
+                    bufferBookSide(orderBook, OrderBook::Side::Bid, msg.bids, msg.changeId, msg.prevChangeId);
+                    bufferBookSide(orderBook, OrderBook::Side::Ask, msg.asks, msg.changeId, msg.prevChangeId);
+                    requestBookSnapshot(orderBook);
+                    return;
+                }
+                applyBookSide(orderBook, OrderBook::Side::Bid, msg.bids);
+                applyBookSide(orderBook, OrderBook::Side::Ask, msg.asks);
+                orderBook.changeId = msg.changeId;
+            }
+            if (orderBook.syncState != OrderBook::SyncState::Synced) {
+                return; // still waiting for a snapshot the buffered deltas chain onto
+            }
+            // Processing latency (receive to book updated), per channel
+            long long appliedNs = BSocket::clockNs();
+            if (FlightRecorder::instance().enabled()) recordBookApply(instrumentId, orderBook, isSnapshot);
+            long long processNs = appliedNs - receivedNs;
+            metrics.recordProcessing(instrumentId, processNs);
+            if (logMarketUpdates) {
+                EventRecord logEvent(EventType::MarketUpdate);
+                EventRecord::setText(logEvent.key, channel);
+                logEvent.values[0] = static_cast<double>(propagationNs / 1'000'000);
+                logEvent.values[1] = processNs / 1e6;
+                setBestPrices(logEvent, orderBook, 2);
+                EventLog::log(logEvent);
             }
-            // Calculate processing latency (time to handle this message)
-            auto afterProcess = std::chrono::high_resolution_clock::now();
-            auto process_us = std::chrono::duration_cast<std::chrono::microseconds>(afterProcess - receiveTime).count();
-            double process_ms = process_us / 1000.0;
-            // Log market update
-            json logEvent = {
-                {"event", "market_update"},
-                {"channel", channel},
-                {"propagation_ms", propagation_ms},
-                {"process_ms", process_ms}
-            };
-            if (!orderBook.bids.empty()) logEvent["best_bid"] = orderBook.bids.begin()->first;
-            if (!orderBook.asks.empty()) logEvent["best_ask"] = orderBook.asks.begin()->first;
-            logJsonEvent(logEvent);
             // Notify trader about book update
             if (trader) {
+                // Orders the strategy places from here join this update's trace
+                TraceContext trace{tracer.nextTraceId(), receivedNs, deliveredNs, parsedNs, appliedNs};
+                Tracer::active = &trace;
                 trader->onOrderBookUpdate(orderBook);
+                Tracer::active = nullptr;
             }
+            break;
         }
         // User order update (if subscribed)
-        else if (channel.rfind("user.orders", 0) == 0) {
-            auto data = msgJson["params"]["data"];
-            std::string ordId = data.value("order_id", "");
-            std::string state = data.value("order_state", "");
-            json logEvent = {
-                {"event", "order_update"},
-                {"order_id", ordId},
-                {"order_state", state}
-            };
-            if (data.contains("filled_amount")) {
-                logEvent["filled_amount"] = data["filled_amount"];
+        case ChannelKind::UserOrders: {
+            std::string ordId(msg.orderId);
+            std::string_view state = msg.orderState;
+            EventRecord logEvent(EventType::OrderUpdate);
+            EventRecord::setText(logEvent.key, msg.orderId);
+            EventRecord::setText(logEvent.detail, state);
+            if (msg.hasFilledAmount) {
+                logEvent.flags |= EventRecord::HasFilled;
+                logEvent.values[0] = msg.filledAmount;
+            }
+            EventLog::log(logEvent);
+            if (state == "filled" && !msg.label.empty()) {
+                tracer.fill(msg.label, receivedNs);
             }
-            logJsonEvent(logEvent);
             if (trader) {
                 if (state == "filled" || state == "cancelled" || state == "rejected") {
                     trader->onOrderClosed(ordId);
                 }
             }
+            break;
+        }
+        default:
+            break;
         }
         return;
     }
     // If this is a response to a request (has id)
-    if (msgJson.contains("id")) {
-        int respId = msgJson["id"];
+    if (msg.hasId) {
+        int respId = static_cast<int>(msg.id);
         // Locate request info
         RequestInfo reqInfo;
-        {
-            std::lock_guard<std::mutex> lock(reqMutex);
-            if (pendingRequests.find(respId) != pendingRequests.end()) {
-                reqInfo = pendingRequests[respId];
-                pendingRequests.erase(respId);
-            } else {
-                // Unknown request id (maybe timed out or already handled)
-                reqInfo.type = "";
-            }
+        if (!pendingRequests.take(respId, reqInfo)) {
+            // Unknown request id (maybe timed out or already handled)
+            reqInfo.kind = RequestKind::None;
         }
         // Handle error if present
-        if (msgJson.contains("error") && !msgJson["error"].is_null()) {
-            std::string errorMsg = msgJson["error"].dump();
-            json logEvent = { {"event", "error"}, {"type", reqInfo.type}, {"details", errorMsg} };
-            logJsonEvent(logEvent);
+        if (msg.kind == DeribitMessage::Kind::Error) {
+            // A failed recovery snapshot is retried on the book's next delta
+            if (reqInfo.kind == RequestKind::GetOrderBook && reqInfo.instrument != INVALID_INSTRUMENT) {
+                books.book(reqInfo.instrument).recoveryRequested = false;
+            }
+            EventRecord logEvent(EventType::Error);
+            EventRecord::setText(logEvent.detail, requestKindName(reqInfo.kind));
+            logEvent.ids[0] = static_cast<uint64_t>(msg.errorCode);
+            EventRecord::setText(logEvent.key, msg.errorMessage);
+            EventLog::log(logEvent);
             return;
         }
         // Compute latency for this response
         double latency_ms = 0.0;
-        if (!reqInfo.type.empty()) {
-            auto sentTime = reqInfo.sentTime;
-            auto now = std::chrono::high_resolution_clock::now();
-            latency_ms = std::chrono::duration<double, std::milli>(now - sentTime).count();
+        if (reqInfo.kind != RequestKind::None) {
+            long long latencyNs = BSocket::clockNs() - reqInfo.sentNs;
+            metrics.recordRequest(reqInfo.kind, latencyNs);
+            latency_ms = latencyNs / 1e6;
         }
         // Specific handling by request type
-        if (reqInfo.type == "auth") {
-            if (msgJson.contains("result") && msgJson["result"].contains("access_token")) {
-                accessToken = msgJson["result"]["access_token"];
-                json logEvent = { {"event", "auth_success"}, {"latency_ms", latency_ms} };
-                logJsonEvent(logEvent);
+        switch (reqInfo.kind) {
+        case RequestKind::Auth: {
+            if (!msg.accessToken.empty()) {
+                accessToken = std::string(msg.accessToken);
+                encoder.setAccessToken(accessToken);
+                EventRecord logEvent(EventType::AuthSuccess);
+                logEvent.values[0] = latency_ms;
+                EventLog::log(logEvent);
             } else {
-                json logEvent = { {"event", "auth_failed"} };
-                logJsonEvent(logEvent);
+                EventLog::log(EventRecord(EventType::AuthFailed));
             }
+            break;
         }
-        else if (reqInfo.type == "order") {
+        case RequestKind::Order: {
             // Log order ack and latency
-            std::string orderId = "";
-            std::string orderState = "";
-            if (msgJson.contains("result")) {
-                auto result = msgJson["result"];
-                if (result.contains("order")) {
-                    orderId = result["order"]["order_id"].get<std::string>();
-                    orderState = result["order"]["order_state"].get<std::string>();
-                }
-            }
-            json logEvent = {
-                {"event", "order_ack"},
-                {"order_id", orderId},
-                {"order_state", orderState},
-                {"latency_ms", latency_ms}
-            };
+            std::string orderId(msg.orderId);
+            std::string_view orderState = msg.orderState;
+            EventRecord logEvent(EventType::OrderAck);
+            EventRecord::setText(logEvent.key, orderId);
+            EventRecord::setText(logEvent.detail, orderState);
+            logEvent.values[0] = latency_ms;
             // If this order was triggered by a market event, measure end-to-end latency
-            if (triggerEventTime.find(respId) != triggerEventTime.end()) {
-                auto trigTime = triggerEventTime[respId];
-                triggerEventTime.erase(respId);
-                double loopLatency = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - trigTime).count();
-                logEvent["trading_loop_latency_ms"] = loopLatency;
+            if (reqInfo.triggerNs != 0) {
+                logEvent.flags |= EventRecord::HasLoopLatency;
+                logEvent.values[1] = (BSocket::clockNs() - reqInfo.triggerNs) / 1e6;
             }
-            logJsonEvent(logEvent);
+            EventLog::log(logEvent);
+            tracer.close(respId, receivedNs, orderId, orderState);
             // If order is open, inform Trader
             if (trader && !orderId.empty() && orderState == "open") {
-                trader->onOrderOpen(orderId);
+                trader->onOrderOpen(orderId, reqInfo.instrument);
             }
+            break;
         }
-        else if (reqInfo.type == "cancel") {
-            json logEvent = { {"event", "cancel_ack"}, {"latency_ms", latency_ms} };
-            logJsonEvent(logEvent);
+        case RequestKind::Cancel: {
+            EventRecord logEvent(EventType::CancelAck);
+            logEvent.values[0] = latency_ms;
+            EventLog::log(logEvent);
+            break;
         }
-        else if (reqInfo.type == "edit") {
-            json logEvent = { {"event", "edit_ack"}, {"latency_ms", latency_ms} };
-            logJsonEvent(logEvent);
+        case RequestKind::Edit: {
+            EventRecord logEvent(EventType::EditAck);
+            logEvent.values[0] = latency_ms;
+            EventLog::log(logEvent);
+            break;
         }
-        else if (reqInfo.type == "get_order_book") {
-            // Update internal order book from result
-            orderBook.bids.clear();
-            orderBook.asks.clear();
-            if (msgJson.contains("result")) {
-                auto result = msgJson["result"];
-                if (result.contains("bids")) {
-                    for (auto& level : result["bids"]) {
-                        double price = level[0];
-                        double size = level[1];
-                        orderBook.bids[price] = size;
-                    }
-                }
-                if (result.contains("asks")) {
-                    for (auto& level : result["asks"]) {
-                        double price = level[0];
-                        double size = level[1];
-                        orderBook.asks[price] = size;
-                    }
+        case RequestKind::GetOrderBook: {
+            // Seed the book from the snapshot; once the book channel has delivered
+            // a newer state the deltas own the book and the snapshot is ignored
+            if (reqInfo.instrument == INVALID_INSTRUMENT) {
+                return; // snapshot for an instrument that is not registered
+            }
+            OrderBook& orderBook = books.book(reqInfo.instrument);
+            // Only an unseeded or recovering book takes the snapshot; a synced
+            // book is owned by its channel deltas
+            if (orderBook.syncState != OrderBook::SyncState::Synced) {
+                orderBook.clear();
+                applyBookSide(orderBook, OrderBook::Side::Bid, msg.bids);
+                applyBookSide(orderBook, OrderBook::Side::Ask, msg.asks);
+                orderBook.changeId = msg.changeId;
+                if (orderBook.syncState == OrderBook::SyncState::Recovering) {
+                    orderBook.recoveryRequested = false;
+                    resumeBook(orderBook);
+                } else {
+                    orderBook.syncState = OrderBook::SyncState::Synced;
                 }
+                if (FlightRecorder::instance().enabled()) recordBookApply(reqInfo.instrument, orderBook, true);
             }
-            json logEvent = { {"event", "order_book_snapshot"}, {"latency_ms", latency_ms} };
-            if (!orderBook.bids.empty()) logEvent["best_bid"] = orderBook.bids.begin()->first;
-            if (!orderBook.asks.empty()) logEvent["best_ask"] = orderBook.asks.begin()->first;
-            logJsonEvent(logEvent);
+            EventRecord logEvent(EventType::OrderBookSnapshot);
+            EventRecord::setText(logEvent.key, orderBook.instrument);
+            logEvent.values[0] = latency_ms;
+            setBestPrices(logEvent, orderBook, 1);
+            EventLog::log(logEvent);
+            break;
         }
-        else if (reqInfo.type == "get_positions") {
+        case RequestKind::GetPositions: {
+            // Positions are rare and variable-shaped; decode the result array with the DOM
             positions.clear();
-            if (msgJson.contains("result")) {
-                for (auto& pos : msgJson["result"]) {
+            json result = json::parse(msg.body, nullptr, false);
+            if (result.is_array()) {
+                for (auto& pos : result) {
                     Position p;
                     p.instrument = pos.value("instrument_name", "");
                     p.size = pos.value("size", 0.0);
@@ -391,17 +573,29 @@ void Api::onMessage(const std::string& message) {
                     positions.push_back(p);
                 }
             }
-            json logEvent = { {"event", "positions_snapshot"}, {"latency_ms", latency_ms} };
-            for (auto& p : positions) {
-                json pj = { {"instrument", p.instrument}, {"size", p.size}, {"avg_price", p.average_price} };
-                logEvent["positions"].push_back(pj);
+            // The snapshot and its positions are logged as one group
+            std::vector<EventRecord> logEvents(1 + positions.size(), EventRecord(EventType::PositionsSnapshot));
+            logEvents[0].values[0] = latency_ms;
+            logEvents[0].count = static_cast<uint32_t>(positions.size());
+            for (size_t i = 0; i < positions.size(); ++i) {
+                EventRecord& pe = logEvents[i + 1];
+                pe.type = EventType::Position;
+                EventRecord::setText(pe.key, positions[i].instrument);
+                pe.values[0] = positions[i].size;
+                pe.values[1] = positions[i].average_price;
             }
-            logJsonEvent(logEvent);
+            EventLog::instance().write(logEvents.data(), logEvents.size());
+            break;
         }
         // subscribe ack (we don't explicitly log unless needed)
-        else if (reqInfo.type == "subscribe") {
-            json logEvent = { {"event", "subscribe_ack"}, {"latency_ms", latency_ms} };
-            logJsonEvent(logEvent);
+        case RequestKind::Subscribe: {
+            EventRecord logEvent(EventType::SubscribeAck);
+            logEvent.values[0] = latency_ms;
+            EventLog::log(logEvent);
+            break;
+        }
+        case RequestKind::None:
+            break;
         }
     }
-}
\ No newline at end of file
+}
@@ -7,7 +7,15 @@
 #include <unordered_map>
 #include <chrono>
 #include <mutex>
+#include <atomic>
 #include "BSocket.hpp"
+#include "BookRegistry.hpp"
+#include "DeribitParser.hpp"
+#include "Dispatch.hpp"
+#include "EventLog.hpp"
+#include "Metrics.hpp"
+#include "OrderEncoder.hpp"
+#include "RequestTable.hpp"
 #include "Trader.hpp"
 #include "utility.hpp"
 #include <nlohmann/json.hpp>
@@ -22,45 +30,104 @@ public:
 
     // Connect and authenticate (if credentials provided) using the underlying socket
     bool connect(const std::string& url);
+    void close();
     bool authenticate(const std::string& client_id, const std::string& client_secret);
     bool subscribePublic(const std::string& channel);
     bool subscribePrivate(const std::string& channel);
     bool placeOrder(const std::string& instrument, const std::string& side, double price, double amount);
     bool cancelOrder(const std::string& order_id);
     bool editOrder(const std::string& order_id, double newPrice, double newAmount);
-    bool getOrderBook(const std::string& instrument);
+    bool getOrderBook(const std::string& instrument, int depth = 10);
     bool getPositions(const std::string& currency);
 
+    // Track an instrument's order book; call before subscribing to its channels
+    InstrumentId addInstrument(const InstrumentSpec& spec);
+    // Same for several instruments, rendering their order templates once;
+    // ids in the order of specs (INVALID_INSTRUMENT for those not tracked)
+    std::vector<InstrumentId> addInstruments(const std::vector<InstrumentSpec>& specs);
+
     // Set trader callback for events
     void setTrader(Trader* trader) { this->trader = trader; }
 
-    // Handler for incoming messages (called by BSocket)
-    void onMessage(const std::string& message);
+    // Latency histograms fed by onMessage; start their reporter to log them
+    Metrics& latencyMetrics() { return metrics; }
+    // Tick-to-trade traces of orders placed from Trader::onOrderBookUpdate
+    Tracer& orderTracer() { return tracer; }
+    // Also log a market_update event per book update (off by default: the
+    // per-channel histograms cover the latencies at a fraction of the cost)
+    void setLogMarketUpdates(bool enabled) { logMarketUpdates = enabled; }
+
+    // Book of a tracked instrument, nullptr if not registered
+    const OrderBook* findBook(const std::string& instrument) const;
+    // Register a request another session sent (e.g. from a flight recording)
+    // as pending without sending it, so its replayed response is handled as
+    // it was live. False if the request has no id or an unknown method.
+    bool trackRequest(std::string_view request);
+
+    // Handler for incoming messages (called by BSocket on its reader thread)
+    void onMessage(std::string_view message, long long receivedNs);
+    // After ConnectionManager replaced a dropped connection: reset the books,
+    // authenticate again and restore every subscription
+    void onReconnect();
+    // Off when other connections keep the books current across a reconnect
+    // (ArbitratedSocket): onReconnect then leaves them as they are, and the
+    // resubscribe snapshot only replaces a book that is behind it
+    void setResetBooksOnReconnect(bool reset) { resetBooksOnReconnect = reset; }
 
 private:
     BSocket* socket;
     Trader* trader;
     std::string accessToken;
+    // Replayed by onReconnect; guarded by sessionMutex
+    std::mutex sessionMutex;
+    std::string clientId;
+    std::string clientSecret;
+    std::vector<std::string> publicChannels;
+    std::vector<std::string> privateChannels;
     std::atomic<int> requestIdCounter;
 
     // Data structures for tracking
     struct Position { std::string instrument; double size; double average_price; };
     std::vector<Position> positions;
-    struct OrderBook {
-        std::map<double,double,std::greater<double>> bids;
-        std::map<double,double,std::less<double>> asks;
-    } orderBook;
+    BookRegistry books;
+    // Pre-rendered order/cancel/edit requests, refreshed on auth and addInstrument
+    OrderEncoder encoder;
+    // Levels requested when resynchronising a book after a change_id gap
+    static constexpr int RECOVERY_SNAPSHOT_DEPTH = 1000;
 
     // Track pending request types and timestamps for latency measurement
-    struct RequestInfo { std::string type; std::chrono::high_resolution_clock::time_point sentTime; };
-    std::mutex reqMutex;
-    std::unordered_map<int, RequestInfo> pendingRequests;
+    RequestTable pendingRequests;
+    Metrics metrics;
+    Tracer tracer;
+    bool logMarketUpdates = false;
+    bool resetBooksOnReconnect = true;
+
+    // Inbound decoding state, reused for every message on the socket thread
+    DeribitParser parser;
+    DeribitMessage inbound;
 
-    // For linking order responses to trigger events (end-to-end latency)
-    std::unordered_map<int, std::chrono::high_resolution_clock::time_point> triggerEventTime;
+    // Apply a bids/asks array from a book notification or get_order_book result
+    void applyBookSide(OrderBook& book, OrderBook::Side side, const std::vector<BookLevel>& levels);
+    // Buffer the deltas of a book notification while the book is recovering
+    void bufferBookSide(OrderBook& book, OrderBook::Side side, const std::vector<BookLevel>& levels,
+                        uint64_t changeId, uint64_t prevChangeId);
+    // Fetch a snapshot for one book after a gap (at most one request in flight)
+    void requestBookSnapshot(OrderBook& book);
+    // Replay buffered deltas once a recovery snapshot has been applied
+    void resumeBook(OrderBook& book);
 
-    // Utility for logging JSON events
-    void logJsonEvent(const nlohmann::json& j);
+    bool sendSubscribe(const char* method, const std::vector<std::string>& channels);
+    // Channel bytes per subscribe request sent by onReconnect
+    static constexpr size_t RESUBSCRIBE_BATCH_BYTES = 1536;
+    // Subscribe to channels in batches of at most RESUBSCRIBE_BATCH_BYTES;
+    // false once a batch fails to send
+    bool resubscribe(const char* method, const std::vector<std::string>& channels);
+    // Hand a request to the socket, keeping a copy in the flight recorder
+    bool sendRequest(std::string_view request);
+    // Flight recorder entry for a book that has just been applied
+    static void recordBookApply(InstrumentId id, const OrderBook& book, bool snapshot);
+    // Best bid/ask into values[index] and values[index + 1] of a log event
+    static void setBestPrices(EventRecord& event, const OrderBook& book, int index);
 };
 
 #endif 
\ No newline at end of file
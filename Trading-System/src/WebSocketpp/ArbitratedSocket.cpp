@@ -0,0 +1,252 @@
+#include "ArbitratedSocket.hpp"
+#include "Dispatch.hpp"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+
+namespace {
+
+// Deribit sends compact JSON, so the fields arbitration needs are found by
+// their exact key text without parsing the whole message (Api parses the
+// winner anyway). Key strings include the opening quote: "change_id" does
+// not match inside "prev_change_id".
+constexpr std::string_view CHANNEL_KEY = "\"channel\":\"";
+constexpr std::string_view CHANGE_ID_KEY = "\"change_id\":";
+constexpr std::string_view PREV_CHANGE_ID_KEY = "\"prev_change_id\":";
+constexpr std::string_view SNAPSHOT_FIELD = "\"type\":\"snapshot\"";
+constexpr std::string_view SUBSCRIBE_METHOD = "\"public/subscribe\"";
+constexpr std::string_view CHANNELS_KEY = "\"channels\":[";
+
+std::string_view stringField(std::string_view json, std::string_view key) {
+    size_t pos = json.find(key);
+    if (pos == std::string_view::npos) return {};
+    pos += key.size();
+    size_t end = json.find('"', pos);
+    if (end == std::string_view::npos) return {};
+    return json.substr(pos, end - pos);
+}
+
+bool uintField(std::string_view json, std::string_view key, uint64_t& out) {
+    size_t pos = json.find(key);
+    if (pos == std::string_view::npos) return false;
+    const char* begin = json.data() + pos + key.size();
+    return std::from_chars(begin, json.data() + json.size(), out).ec == std::errc();
+}
+
+} // namespace
+
+ArbitratedSocket::ArbitratedSocket(ConnectionManager::Factory factory, size_t lines)
+    : factory(std::move(factory)), lineCount(lines == 0 ? 1 : lines), table(MAX_CHANNELS) {}
+
+ArbitratedSocket::~ArbitratedSocket() {
+    close();
+}
+
+bool ArbitratedSocket::connect(const std::string& url) {
+    return connect(std::vector<std::string>(lineCount, url));
+}
+
+bool ArbitratedSocket::connect(const std::vector<std::string>& urls) {
+    // All lines exist before the first connects, so readers never see the
+    // vector change
+    for (size_t i = 0; i < urls.size(); ++i) {
+        auto line = std::make_unique<Line>();
+        line->owner = this;
+        line->index = i;
+        line->socket = std::make_unique<ConnectionManager>(factory);
+        line->socket->setMessageHandler(MessageHandler::bind<Line, &Line::onMessage>(line.get()));
+        line->socket->setReconnectHandler(ConnectionHandler::bind<Line, &Line::onReconnect>(line.get()));
+        line->socket->setLowLatency(lowLatency);
+        lines.push_back(std::move(line));
+    }
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (lines[i]->socket->connect(urls[i])) continue;
+        if (i == 0) {
+            std::cerr << "Primary market data line to " << urls[i] << " failed" << std::endl;
+            close();
+            return false;
+        }
+        // A missing secondary only costs redundancy; sends to it just fail
+        std::cerr << "Market data line " << i << " to " << urls[i] << " failed, continuing without it" << std::endl;
+    }
+    return true;
+}
+
+bool ArbitratedSocket::send(std::string_view message) {
+    if (lines.empty()) return false;
+    bool sent = lines[0]->socket->send(message);
+    if (message.find(SUBSCRIBE_METHOD) == std::string_view::npos) return sent;
+    // Market data subscriptions go out on every line
+    size_t begin = message.find(CHANNELS_KEY);
+    size_t end = begin == std::string_view::npos ? begin : message.find(']', begin);
+    if (end != std::string_view::npos) {
+        std::string channels(message.substr(begin, end + 1 - begin));
+        std::lock_guard<std::mutex> lock(subscriptionMutex);
+        bool known = false;
+        for (const std::string& s : subscriptions) known = known || s == channels;
+        if (!known) subscriptions.push_back(std::move(channels));
+    }
+    for (size_t i = 1; i < lines.size(); ++i) {
+        lines[i]->socket->send(message);
+    }
+    return sent;
+}
+
+void ArbitratedSocket::close() {
+    for (auto& line : lines) {
+        line->socket->close();
+    }
+}
+
+ArbitratedSocket::Slot* ArbitratedSocket::slotFor(uint64_t channelHash) {
+    // 0 marks a free slot
+    if (channelHash == 0) channelHash = 1;
+    size_t mask = table.size() - 1;
+    for (size_t i = 0, pos = channelHash & mask; i < table.size(); ++i, pos = (pos + 1) & mask) {
+        Slot& slot = table[pos];
+        if (slot.channelHash == channelHash) return &slot;
+        if (slot.channelHash == 0) {
+            slot.channelHash = channelHash;
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void ArbitratedSocket::onLineMessage(Line& line, std::string_view payload, long long receivedNs) {
+    std::string_view channel = stringField(payload, CHANNEL_KEY);
+    uint64_t changeId = 0;
+    bool arbitrated = !channel.empty() && channelKind(channel) == ChannelKind::Book &&
+                      uintField(payload, CHANGE_ID_KEY, changeId);
+    bool primary = line.index == 0;
+    std::lock_guard<std::mutex> lock(deliveryMutex);
+    Slot* slot = arbitrated ? slotFor(fnv1a(channel)) : nullptr;
+    if (!slot) {
+        // Responses and other channels come from the primary only (as does
+        // everything once the table is full)
+        if (primary && messageHandler) messageHandler(payload, receivedNs);
+        return;
+    }
+    // Updates held after a gap have waited long enough for another line
+    if (slot->heldCount > 0 && receivedNs - slot->heldSinceNs > MAX_HOLD_NS) releaseHeld(*slot);
+    if (changeId > slot->changeId) {
+        // A snapshot restarts the book, so it never waits on a gap
+        uint64_t prevChangeId = 0;
+        bool chains = slot->changeId == 0 || !uintField(payload, PREV_CHANGE_ID_KEY, prevChangeId) ||
+                      prevChangeId == slot->changeId || payload.find(SNAPSHOT_FIELD) != std::string_view::npos;
+        if (!chains) {
+            if (lineCount > 1 && hold(*slot, line, payload, changeId, prevChangeId, receivedNs)) return;
+            releaseHeld(*slot);
+        } else if (slot->heldCount > 0 && slot->held[0].line != &line) {
+            ++line.counters.filled;
+        }
+    }
+    if (changeId > slot->changeId) {
+        deliver(*slot, line, payload, changeId, receivedNs);
+        deliverChained(*slot, receivedNs);
+        return;
+    }
+    if (changeId < slot->changeId) {
+        ++line.counters.stale;
+        return;
+    }
+    // A snapshot restarts the book, so an equal one is let through: after a
+    // resubscribe it is what the handler waits for
+    if (payload.find(SNAPSHOT_FIELD) != std::string_view::npos) {
+        if (messageHandler) messageHandler(payload, receivedNs);
+        return;
+    }
+    ++line.counters.duplicates;
+    if (!slot->counted && slot->winner != &line) {
+        // Lead of the winner over the first line to catch up
+        slot->counted = true;
+        long long lead = receivedNs - slot->firstNs;
+        LineStats& winner = slot->winner->counters;
+        ++winner.leadSamples;
+        winner.leadNsTotal += lead;
+        if (lead > winner.maxLeadNs) winner.maxLeadNs = lead;
+    }
+}
+
+void ArbitratedSocket::deliver(Slot& slot, Line& line, std::string_view payload, uint64_t changeId,
+                               long long receivedNs) {
+    slot.changeId = changeId;
+    slot.firstNs = receivedNs;
+    slot.winner = &line;
+    slot.counted = false;
+    ++line.counters.wins;
+    if (messageHandler) messageHandler(payload, receivedNs);
+}
+
+bool ArbitratedSocket::hold(Slot& slot, Line& line, std::string_view payload, uint64_t changeId,
+                            uint64_t prevChangeId, long long receivedNs) {
+    size_t pos = 0;
+    for (size_t i = 0; i < slot.heldCount; ++i) {
+        const Held& h = slot.held[i];
+        // Another line got here without the missing updates: nobody has them
+        if (h.line != &line && h.changeId <= changeId) return false;
+        if (h.changeId < changeId) pos = i + 1;
+    }
+    if (slot.heldCount == MAX_HELD) return false;
+    if (slot.heldCount == 0) slot.heldSinceNs = receivedNs;
+    // Move a spare entry (and its buffer) into place
+    if (slot.held.size() == slot.heldCount) slot.held.emplace_back();
+    std::rotate(slot.held.begin() + pos, slot.held.begin() + slot.heldCount, slot.held.begin() + slot.heldCount + 1);
+    Held& h = slot.held[pos];
+    h.line = &line;
+    h.changeId = changeId;
+    h.prevChangeId = prevChangeId;
+    h.receivedNs = receivedNs;
+    h.payload.assign(payload);
+    ++slot.heldCount;
+    ++line.counters.held;
+    return true;
+}
+
+void ArbitratedSocket::deliverChained(Slot& slot, long long nowNs) {
+    size_t done = 0;
+    for (; done < slot.heldCount; ++done) {
+        Held& h = slot.held[done];
+        if (h.changeId <= slot.changeId) {
+            ++h.line->counters.stale;
+            continue;
+        }
+        if (h.prevChangeId != slot.changeId) break;
+        deliver(slot, *h.line, h.payload, h.changeId, h.receivedNs);
+    }
+    if (done == 0) return;
+    // Keep the rest at the front, with the spent buffers behind them
+    std::rotate(slot.held.begin(), slot.held.begin() + done, slot.held.begin() + slot.heldCount);
+    slot.heldCount -= done;
+    // What is still held waits from now on: it has a new gap in front of it
+    if (slot.heldCount > 0) slot.heldSinceNs = nowNs;
+}
+
+void ArbitratedSocket::releaseHeld(Slot& slot) {
+    for (size_t i = 0; i < slot.heldCount; ++i) {
+        Held& h = slot.held[i];
+        if (h.changeId > slot.changeId) deliver(slot, *h.line, h.payload, h.changeId, h.receivedNs);
+        else ++h.line->counters.stale;
+    }
+    slot.heldCount = 0;
+}
+
+void ArbitratedSocket::onLineReconnect(Line& line) {
+    if (line.index == 0) {
+        std::lock_guard<std::mutex> lock(deliveryMutex);
+        if (reconnectHandler) reconnectHandler();
+        return;
+    }
+    // The owner only resubscribes the primary; restore this line's channels
+    std::lock_guard<std::mutex> lock(subscriptionMutex);
+    for (const std::string& channels : subscriptions) {
+        line.socket->send(R"({"jsonrpc":"2.0","id":0,"method":"public/subscribe","params":{)" + channels + "}}");
+    }
+}
+
+std::vector<ArbitratedSocket::LineStats> ArbitratedSocket::stats() const {
+    std::lock_guard<std::mutex> lock(deliveryMutex);
+    std::vector<LineStats> result;
+    for (const auto& line : lines) result.push_back(line->counters);
+    return result;
+}
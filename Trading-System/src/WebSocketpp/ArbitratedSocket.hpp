@@ -0,0 +1,129 @@
+#ifndef WEBSOCKETPP_ARBITRATEDSOCKET_HPP
+#define WEBSOCKETPP_ARBITRATEDSOCKET_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BSocket.hpp"
+#include "ConnectionManager.hpp"
+
+// Redundant market data: N connections (lines), each a ConnectionManager,
+// carry the same public subscriptions. Book notifications are arbitrated on
+// (channel, change_id): the first copy of each update to arrive on any line
+// is delivered, later copies are dropped before they reach the handler.
+// An update whose prev_change_id skips past the last one delivered is held
+// (up to MAX_HOLD_NS) so another line can fill the gap; it is released
+// without the fill once another line is past the gap too.
+// Line 0 is the primary: every request goes out on it and only its responses
+// and non-book notifications are delivered. public/subscribe requests are
+// sent on every line and replayed to a line that reconnects.
+//
+// Delivery is serialised, so the handler still sees one message at a time,
+// as from a single transport, although lines read on their own threads.
+class ArbitratedSocket : public BSocket {
+public:
+    // Book channels tracked for arbitration (fixed, nothing allocated on the hot path)
+    static constexpr size_t MAX_CHANNELS = 1024;
+    static_assert((MAX_CHANNELS & (MAX_CHANNELS - 1)) == 0, "probing masks with MAX_CHANNELS - 1");
+    // How long updates after a gap wait for another line to fill it, and how
+    // many are held per channel meanwhile
+    static constexpr long long MAX_HOLD_NS = 5'000'000;
+    static constexpr size_t MAX_HELD = 64;
+
+    struct LineStats {
+        uint64_t wins;       // updates this line delivered first
+        uint64_t duplicates; // copies dropped because another line was first
+        uint64_t stale;      // copies older than an update already delivered
+        uint64_t held;       // updates held back after a gap on this line
+        uint64_t filled;     // updates that filled a gap another line had
+        // How far ahead this line was when it won, measured when the losing
+        // copy arrived (updates the other lines never sent are not counted)
+        uint64_t leadSamples;
+        long long leadNsTotal;
+        long long maxLeadNs;
+    };
+
+    ArbitratedSocket(ConnectionManager::Factory factory, size_t lines);
+    ~ArbitratedSocket() override;
+
+    // Every line to the same endpoint, or one endpoint per line
+    bool connect(const std::string& url) override;
+    bool connect(const std::vector<std::string>& urls);
+    bool send(std::string_view message) override;
+    void close() override;
+
+    // The primary line reconnected; runs with delivery held, so no message
+    // from another line reaches the handler meanwhile
+    void setReconnectHandler(ConnectionHandler handler) { reconnectHandler = handler; }
+    std::vector<LineStats> stats() const;
+
+private:
+    struct Line {
+        ArbitratedSocket* owner = nullptr;
+        size_t index = 0;
+        std::unique_ptr<ConnectionManager> socket;
+        // Written only with deliveryMutex held
+        LineStats counters{};
+
+        void onMessage(std::string_view payload, long long receivedNs) { owner->onLineMessage(*this, payload, receivedNs); }
+        void onReconnect() { owner->onLineReconnect(*this); }
+    };
+
+    // Copy of an update that arrived after a gap
+    struct Held {
+        Line* line = nullptr;
+        uint64_t changeId = 0;
+        uint64_t prevChangeId = 0;
+        long long receivedNs = 0;
+        std::string payload; // reused, so holding stops allocating once warm
+    };
+
+    // Last delivered update of one book channel
+    struct Slot {
+        uint64_t channelHash = 0; // 0 = free
+        uint64_t changeId = 0;
+        long long firstNs = 0;
+        Line* winner = nullptr;
+        bool counted = false; // lead already recorded for changeId
+        // held[0, heldCount) in change_id order, waiting since heldSinceNs
+        std::vector<Held> held;
+        size_t heldCount = 0;
+        long long heldSinceNs = 0;
+    };
+
+    void onLineMessage(Line& line, std::string_view payload, long long receivedNs);
+    void onLineReconnect(Line& line);
+    // Hand an update to the handler as the channel's latest
+    void deliver(Slot& slot, Line& line, std::string_view payload, uint64_t changeId, long long receivedNs);
+    // Hold an update that skips a gap; false if it should be delivered now
+    // instead (another line is past the gap too, or the hold is full)
+    bool hold(Slot& slot, Line& line, std::string_view payload, uint64_t changeId, uint64_t prevChangeId,
+              long long receivedNs);
+    // Deliver the held updates that now chain on, dropping those overtaken;
+    // any left wait for their own gap from nowNs
+    void deliverChained(Slot& slot, long long nowNs);
+    // Deliver every held update newer than the last one delivered, gap or not
+    void releaseHeld(Slot& slot);
+    // Slot for a channel, claimed on first use; nullptr if the table is full
+    Slot* slotFor(uint64_t channelHash);
+
+    ConnectionManager::Factory factory;
+    size_t lineCount;
+    std::vector<std::unique_ptr<Line>> lines;
+    ConnectionHandler reconnectHandler;
+
+    // Serialises delivery and guards the table and the line counters
+    mutable std::mutex deliveryMutex;
+    std::vector<Slot> table;
+
+    // Channel lists of the public/subscribe requests sent so far, replayed
+    // to a secondary line after it reconnects
+    std::mutex subscriptionMutex;
+    std::vector<std::string> subscriptions;
+};
+
+#endif // WEBSOCKETPP_ARBITRATEDSOCKET_HPP
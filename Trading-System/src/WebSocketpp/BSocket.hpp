@@ -2,19 +2,76 @@
 #define WEBSOCKETPP_BSOCKET_HPP
 
 #include <string>
-#include <functional>
+#include <string_view>
+#include <chrono>
+#include "LowLatency.hpp"
+#include "TscClock.hpp"
+
+// Ingress callback shared by every transport: a plain function pointer and
+// its context, so delivery is one indirect call with nothing to allocate.
+// The payload view is only valid during the call; receivedNs is
+// BSocket::clockNs() taken when the bytes came off the socket.
+struct MessageHandler {
+    using Fn = void (*)(void* ctx, std::string_view payload, long long receivedNs);
+
+    Fn fn = nullptr;
+    void* ctx = nullptr;
+
+    explicit operator bool() const { return fn != nullptr; }
+    void operator()(std::string_view payload, long long receivedNs) const { fn(ctx, payload, receivedNs); }
+
+    // Bind a member function; the call is resolved at compile time
+    template<typename T, void (T::*Method)(std::string_view, long long)>
+    static MessageHandler bind(T* object) {
+        return {[](void* ctx, std::string_view payload, long long receivedNs) {
+                    (static_cast<T*>(ctx)->*Method)(payload, receivedNs);
+                },
+                object};
+    }
+};
+
+// Connection event callback (disconnect, reconnect), same shape as MessageHandler
+struct ConnectionHandler {
+    using Fn = void (*)(void* ctx);
+
+    Fn fn = nullptr;
+    void* ctx = nullptr;
+
+    explicit operator bool() const { return fn != nullptr; }
+    void operator()() const { fn(ctx); }
+
+    template<typename T, void (T::*Method)()>
+    static ConnectionHandler bind(T* object) {
+        return {[](void* ctx) { (static_cast<T*>(ctx)->*Method)(); }, object};
+    }
+};
 
 class BSocket {
 public:
     virtual ~BSocket() = default;
     virtual bool connect(const std::string& url) = 0;
-    virtual void send(const std::string& message) = 0;
+    // Queue a text frame; the message is copied before returning
+    virtual bool send(std::string_view message) = 0;
     virtual void close() = 0;
-    void setMessageHandler(std::function<void(const std::string&)> handler) {
-        messageHandler = std::move(handler);
-    }
+    // Set before connect(); called from the transport's reader thread
+    void setMessageHandler(MessageHandler handler) { messageHandler = handler; }
+    // Called once from the reader thread when an open connection drops
+    // (error, EOF or a close from the server), never for close()
+    void setDisconnectHandler(ConnectionHandler handler) { disconnectHandler = handler; }
+    // Reader spin/busy-poll mode, socket tuning and I/O thread pinning; set before connect()
+    void setLowLatency(const LowLatencyConfig& config) { lowLatency = config; }
+
+    // Receive timestamps, on the clock Api measures request latency with
+    static long long clockNs() { return TscClock::nowNs(); }
+
 protected:
-    std::function<void(const std::string&)> messageHandler;
+    void notifyDisconnect() {
+        if (disconnectHandler) disconnectHandler();
+    }
+
+    MessageHandler messageHandler;
+    ConnectionHandler disconnectHandler;
+    LowLatencyConfig lowLatency;
 };
 
-#endif // WEBSOCKETPP_BSOCKET_HPP
\ No newline at end of file
+#endif // WEBSOCKETPP_BSOCKET_HPP
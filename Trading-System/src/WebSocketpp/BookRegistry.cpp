@@ -0,0 +1,89 @@
+#include "BookRegistry.hpp"
+#include <iostream>
+
+BookRegistry::BookRegistry(size_t capacity, size_t ladderDepth) : count(0) {
+    // Capacity is bounded by the id space (INVALID_INSTRUMENT is reserved)
+    if (capacity >= INVALID_INSTRUMENT) capacity = INVALID_INSTRUMENT - 1;
+    books.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        books.emplace_back(DEFAULT_TICK_SIZE, ladderDepth);
+    }
+    // Keep the intern table at most half full
+    size_t tableSize = 1;
+    while (tableSize < capacity * 2) tableSize <<= 1;
+    slots.reset(new Slot[tableSize]);
+    slotMask = tableSize - 1;
+}
+
+uint64_t BookRegistry::hashName(std::string_view name) {
+    // FNV-1a; 0 marks an empty slot
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : name) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+InstrumentId BookRegistry::add(const std::string& instrument, double tickSize) {
+    std::lock_guard<std::mutex> lock(addMutex);
+    uint64_t h = hashName(instrument);
+    size_t idx = h & slotMask;
+    while (true) {
+        Slot& slot = slots[idx];
+        uint64_t existing = slot.hash.load(std::memory_order_relaxed);
+        if (existing == 0) break;
+        if (existing == h) {
+            // Lookups trust the hash, so a colliding name must not be registered
+            if (books[slot.id].instrument != instrument) {
+                std::cerr << "BookRegistry: hash collision between " << instrument
+                          << " and " << books[slot.id].instrument << std::endl;
+                return INVALID_INSTRUMENT;
+            }
+            return slot.id;
+        }
+        idx = (idx + 1) & slotMask;
+    }
+    size_t n = count.load(std::memory_order_relaxed);
+    if (n >= books.size()) {
+        std::cerr << "BookRegistry: capacity " << books.size() << " reached, cannot add "
+                  << instrument << std::endl;
+        return INVALID_INSTRUMENT;
+    }
+    InstrumentId id = static_cast<InstrumentId>(n);
+    OrderBook& book = books[id];
+    book.setTickSize(tickSize);
+    book.instrument = instrument;
+    book.id = id;
+    // Publish the book before readers can resolve its name
+    slots[idx].id = id;
+    slots[idx].hash.store(h, std::memory_order_release);
+    count.store(n + 1, std::memory_order_release);
+    return id;
+}
+
+InstrumentId BookRegistry::find(std::string_view instrument) const {
+    uint64_t h = hashName(instrument);
+    size_t idx = h & slotMask;
+    while (true) {
+        const Slot& slot = slots[idx];
+        uint64_t existing = slot.hash.load(std::memory_order_acquire);
+        if (existing == 0) return INVALID_INSTRUMENT;
+        if (existing == h) return slot.id;
+        idx = (idx + 1) & slotMask;
+    }
+}
+
+InstrumentId BookRegistry::findChannel(std::string_view channel) const {
+    return find(channelInstrument(channel));
+}
+
+std::string_view BookRegistry::channelInstrument(std::string_view channel) {
+    // Instrument names never contain '.', so the name is the first segment
+    // after the channel prefix
+    size_t start = channel.rfind("user.", 0) == 0 ? channel.find('.', 5) : channel.find('.');
+    if (start == std::string_view::npos) return {};
+    ++start;
+    size_t end = channel.find('.', start);
+    return channel.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+}
@@ -0,0 +1,65 @@
+#ifndef WEBSOCKETPP_BOOKREGISTRY_HPP
+#define WEBSOCKETPP_BOOKREGISTRY_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "OrderBook.hpp"
+
+// Instrument to trade/track and its minimum price increment
+struct InstrumentSpec {
+    std::string name;
+    double tickSize;
+};
+
+// Holds the order books of every tracked instrument. All books are allocated
+// up front, so registering an instrument mid-session only configures a free
+// slot. Instrument names are interned into a hash table once; message routing
+// hashes the name out of the channel and never compares strings.
+class BookRegistry {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+
+    explicit BookRegistry(size_t capacity = DEFAULT_CAPACITY,
+                          size_t ladderDepth = OrderBook::DEFAULT_LADDER_DEPTH);
+
+    // Register an instrument (or return its id if already registered).
+    // Returns INVALID_INSTRUMENT if the registry is full.
+    InstrumentId add(const std::string& instrument, double tickSize);
+
+    // Resolve an instrument name, INVALID_INSTRUMENT if unknown
+    InstrumentId find(std::string_view instrument) const;
+    // Resolve the instrument of a book.* channel, e.g. "book.BTC-PERPETUAL.raw"
+    InstrumentId findChannel(std::string_view channel) const;
+
+    OrderBook& book(InstrumentId id) { return books[id]; }
+    const OrderBook& book(InstrumentId id) const { return books[id]; }
+    const std::string& name(InstrumentId id) const { return books[id].instrument; }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    size_t capacity() const { return books.size(); }
+
+    // Instrument name embedded in a channel ("book.X.raw", "user.orders.X.raw" -> "X")
+    static std::string_view channelInstrument(std::string_view channel);
+
+private:
+    static uint64_t hashName(std::string_view name);
+
+    // Open-addressed intern table; a slot is published by storing its hash last
+    struct Slot {
+        std::atomic<uint64_t> hash{0};
+        InstrumentId id{INVALID_INSTRUMENT};
+    };
+
+    std::vector<OrderBook> books;
+    std::unique_ptr<Slot[]> slots;
+    size_t slotMask;
+    std::atomic<size_t> count;
+    std::mutex addMutex;
+};
+
+#endif // WEBSOCKETPP_BOOKREGISTRY_HPP
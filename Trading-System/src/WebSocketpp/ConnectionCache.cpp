@@ -0,0 +1,150 @@
+#include "ConnectionCache.hpp"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <unistd.h>
+
+// SSL ex_data slot holding the cache key (a heap std::string) of a connection
+static void freeSessionKey(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) {
+    delete static_cast<std::string*>(ptr);
+}
+
+static int sessionKeyIndex() {
+    static int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeSessionKey);
+    return index;
+}
+
+ConnectionCache& ConnectionCache::instance() {
+    static ConnectionCache cache;
+    return cache;
+}
+
+ConnectionCache::~ConnectionCache() {
+    clear();
+}
+
+std::vector<ConnectionCache::Address> ConnectionCache::resolve(const std::string& host, const std::string& port) {
+    std::string key = host + ":" + port;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (dnsEnabled) {
+            auto it = addresses.find(key);
+            if (it != addresses.end()) {
+                ++counters.dnsHits;
+                return it->second;
+            }
+        }
+        ++counters.resolves;
+    }
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        std::cerr << "Failed to resolve " << key << ": " << gai_strerror(rc) << std::endl;
+        return {};
+    }
+    std::vector<Address> resolved;
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        Address address{};
+        std::memcpy(&address.addr, ai->ai_addr, ai->ai_addrlen);
+        address.length = ai->ai_addrlen;
+        resolved.push_back(address);
+    }
+    freeaddrinfo(result);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dnsEnabled) addresses[key] = resolved;
+    return resolved;
+}
+
+int ConnectionCache::connect(const std::string& host, const std::string& port, int* family) {
+    int lastError = 0;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        for (const Address& address : resolve(host, port)) {
+            int fd = ::socket(address.addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                lastError = errno;
+                continue;
+            }
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&address.addr), address.length) == 0) {
+                if (family) *family = address.addr.ss_family;
+                return fd;
+            }
+            lastError = errno;
+            ::close(fd);
+        }
+        // The cached addresses may be stale: look the name up again
+        forget(host + ":" + port);
+    }
+    std::cerr << "Failed to connect to " << host << ":" << port << ": " << std::strerror(lastError) << std::endl;
+    return -1;
+}
+
+void ConnectionCache::forget(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    addresses.erase(key);
+}
+
+void ConnectionCache::enableResumption(SSL_CTX* ctx) {
+    // Sessions are kept here, not in the context's internal cache
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, &ConnectionCache::onNewSession);
+}
+
+void ConnectionCache::prepareSession(SSL* ssl, const std::string& key) {
+    SSL_set_ex_data(ssl, sessionKeyIndex(), new std::string(key));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!tlsEnabled) return;
+    auto it = sessions.find(key);
+    if (it == sessions.end()) return;
+    // Offer a copy: OpenSSL marks the session a connection used as not
+    // resumable when that connection is freed without a clean shutdown
+    SSL_SESSION* copy = SSL_SESSION_dup(it->second);
+    if (!copy) return;
+    SSL_set_session(ssl, copy);
+    SSL_SESSION_free(copy); // ssl holds its own reference
+}
+
+void ConnectionCache::recordHandshake(SSL* ssl) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++counters.handshakes;
+    if (SSL_session_reused(ssl)) ++counters.resumed;
+}
+
+int ConnectionCache::onNewSession(SSL* ssl, SSL_SESSION* session) {
+    // TLS 1.3 tickets arrive after the handshake, on the connection's reader thread
+    auto* key = static_cast<std::string*>(SSL_get_ex_data(ssl, sessionKeyIndex()));
+    if (!key) return 0;
+    // Keep a copy: the connection's own session is marked not resumable if
+    // the connection is freed after an unclean close, as a dropped one is
+    SSL_SESSION* copy = SSL_SESSION_dup(session);
+    if (copy) instance().storeSession(*key, copy);
+    return 0; // the connection keeps its reference
+}
+
+void ConnectionCache::storeSession(const std::string& key, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lock(mutex);
+    SSL_SESSION*& slot = sessions[key];
+    if (slot) SSL_SESSION_free(slot);
+    slot = session;
+}
+
+void ConnectionCache::setEnabled(bool dnsCache, bool tlsResumption) {
+    std::lock_guard<std::mutex> lock(mutex);
+    dnsEnabled = dnsCache;
+    tlsEnabled = tlsResumption;
+}
+
+void ConnectionCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    addresses.clear();
+    for (auto& entry : sessions) SSL_SESSION_free(entry.second);
+    sessions.clear();
+}
+
+ConnectionCache::Stats ConnectionCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
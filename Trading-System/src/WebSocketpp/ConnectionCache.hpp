@@ -0,0 +1,72 @@
+#ifndef WEBSOCKETPP_CONNECTIONCACHE_HPP
+#define WEBSOCKETPP_CONNECTIONCACHE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <sys/socket.h>
+#include <openssl/ssl.h>
+
+// Process-wide state that makes a reconnect cheaper than the first connect:
+// resolved addresses per host:port, so a reconnect skips DNS, and the last
+// TLS session ticket per host:port, so the handshake resumes instead of
+// running the full key exchange. Shared by every transport.
+class ConnectionCache {
+public:
+    struct Address {
+        sockaddr_storage addr;
+        socklen_t length;
+    };
+
+    struct Stats {
+        uint64_t resolves;   // lookups that went to the resolver
+        uint64_t dnsHits;    // lookups served from the cache
+        uint64_t handshakes; // TLS handshakes completed
+        uint64_t resumed;    // of which resumed a cached session
+    };
+
+    static ConnectionCache& instance();
+
+    // Addresses for host:port, resolving (blocking) on a miss. Empty if the
+    // name does not resolve; the failure is logged.
+    std::vector<Address> resolve(const std::string& host, const std::string& port);
+    // Blocking TCP connect to host:port through the cache. If no cached
+    // address accepts, the entry is dropped and resolved again once.
+    // Returns the connected fd (its family in *family) or -1, logged.
+    int connect(const std::string& host, const std::string& port, int* family = nullptr);
+
+    // Client contexts must be set up once for resumption: OpenSSL only hands
+    // out the session tickets a server sends when client caching is on
+    static void enableResumption(SSL_CTX* ctx);
+    // Before the handshake: offer the cached session for key (host:port) and
+    // keep the tickets this connection receives under the same key
+    void prepareSession(SSL* ssl, const std::string& key);
+    // After the handshake: count it, and whether the session was resumed
+    void recordHandshake(SSL* ssl);
+
+    // Cold-vs-warm comparisons turn either half off; clear() drops everything
+    void setEnabled(bool dnsCache, bool tlsResumption);
+    void clear();
+    Stats stats();
+
+private:
+    ConnectionCache() = default;
+    ~ConnectionCache();
+    ConnectionCache(const ConnectionCache&) = delete;
+    ConnectionCache& operator=(const ConnectionCache&) = delete;
+
+    static int onNewSession(SSL* ssl, SSL_SESSION* session);
+    void storeSession(const std::string& key, SSL_SESSION* session);
+    void forget(const std::string& key);
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<Address>> addresses;
+    std::unordered_map<std::string, SSL_SESSION*> sessions;
+    bool dnsEnabled = true;
+    bool tlsEnabled = true;
+    Stats counters{};
+};
+
+#endif // WEBSOCKETPP_CONNECTIONCACHE_HPP
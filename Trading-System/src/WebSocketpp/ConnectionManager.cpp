@@ -0,0 +1,120 @@
+#include "ConnectionManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+ConnectionManager::ConnectionManager(Factory factory) : factory(std::move(factory)) {}
+
+ConnectionManager::~ConnectionManager() {
+    close();
+}
+
+std::unique_ptr<BSocket> ConnectionManager::build() {
+    std::unique_ptr<BSocket> socket(factory());
+    if (!socket) return nullptr;
+    // Messages go straight from the transport to the owner's handler
+    socket->setMessageHandler(messageHandler);
+    socket->setLowLatency(lowLatency);
+    socket->setDisconnectHandler(ConnectionHandler::bind<ConnectionManager, &ConnectionManager::onDisconnect>(this));
+    return socket;
+}
+
+bool ConnectionManager::connect(const std::string& url) {
+    this->url = url;
+    active = build();
+    if (!active || !active->connect(url)) {
+        active.reset();
+        return false;
+    }
+    current.store(active.get(), std::memory_order_release);
+    spare = build();
+    reconnectThread = std::thread(&ConnectionManager::reconnectLoop, this);
+    return true;
+}
+
+bool ConnectionManager::send(std::string_view message) {
+    // Announced before the load, so a retiring thread that swapped current
+    // out either sees this sender or this sender sees the new pointer
+    senders.fetch_add(1, std::memory_order_seq_cst);
+    BSocket* socket = current.load(std::memory_order_seq_cst);
+    bool sent = socket && socket->send(message);
+    senders.fetch_sub(1, std::memory_order_release);
+    return sent;
+}
+
+void ConnectionManager::waitForSenders() {
+    // Senders leave quickly: the transport is closed and new ones find no
+    // connection
+    while (senders.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+}
+
+void ConnectionManager::onDisconnect() {
+    disconnectCount.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        dropped = true;
+        droppedNs = clockNs();
+    }
+    wake.notify_one();
+}
+
+void ConnectionManager::reconnectLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return dropped || stopping; });
+        if (stopping) return;
+        dropped = false;
+        long long dropNs = droppedNs;
+        lock.unlock();
+
+        std::cerr << "Connection to " << url << " lost, reconnecting" << std::endl;
+        // Sends fail fast until the replacement is up
+        current.store(nullptr, std::memory_order_seq_cst);
+        active->close();
+        waitForSenders();
+        active.reset();
+        long long backoffMs = 0;
+        for (;;) {
+            std::unique_ptr<BSocket> next = spare ? std::move(spare) : build();
+            if (next && next->connect(url)) {
+                active = std::move(next);
+                break;
+            }
+            failedCount.fetch_add(1, std::memory_order_relaxed);
+            backoffMs = backoffMs == 0 ? INITIAL_BACKOFF_MS : std::min(backoffMs * 2, MAX_BACKOFF_MS);
+            lock.lock();
+            if (wake.wait_for(lock, std::chrono::milliseconds(backoffMs), [this] { return stopping; })) return;
+            lock.unlock();
+        }
+        current.store(active.get(), std::memory_order_release);
+        if (reconnectHandler) reconnectHandler();
+        lastReconnectNs.store(clockNs() - dropNs, std::memory_order_relaxed);
+        reconnectCount.fetch_add(1, std::memory_order_relaxed);
+        // Construct the next replacement now, off the critical path
+        spare = build();
+        lock.lock();
+    }
+}
+
+void ConnectionManager::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (reconnectThread.joinable()) reconnectThread.join();
+    current.store(nullptr, std::memory_order_seq_cst);
+    if (active) active->close();
+    waitForSenders();
+    active.reset();
+    spare.reset();
+}
+
+ConnectionManager::Stats ConnectionManager::stats() const {
+    Stats stats;
+    stats.disconnects = disconnectCount.load(std::memory_order_relaxed);
+    stats.reconnects = reconnectCount.load(std::memory_order_relaxed);
+    stats.failedAttempts = failedCount.load(std::memory_order_relaxed);
+    stats.lastReconnectNs = lastReconnectNs.load(std::memory_order_relaxed);
+    return stats;
+}
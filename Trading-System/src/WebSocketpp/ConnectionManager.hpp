@@ -0,0 +1,85 @@
+#ifndef WEBSOCKETPP_CONNECTIONMANAGER_HPP
+#define WEBSOCKETPP_CONNECTIONMANAGER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "BSocket.hpp"
+
+// Keeps one connection up behind the BSocket interface. Transports are built
+// by the factory; when one drops, a background thread builds the next (kept
+// ready ahead of time), connects it to the same URL and then runs the
+// reconnect handler, where the owner resubscribes. DNS and the TLS session
+// come from ConnectionCache, so a reconnect skips the lookup and resumes the
+// handshake. Messages sent while no connection is up fail like on a closed
+// socket.
+class ConnectionManager : public BSocket {
+public:
+    using Factory = std::function<BSocket*()>;
+
+    // Delay before each retry after a failed reconnect, doubling up to the max
+    static constexpr long long INITIAL_BACKOFF_MS = 10;
+    static constexpr long long MAX_BACKOFF_MS = 2000;
+
+    struct Stats {
+        uint64_t disconnects;
+        uint64_t reconnects;
+        uint64_t failedAttempts;
+        // Last reconnect: drop notification to the reconnect handler's return
+        long long lastReconnectNs;
+    };
+
+    explicit ConnectionManager(Factory factory);
+    ~ConnectionManager() override;
+
+    bool connect(const std::string& url) override;
+    bool send(std::string_view message) override;
+    void close() override;
+
+    // Called from the reconnect thread once a replacement connection is up,
+    // before any subscription on it could have delivered data
+    void setReconnectHandler(ConnectionHandler handler) { reconnectHandler = handler; }
+    Stats stats() const;
+
+private:
+    // From the dropped transport's reader thread
+    void onDisconnect();
+    void reconnectLoop();
+    // Wait out the senders that may have loaded the previous transport
+    void waitForSenders();
+    // A transport from the factory, wired to this manager's handlers
+    std::unique_ptr<BSocket> build();
+
+    Factory factory;
+    std::string url;
+    ConnectionHandler reconnectHandler;
+
+    // Transport in use; send() reads it without locking
+    std::atomic<BSocket*> current{nullptr};
+    // Threads inside send(). A replaced transport is freed once this has been
+    // seen at zero after current stopped pointing to it: no sender can still
+    // hold it then
+    std::atomic<int> senders{0};
+    std::unique_ptr<BSocket> active;
+    // Built ahead, so a reconnect starts with a constructed transport
+    std::unique_ptr<BSocket> spare;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool dropped = false;  // guarded by mutex
+    bool stopping = false; // guarded by mutex
+    long long droppedNs = 0; // guarded by mutex
+    std::thread reconnectThread;
+
+    std::atomic<uint64_t> disconnectCount{0};
+    std::atomic<uint64_t> reconnectCount{0};
+    std::atomic<uint64_t> failedCount{0};
+    std::atomic<long long> lastReconnectNs{0};
+};
+
+#endif // WEBSOCKETPP_CONNECTIONMANAGER_HPP
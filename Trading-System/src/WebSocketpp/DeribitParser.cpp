@@ -0,0 +1,304 @@
+#include "DeribitParser.hpp"
+#include "NumberDecoder.hpp"
+#include <charconv>
+
+DeribitMessage::DeribitMessage() {
+    bids.reserve(RESERVED_LEVELS);
+    asks.reserve(RESERVED_LEVELS);
+    trades.reserve(RESERVED_TRADES);
+}
+
+void DeribitMessage::reset() {
+    kind = Kind::Unknown;
+    hasId = false;
+    id = 0;
+    channel = {};
+    type = {};
+    instrumentName = {};
+    hasTimestamp = false;
+    timestamp = 0;
+    hasChangeId = false;
+    changeId = 0;
+    hasPrevChangeId = false;
+    prevChangeId = 0;
+    bids.clear();
+    asks.clear();
+    trades.clear();
+    orderId = {};
+    orderState = {};
+    label = {};
+    hasFilledAmount = false;
+    filledAmount = 0.0;
+    accessToken = {};
+    errorCode = 0;
+    errorMessage = {};
+    error = {};
+    body = {};
+}
+
+bool DeribitParser::parse(std::string_view message, DeribitMessage& out) {
+    out.reset();
+    cur = message.data();
+    end = cur + message.size();
+    bool ok = parseObject([&](std::string_view key) {
+        if (key == "id") {
+            if (parseNull()) return true;
+            out.hasId = parseInt(out.id);
+            return out.hasId;
+        }
+        if (key == "method") {
+            std::string_view method;
+            if (!parseString(method)) return false;
+            if (method == "subscription") out.kind = DeribitMessage::Kind::Subscription;
+            return true;
+        }
+        if (key == "params") return parseParams(out);
+        if (key == "result") return parseBody(out);
+        if (key == "error") return parseError(out);
+        return skipValue();
+    });
+    if (!ok) return false;
+    if (out.kind == DeribitMessage::Kind::Unknown && out.hasId) {
+        out.kind = out.error.empty() ? DeribitMessage::Kind::Response : DeribitMessage::Kind::Error;
+    }
+    return true;
+}
+
+template<typename OnKey>
+bool DeribitParser::parseObject(OnKey&& onKey) {
+    if (!consume('{')) return false;
+    if (consume('}')) return true;
+    do {
+        std::string_view key;
+        if (!parseString(key) || !consume(':')) return false;
+        if (!onKey(key)) return false;
+    } while (consume(','));
+    return consume('}');
+}
+
+bool DeribitParser::parseParams(DeribitMessage& out) {
+    return parseObject([&](std::string_view key) {
+        if (key == "channel") return parseString(out.channel);
+        if (key == "data") return parseBody(out);
+        return skipValue();
+    });
+}
+
+bool DeribitParser::parseBody(DeribitMessage& out) {
+    skipWs();
+    const char* start = cur;
+    // Objects are decoded field by field; arrays are decoded as trades, and
+    // other array shapes (positions) are left to the caller via body
+    bool ok = peek('{') ? parseFields(out) : peek('[') ? parseTrades(out.trades) : skipValue();
+    out.body = std::string_view(start, static_cast<size_t>(cur - start));
+    return ok;
+}
+
+bool DeribitParser::parseFields(DeribitMessage& out) {
+    return parseObject([&](std::string_view key) {
+        switch (key.size()) {
+        case 4:
+            if (key == "type") return parseString(out.type);
+            if (key == "bids") return parseLevels(out.bids);
+            if (key == "asks") return parseLevels(out.asks);
+            break;
+        case 5:
+            if (key == "order") return peek('{') ? parseFields(out) : skipValue();
+            if (key == "label") return parseString(out.label);
+            break;
+        case 6:
+            if (key == "trades") return parseTrades(out.trades);
+            break;
+        case 8:
+            if (key == "order_id") return parseString(out.orderId);
+            break;
+        case 9:
+            if (key == "timestamp") return out.hasTimestamp = parseInt(out.timestamp);
+            if (key == "change_id") return out.hasChangeId = parseUInt(out.changeId);
+            break;
+        case 11:
+            if (key == "order_state") return parseString(out.orderState);
+            break;
+        case 12:
+            if (key == "access_token") return parseString(out.accessToken);
+            break;
+        case 13:
+            if (key == "filled_amount") return out.hasFilledAmount = parseDouble(out.filledAmount);
+            break;
+        case 14:
+            if (key == "prev_change_id") return out.hasPrevChangeId = parseUInt(out.prevChangeId);
+            break;
+        case 15:
+            if (key == "instrument_name") return parseString(out.instrumentName);
+            break;
+        default:
+            break;
+        }
+        return skipValue();
+    });
+}
+
+bool DeribitParser::parseError(DeribitMessage& out) {
+    skipWs();
+    const char* start = cur;
+    if (parseNull()) return true;
+    bool ok = parseObject([&](std::string_view key) {
+        if (key == "code") return parseInt(out.errorCode);
+        if (key == "message") return parseString(out.errorMessage);
+        return skipValue();
+    });
+    out.error = std::string_view(start, static_cast<size_t>(cur - start));
+    return ok;
+}
+
+bool DeribitParser::parseLevels(std::vector<BookLevel>& levels) {
+    if (!consume('[')) return false;
+    if (consume(']')) return true;
+    do {
+        if (!consume('[')) return false;
+        BookLevel level{OrderBook::Action::New, 0.0, 0.0};
+        bool known = true;
+        // Delta entries lead with the action: ["new"|"change"|"delete", price, amount]
+        if (peek('"')) {
+            std::string_view action;
+            if (!parseString(action) || !consume(',')) return false;
+            known = OrderBook::parseAction(action, level.action);
+        }
+        if (!parseDouble(level.price) || !consume(',') || !parseDouble(level.amount) || !consume(']')) {
+            return false;
+        }
+        if (known) levels.push_back(level);
+    } while (consume(','));
+    return consume(']');
+}
+
+bool DeribitParser::parseTrades(std::vector<Trade>& trades) {
+    if (!consume('[')) return false;
+    if (consume(']')) return true;
+    do {
+        if (!peek('{')) {
+            if (!skipValue()) return false;
+            continue;
+        }
+        Trade trade;
+        bool ok = parseObject([&](std::string_view key) {
+            switch (key.size()) {
+            case 5:
+                if (key == "price") return parseDouble(trade.price);
+                break;
+            case 6:
+                if (key == "amount") return parseDouble(trade.amount);
+                break;
+            case 8:
+                if (key == "trade_id") return parseString(trade.tradeId);
+                break;
+            case 9:
+                if (key == "timestamp") return parseInt(trade.timestamp);
+                if (key == "trade_seq") return parseUInt(trade.tradeSeq);
+                if (key == "direction") {
+                    std::string_view direction;
+                    if (!parseString(direction)) return false;
+                    trade.direction = direction == "sell" ? Trade::Direction::Sell : Trade::Direction::Buy;
+                    return true;
+                }
+                break;
+            case 15:
+                if (key == "instrument_name") return parseString(trade.instrumentName);
+                break;
+            default:
+                break;
+            }
+            return skipValue();
+        });
+        if (!ok) return false;
+        // Objects without a trade id (e.g. positions) are not trades
+        if (!trade.tradeId.empty()) trades.push_back(trade);
+    } while (consume(','));
+    return consume(']');
+}
+
+bool DeribitParser::parseString(std::string_view& out) {
+    if (!consume('"')) return false;
+    const char* start = cur;
+    while (cur < end) {
+        if (*cur == '"') {
+            out = std::string_view(start, static_cast<size_t>(cur - start));
+            ++cur;
+            return true;
+        }
+        if (*cur == '\\') {
+            if (end - cur < 2) return false;
+            cur += 2;
+        } else {
+            ++cur;
+        }
+    }
+    return false;
+}
+
+bool DeribitParser::parseDouble(double& out) {
+    skipWs();
+    const char* next = NumberDecoder::decode(cur, end, out);
+    if (!next) return false;
+    cur = next;
+    return true;
+}
+
+bool DeribitParser::parseInt(int64_t& out) {
+    skipWs();
+    auto result = std::from_chars(cur, end, out);
+    if (result.ec != std::errc()) return false;
+    cur = result.ptr;
+    return true;
+}
+
+bool DeribitParser::parseUInt(uint64_t& out) {
+    skipWs();
+    auto result = std::from_chars(cur, end, out);
+    if (result.ec != std::errc()) return false;
+    cur = result.ptr;
+    return true;
+}
+
+bool DeribitParser::parseNull() {
+    skipWs();
+    if (end - cur >= 4 && std::string_view(cur, 4) == "null") {
+        cur += 4;
+        return true;
+    }
+    return false;
+}
+
+bool DeribitParser::skipValue() {
+    skipWs();
+    if (cur >= end) return false;
+    if (*cur == '"') {
+        std::string_view ignored;
+        return parseString(ignored);
+    }
+    if (*cur == '{' || *cur == '[') {
+        int depth = 0;
+        while (cur < end) {
+            char c = *cur;
+            if (c == '"') {
+                std::string_view ignored;
+                if (!parseString(ignored)) return false;
+                continue;
+            }
+            ++cur;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return true;
+            }
+        }
+        return false;
+    }
+    // Number, true, false or null
+    const char* start = cur;
+    while (cur < end && *cur != ',' && *cur != '}' && *cur != ']' &&
+           *cur != ' ' && *cur != '\n' && *cur != '\r' && *cur != '\t') {
+        ++cur;
+    }
+    return cur != start;
+}
@@ -0,0 +1,126 @@
+#ifndef WEBSOCKETPP_DERIBITPARSER_HPP
+#define WEBSOCKETPP_DERIBITPARSER_HPP
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "OrderBook.hpp"
+
+// One bids/asks entry. Snapshot entries ([price, amount]) are reported as New.
+struct BookLevel {
+    OrderBook::Action action;
+    double price;
+    double amount;
+};
+
+// One trade from a trades.X / user.trades.X notification or an order response
+struct Trade {
+    enum class Direction { Buy, Sell };
+    std::string_view tradeId;
+    std::string_view instrumentName;
+    double price = 0.0;
+    double amount = 0.0;
+    Direction direction = Direction::Buy;
+    int64_t timestamp = 0;
+    uint64_t tradeSeq = 0;
+};
+
+// Fields extracted from one Deribit JSON-RPC message. String fields are views
+// into the message and are only valid while it is alive; escape sequences are
+// left as-is. The level vectors keep their capacity between messages, so a
+// reused DeribitMessage does not allocate once warmed up.
+struct DeribitMessage {
+    enum class Kind { Unknown, Subscription, Response, Error };
+
+    // Levels reserved per side up front (grown only by larger snapshots)
+    static constexpr size_t RESERVED_LEVELS = 2048;
+    // Trades reserved up front (one notification rarely carries more)
+    static constexpr size_t RESERVED_TRADES = 256;
+
+    DeribitMessage();
+    void reset();
+
+    Kind kind = Kind::Unknown;
+    bool hasId = false;
+    int64_t id = 0;
+    std::string_view channel;
+
+    // Book notification (params.data) or get_order_book result
+    std::string_view type;
+    std::string_view instrumentName;
+    bool hasTimestamp = false;
+    int64_t timestamp = 0;
+    bool hasChangeId = false;
+    uint64_t changeId = 0;
+    bool hasPrevChangeId = false;
+    uint64_t prevChangeId = 0;
+    std::vector<BookLevel> bids;
+    std::vector<BookLevel> asks;
+
+    // Trades notification data, or result.trades of an order response
+    std::vector<Trade> trades;
+
+    // Order fields (result.order of an order response, or user.orders data)
+    std::string_view orderId;
+    std::string_view orderState;
+    std::string_view label;
+    bool hasFilledAmount = false;
+    double filledAmount = 0.0;
+
+    // Auth result
+    std::string_view accessToken;
+
+    // Error object
+    int64_t errorCode = 0;
+    std::string_view errorMessage;
+    std::string_view error;   // raw JSON of the error object
+
+    // Raw JSON of params.data / result, for shapes decoded elsewhere (e.g. positions)
+    std::string_view body;
+};
+
+// Single-pass parser for the JSON-RPC shapes Deribit sends: subscription
+// notifications, responses with an id, and errors. Known fields are decoded
+// straight into a DeribitMessage; everything else is skipped without being
+// materialised.
+class DeribitParser {
+public:
+    // Returns false if the message is not well-formed JSON of the expected shape
+    bool parse(std::string_view message, DeribitMessage& out);
+
+private:
+    template<typename OnKey>
+    bool parseObject(OnKey&& onKey);
+    bool parseParams(DeribitMessage& out);
+    bool parseBody(DeribitMessage& out);
+    bool parseFields(DeribitMessage& out);
+    bool parseError(DeribitMessage& out);
+    bool parseLevels(std::vector<BookLevel>& levels);
+    bool parseTrades(std::vector<Trade>& trades);
+
+    bool parseString(std::string_view& out);
+    bool parseDouble(double& out);
+    bool parseInt(int64_t& out);
+    bool parseUInt(uint64_t& out);
+    bool parseNull();
+    bool skipValue();
+
+    void skipWs() {
+        while (cur < end && (*cur == ' ' || *cur == '\n' || *cur == '\r' || *cur == '\t')) ++cur;
+    }
+    bool consume(char c) {
+        skipWs();
+        if (cur < end && *cur == c) { ++cur; return true; }
+        return false;
+    }
+    bool peek(char c) {
+        skipWs();
+        return cur < end && *cur == c;
+    }
+
+    const char* cur = nullptr;
+    const char* end = nullptr;
+};
+
+#endif // WEBSOCKETPP_DERIBITPARSER_HPP
@@ -0,0 +1,86 @@
+#ifndef WEBSOCKETPP_DISPATCH_HPP
+#define WEBSOCKETPP_DISPATCH_HPP
+
+#include <string_view>
+#include <cstdint>
+
+// Requests Api keeps track of until their response arrives
+enum class RequestKind : uint8_t {
+    None,
+    Auth,
+    Subscribe,
+    Order,
+    Cancel,
+    Edit,
+    GetOrderBook,
+    GetPositions
+};
+
+// Name used in log events
+constexpr const char* requestKindName(RequestKind kind) {
+    switch (kind) {
+    case RequestKind::Auth: return "auth";
+    case RequestKind::Subscribe: return "subscribe";
+    case RequestKind::Order: return "order";
+    case RequestKind::Cancel: return "cancel";
+    case RequestKind::Edit: return "edit";
+    case RequestKind::GetOrderBook: return "get_order_book";
+    case RequestKind::GetPositions: return "get_positions";
+    default: return "";
+    }
+}
+
+// Subscription channel families Api routes on
+enum class ChannelKind : uint8_t {
+    Unknown,
+    Book,
+    Trades,
+    Ticker,
+    UserOrders,
+    UserTrades
+};
+
+constexpr uint64_t fnv1a(std::string_view s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Family of a channel: its first segment, or the first two for user.* channels
+// ("book.BTC-PERPETUAL.raw" -> "book", "user.orders.BTC-PERPETUAL.raw" -> "user.orders")
+constexpr std::string_view channelFamily(std::string_view channel) {
+    size_t dot = channel.find('.');
+    if (dot == std::string_view::npos) return channel;
+    if (channel.substr(0, dot) == "user") {
+        dot = channel.find('.', dot + 1);
+        if (dot == std::string_view::npos) return channel;
+    }
+    return channel.substr(0, dot);
+}
+
+// Resolve a channel with one hash and one switch. The case labels are hashed
+// at compile time, so a collision between two families fails to build; the
+// final compare keeps unknown families that share a hash from being misrouted.
+constexpr ChannelKind channelKind(std::string_view channel) {
+    std::string_view family = channelFamily(channel);
+    ChannelKind kind = ChannelKind::Unknown;
+    std::string_view expected;
+    switch (fnv1a(family)) {
+    case fnv1a("book"): kind = ChannelKind::Book; expected = "book"; break;
+    case fnv1a("trades"): kind = ChannelKind::Trades; expected = "trades"; break;
+    case fnv1a("ticker"): kind = ChannelKind::Ticker; expected = "ticker"; break;
+    case fnv1a("user.orders"): kind = ChannelKind::UserOrders; expected = "user.orders"; break;
+    case fnv1a("user.trades"): kind = ChannelKind::UserTrades; expected = "user.trades"; break;
+    default: return ChannelKind::Unknown;
+    }
+    return family == expected ? kind : ChannelKind::Unknown;
+}
+
+static_assert(channelKind("book.BTC-PERPETUAL.raw") == ChannelKind::Book, "book channel");
+static_assert(channelKind("user.orders.BTC-PERPETUAL.raw") == ChannelKind::UserOrders, "user.orders channel");
+static_assert(channelKind("bookkeeping") == ChannelKind::Unknown, "families match whole segments");
+
+#endif // WEBSOCKETPP_DISPATCH_HPP
@@ -0,0 +1,305 @@
+#include "EventLog.hpp"
+#include "BSocket.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+EventRecord::EventRecord(EventType type)
+    : timestampNs(static_cast<uint64_t>(BSocket::clockNs())), type(type), flags(0), count(0),
+      ids{0, 0}, values{0, 0, 0, 0}, key{}, detail{} {}
+
+namespace {
+
+const char* eventName(EventType type) {
+    switch (type) {
+    case EventType::MarketUpdate: return "market_update";
+    case EventType::OrderUpdate: return "order_update";
+    case EventType::Error: return "error";
+    case EventType::AuthSuccess: return "auth_success";
+    case EventType::AuthFailed: return "auth_failed";
+    case EventType::OrderAck: return "order_ack";
+    case EventType::CancelAck: return "cancel_ack";
+    case EventType::EditAck: return "edit_ack";
+    case EventType::OrderBookSnapshot: return "order_book_snapshot";
+    case EventType::PositionsSnapshot: return "positions_snapshot";
+    case EventType::Position: return "position";
+    case EventType::SubscribeAck: return "subscribe_ack";
+    case EventType::BookGap: return "book_gap";
+    case EventType::BookResync: return "book_resync";
+    case EventType::Reconnected: return "reconnected";
+    case EventType::LatencySnapshot: return "latency_snapshot";
+    case EventType::Trace: return "trace";
+    case EventType::TraceStages: return "trace_stages";
+    }
+    return "unknown";
+}
+
+// Bounded copy of a text field (not necessarily terminated when full)
+template<size_t N>
+std::string text(const char (&field)[N]) {
+    return std::string(field, strnlen(field, N));
+}
+
+void addBestPrices(json& j, const EventRecord& r, int bidIndex) {
+    if (r.flags & EventRecord::HasBestBid) j["best_bid"] = r.values[bidIndex];
+    if (r.flags & EventRecord::HasBestAsk) j["best_ask"] = r.values[bidIndex + 1];
+}
+
+} // namespace
+
+size_t formatEvent(const EventRecord* records, size_t available, std::string& out) {
+    if (available == 0) return 0;
+    const EventRecord& r = records[0];
+    size_t consumed = 1;
+    json j = { {"event", eventName(r.type)} };
+    switch (r.type) {
+    case EventType::MarketUpdate:
+        // key: channel; values: propagation_ms, process_ms, best bid, best ask
+        j["channel"] = text(r.key);
+        j["propagation_ms"] = static_cast<long long>(r.values[0]);
+        j["process_ms"] = r.values[1];
+        addBestPrices(j, r, 2);
+        break;
+    case EventType::OrderUpdate:
+        // key: order id; detail: state; values: filled amount
+        j["order_id"] = text(r.key);
+        j["order_state"] = text(r.detail);
+        if (r.flags & EventRecord::HasFilled) j["filled_amount"] = r.values[0];
+        break;
+    case EventType::Error:
+        // detail: request kind; ids[0]: error code; key: error message
+        j["type"] = text(r.detail);
+        j["details"] = json{ {"code", static_cast<int64_t>(r.ids[0])}, {"message", text(r.key)} }.dump();
+        break;
+    case EventType::AuthFailed:
+        break;
+    case EventType::AuthSuccess:
+    case EventType::CancelAck:
+    case EventType::EditAck:
+    case EventType::SubscribeAck:
+        j["latency_ms"] = r.values[0];
+        break;
+    case EventType::OrderAck:
+        // key: order id; detail: state; values: latency, trading loop latency
+        j["order_id"] = text(r.key);
+        j["order_state"] = text(r.detail);
+        j["latency_ms"] = r.values[0];
+        if (r.flags & EventRecord::HasLoopLatency) j["trading_loop_latency_ms"] = r.values[1];
+        break;
+    case EventType::OrderBookSnapshot:
+        // key: instrument; values: latency, best bid, best ask
+        j["instrument"] = text(r.key);
+        j["latency_ms"] = r.values[0];
+        addBestPrices(j, r, 1);
+        break;
+    case EventType::PositionsSnapshot:
+        // values: latency; count Position records follow (key: instrument,
+        // values: size, average price)
+        if (available < 1 + static_cast<size_t>(r.count)) return 0;
+        j["latency_ms"] = r.values[0];
+        for (uint32_t i = 1; i <= r.count; ++i) {
+            const EventRecord& p = records[i];
+            j["positions"].push_back({ {"instrument", text(p.key)}, {"size", p.values[0]}, {"avg_price", p.values[1]} });
+        }
+        consumed += r.count;
+        break;
+    case EventType::Position:
+        // Outside a snapshot (the writer never splits one, but a damaged file might)
+        j["instrument"] = text(r.key);
+        j["size"] = r.values[0];
+        j["avg_price"] = r.values[1];
+        break;
+    case EventType::BookGap:
+        // key: instrument; ids: book change_id, message prev_change_id
+        j["instrument"] = text(r.key);
+        j["change_id"] = r.ids[0];
+        j["prev_change_id"] = r.ids[1];
+        break;
+    case EventType::BookResync:
+        j["instrument"] = text(r.key);
+        j["change_id"] = r.ids[0];
+        break;
+    case EventType::Reconnected:
+        // ids: public and private channel counts
+        j["public_channels"] = r.ids[0];
+        j["private_channels"] = r.ids[1];
+        break;
+    case EventType::LatencySnapshot:
+        // key: metric; count: interval in ms; ids: samples, max;
+        // values: p50, p90, p99, p99.9 (all latencies in ns)
+        j["metric"] = text(r.key);
+        j["interval_ms"] = r.count;
+        j["count"] = r.ids[0];
+        j["p50_ns"] = static_cast<uint64_t>(r.values[0]);
+        j["p90_ns"] = static_cast<uint64_t>(r.values[1]);
+        j["p99_ns"] = static_cast<uint64_t>(r.values[2]);
+        j["p999_ns"] = static_cast<uint64_t>(r.values[3]);
+        j["max_ns"] = r.ids[1];
+        break;
+    case EventType::Trace: {
+        // key: order id; detail: order state; ids: trace id, request id;
+        // values here and in the TraceStages record after it: stage durations
+        if (available < 1 + static_cast<size_t>(r.count) || r.count < 1) return 0;
+        const EventRecord& more = records[1];
+        j["trace_id"] = r.ids[0];
+        j["request_id"] = r.ids[1];
+        j["order_id"] = text(r.key);
+        j["order_state"] = text(r.detail);
+        const char* stages[] = {"socket_read_ns", "parse_ns", "book_apply_ns", "strategy_ns",
+                                "encode_ns", "send_ns", "exchange_round_trip_ns", "tick_to_ack_ns"};
+        for (int i = 0; i < 4; ++i) {
+            j[stages[i]] = static_cast<int64_t>(r.values[i]);
+            j[stages[i + 4]] = static_cast<int64_t>(more.values[i]);
+        }
+        consumed += r.count;
+        break;
+    }
+    case EventType::TraceStages:
+        // Outside a trace (damaged file)
+        break;
+    }
+    out += j.dump();
+    out += '\n';
+    return consumed;
+}
+
+EventLog& EventLog::instance() {
+    static EventLog log;
+    return log;
+}
+
+EventLog::~EventLog() {
+    stop();
+}
+
+bool EventLog::start(Format format, const std::string& path) {
+    if (running.load()) return true;
+    this->format = format;
+    if (path.empty()) {
+        if (format == Format::Binary) {
+            std::cerr << "EventLog: binary format needs a file" << std::endl;
+            return false;
+        }
+        file = stdout;
+    } else {
+        file = std::fopen(path.c_str(), format == Format::Binary ? "wb" : "w");
+        if (!file) {
+            std::cerr << "EventLog: cannot open " << path << std::endl;
+            return false;
+        }
+        if (format == Format::Binary) {
+            uint32_t recordSize = sizeof(EventRecord);
+            std::fwrite(MAGIC, sizeof(MAGIC), 1, file);
+            std::fwrite(&recordSize, sizeof(recordSize), 1, file);
+        }
+    }
+    running.store(true);
+    writer = std::thread(&EventLog::run, this);
+    return true;
+}
+
+void EventLog::stop() {
+    if (!running.exchange(false)) return;
+    if (writer.joinable()) writer.join();
+    if (file && file != stdout) std::fclose(file);
+    file = nullptr;
+}
+
+EventLog::Ring* EventLog::threadRing() {
+    thread_local RingLease lease;
+    if (lease.ring) return lease.ring;
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    // Take over the ring of a thread that has exited, if any
+    for (auto& ring : rings) {
+        bool expected = false;
+        if (ring->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            lease.ring = ring.get();
+            return lease.ring;
+        }
+    }
+    rings.push_back(std::make_unique<Ring>());
+    rings.back()->owned.store(true, std::memory_order_relaxed);
+    lease.ring = rings.back().get();
+    return lease.ring;
+}
+
+void EventLog::write(const EventRecord* records, size_t count) {
+    Ring* ring = threadRing();
+    size_t head = ring->head.load(std::memory_order_relaxed);
+    size_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail + count > RING_CAPACITY) {
+        droppedCount.fetch_add(count, std::memory_order_relaxed);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        ring->slots[(head + i) % RING_CAPACITY] = records[i];
+    }
+    ring->head.store(head + count, std::memory_order_release);
+}
+
+void EventLog::collect(std::vector<EventRecord>& batch) {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (auto& ring : rings) {
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        size_t head = ring->head.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; ++i) {
+            batch.push_back(ring->slots[i % RING_CAPACITY]);
+        }
+        ring->tail.store(head, std::memory_order_release);
+    }
+    // Interleave the threads by time; records logged together share a
+    // timestamp and a ring, so the stable sort keeps them adjacent
+    std::stable_sort(batch.begin(), batch.end(), [](const EventRecord& a, const EventRecord& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+}
+
+void EventLog::flush(const std::vector<EventRecord>& batch, std::string& text) {
+    if (format == Format::Binary) {
+        std::fwrite(batch.data(), sizeof(EventRecord), batch.size(), file);
+    } else {
+        text.clear();
+        for (size_t i = 0; i < batch.size();) {
+            size_t consumed = formatEvent(batch.data() + i, batch.size() - i, text);
+            i += consumed ? consumed : 1;
+        }
+        std::fwrite(text.data(), 1, text.size(), file);
+    }
+    std::fflush(file);
+}
+
+void EventLog::run() {
+    std::vector<EventRecord> batch;
+    std::string text;
+    for (;;) {
+        // Read the flag first: after stop() one more pass drains everything
+        bool stopping = !running.load();
+        batch.clear();
+        collect(batch);
+        if (!batch.empty()) {
+            flush(batch, text);
+        } else if (!stopping) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (stopping) break;
+    }
+}
+
+bool EventLog::readFile(const std::string& path, std::vector<EventRecord>& out) {
+    FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) return false;
+    char magic[sizeof(MAGIC)];
+    uint32_t recordSize = 0;
+    bool valid = std::fread(magic, sizeof(magic), 1, in) == 1 &&
+                 std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 std::fread(&recordSize, sizeof(recordSize), 1, in) == 1 &&
+                 recordSize == sizeof(EventRecord);
+    EventRecord record;
+    while (valid && std::fread(&record, sizeof(record), 1, in) == 1) {
+        out.push_back(record);
+    }
+    std::fclose(in);
+    return valid;
+}
@@ -0,0 +1,150 @@
+#ifndef WEBSOCKETPP_EVENTLOG_HPP
+#define WEBSOCKETPP_EVENTLOG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Event kinds of the JSON log schema. The values are part of the binary
+// file format: append new kinds, never renumber.
+enum class EventType : uint16_t {
+    MarketUpdate = 1,
+    OrderUpdate = 2,
+    Error = 3,
+    AuthSuccess = 4,
+    AuthFailed = 5,
+    OrderAck = 6,
+    CancelAck = 7,
+    EditAck = 8,
+    OrderBookSnapshot = 9,
+    PositionsSnapshot = 10, // followed by `count` Position records
+    Position = 11,
+    SubscribeAck = 12,
+    BookGap = 13,
+    BookResync = 14,
+    Reconnected = 15,
+    LatencySnapshot = 16,
+    Trace = 17, // followed by one TraceStages record
+    TraceStages = 18,
+};
+
+// One logged event, fixed-size and trivially copyable so the hot path only
+// fills in fields and copies 128 bytes. Which fields an event uses is
+// spelled out next to each writer in Api and in formatEvent(); strings
+// longer than their field are truncated.
+struct EventRecord {
+    enum Flags : uint16_t {
+        HasBestBid = 1,
+        HasBestAsk = 2,
+        HasFilled = 4,
+        HasLoopLatency = 8,
+    };
+
+    uint64_t timestampNs; // BSocket::clockNs() when logged
+    EventType type;
+    uint16_t flags;
+    uint32_t count;
+    uint64_t ids[2];
+    double values[4];
+    char key[40];   // channel, instrument or order id
+    char detail[24]; // order state, request kind
+
+    explicit EventRecord(EventType type);
+    EventRecord() = default;
+
+    template<size_t N>
+    static void setText(char (&field)[N], std::string_view text) {
+        size_t n = text.size() < N - 1 ? text.size() : N - 1;
+        std::memcpy(field, text.data(), n);
+        field[n] = '\0';
+    }
+};
+
+static_assert(sizeof(EventRecord) == 128, "EventRecord is written to disk as is");
+static_assert(std::is_trivially_copyable<EventRecord>::value, "EventRecord is copied with memcpy");
+
+// Append the JSON line of the event at records[0] to out (with '\n'), in
+// the schema Api used to print directly. Returns the records consumed: 1,
+// or 1 + count for a positions snapshot, 0 if those are not all in range.
+size_t formatEvent(const EventRecord* records, size_t available, std::string& out);
+
+// Asynchronous event log. Every producing thread gets its own lock-free
+// single-producer ring on first use; log() copies the record in and never
+// blocks or allocates (a full ring drops the event and counts it). A
+// background thread drains the rings and writes JSON lines or the raw
+// records to a binary file, which formatEvent() turns back into JSON
+// offline (see eventlog_dump).
+class EventLog {
+public:
+    enum class Format { Json, Binary };
+
+    // Records per thread ring
+    static constexpr size_t RING_CAPACITY = 4096;
+    // Binary file header
+    static constexpr char MAGIC[8] = {'T', 'S', 'E', 'V', 'L', 'O', 'G', '1'};
+
+    static EventLog& instance();
+
+    // Start the writer: JSON lines to path (stdout if empty) or records to a
+    // binary file. Returns false if the file cannot be opened. Events logged
+    // before start() wait in the rings.
+    bool start(Format format, const std::string& path = "");
+    // Drain everything logged so far and stop the writer
+    void stop();
+
+    // Log one event, or several that must stay together (e.g. a positions
+    // snapshot and its positions); all or none are logged
+    static void log(const EventRecord& record) { instance().write(&record, 1); }
+    void write(const EventRecord* records, size_t count);
+
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+    // Read a binary log written by this class; false if it is not one
+    static bool readFile(const std::string& path, std::vector<EventRecord>& out);
+
+private:
+    struct Ring {
+        std::atomic<size_t> head{0}; // next slot the producer writes
+        alignas(64) std::atomic<size_t> tail{0}; // next slot the writer reads
+        alignas(64) std::atomic<bool> owned{false};
+        std::unique_ptr<EventRecord[]> slots{new EventRecord[RING_CAPACITY]};
+    };
+    // Releases a thread's ring for reuse when the thread exits
+    struct RingLease {
+        Ring* ring = nullptr;
+        ~RingLease() {
+            if (ring) ring->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    EventLog() = default;
+    ~EventLog();
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    Ring* threadRing();
+    void run();
+    // Move every ring's pending records into batch, ordered by time
+    void collect(std::vector<EventRecord>& batch);
+    void flush(const std::vector<EventRecord>& batch, std::string& text);
+
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::atomic<uint64_t> droppedCount{0};
+
+    Format format = Format::Json;
+    FILE* file = nullptr;
+    std::atomic<bool> running{false};
+    std::thread writer;
+};
+
+#endif // WEBSOCKETPP_EVENTLOG_HPP
@@ -0,0 +1,29 @@
+#include "EventLog.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Convert a binary event log (EVENT_LOG=path) to the JSON lines the
+// trading system prints by default
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <event log>" << std::endl;
+        return 1;
+    }
+    std::vector<EventRecord> records;
+    if (!EventLog::readFile(argv[1], records)) {
+        std::cerr << argv[1] << ": not an event log" << std::endl;
+        return 1;
+    }
+    std::string out;
+    for (size_t i = 0; i < records.size();) {
+        size_t consumed = formatEvent(records.data() + i, records.size() - i, out);
+        i += consumed ? consumed : 1;
+        if (out.size() > (1 << 16)) {
+            std::cout << out;
+            out.clear();
+        }
+    }
+    std::cout << out;
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "FlightRecorder.hpp"
+#include "BSocket.hpp"
+#include "TscClock.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+const int CRASH_SIGNALS[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+// Signal entry point: copy the ring out, then let crashes take their course
+void flightRecorderSignal(int sig) {
+    int savedErrno = errno;
+    FlightRecorder& recorder = FlightRecorder::instance();
+    if (sig == SIGUSR2) {
+        // "<path>.<n>", formatted without stdio
+        char path[sizeof(recorder.dumpPrefix) + 12];
+        size_t len = strnlen(recorder.dumpPrefix, sizeof(recorder.dumpPrefix));
+        std::memcpy(path, recorder.dumpPrefix, len);
+        unsigned n = recorder.dumpCount.fetch_add(1) + 1;
+        char digits[12];
+        size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + n % 10);
+            n /= 10;
+        } while (n > 0);
+        while (count > 0) path[len++] = digits[--count];
+        path[len] = '\0';
+        recorder.dump(path);
+        errno = savedErrno;
+        return;
+    }
+    recorder.dump(recorder.crashPath);
+    // SA_RESETHAND restored the default action
+    ::raise(sig);
+}
+
+FlightRecorder& FlightRecorder::instance() {
+    static FlightRecorder recorder;
+    return recorder;
+}
+
+FlightRecorder::~FlightRecorder() {
+    stop();
+}
+
+bool FlightRecorder::start(const std::string& path, size_t capacityBytes) {
+    if (slots) return true;
+    if (path.size() + 16 > sizeof(crashPath)) {
+        std::cerr << "FlightRecorder: path too long: " << path << std::endl;
+        return false;
+    }
+    uint64_t slotCount = 1024;
+    while (slotCount * SLOT_SIZE < capacityBytes) slotCount <<= 1;
+    size_t size = HEADER_SIZE + slotCount * SLOT_SIZE;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "FlightRecorder: cannot create " << path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        return false;
+    }
+    // Populate up front so recording never takes a page fault
+    void* mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (mem == MAP_FAILED) {
+        std::cerr << "FlightRecorder: cannot map " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    mapping = mem;
+    mappingSize = size;
+    header = new (mem) FileHeader();
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->slotSize = SLOT_SIZE;
+    header->reserved = 0;
+    header->slotCount = slotCount;
+    header->nextSlot.store(0, std::memory_order_relaxed);
+    long long now = BSocket::clockNs();
+    header->wallOffsetNs = TscClock::toWallNs(now) - now;
+    header->pid = static_cast<int64_t>(::getpid());
+    slotMask = slotCount - 1;
+
+    std::snprintf(crashPath, sizeof(crashPath), "%s.crash", path.c_str());
+    std::snprintf(dumpPrefix, sizeof(dumpPrefix), "%s.", path.c_str());
+    slots = reinterpret_cast<Slot*>(static_cast<char*>(mem) + HEADER_SIZE);
+    installHandlers();
+    return true;
+}
+
+void FlightRecorder::installHandlers() {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = flightRecorderSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND | SA_NODEFER;
+    for (int sig : CRASH_SIGNALS) ::sigaction(sig, &action, nullptr);
+    action.sa_flags = SA_RESTART;
+    ::sigaction(SIGUSR2, &action, nullptr);
+}
+
+void FlightRecorder::stop() {
+    if (!slots) return;
+    // Writers must be done: recording threads are stopped before this
+    slots = nullptr;
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_DFL;
+    for (int sig : CRASH_SIGNALS) ::sigaction(sig, &action, nullptr);
+    ::sigaction(SIGUSR2, &action, nullptr);
+    ::munmap(mapping, mappingSize);
+    ::close(fd);
+    mapping = nullptr;
+    header = nullptr;
+    fd = -1;
+}
+
+void FlightRecorder::append(FlightRecordType type, const void* data, size_t size) {
+    long long now = BSocket::clockNs();
+    uint16_t flags = 0;
+    size_t maxSize = static_cast<size_t>(header->slotCount / 4) * SLOT_PAYLOAD;
+    if (size > maxSize) {
+        size = maxSize;
+        flags = 1;
+    }
+    uint32_t parts = size == 0 ? 1 : static_cast<uint32_t>((size + SLOT_PAYLOAD - 1) / SLOT_PAYLOAD);
+    uint64_t first = header->nextSlot.fetch_add(parts, std::memory_order_relaxed);
+    const char* bytes = static_cast<const char*>(data);
+    for (uint32_t part = 0; part < parts; ++part) {
+        Slot& slot = slots[(first + part) & slotMask];
+        // Unpublish first, so a reader never takes the new contents for the old slot
+        __atomic_store_n(&slot.sequence, 0, __ATOMIC_RELAXED);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.timestampNs = now;
+        slot.length = static_cast<uint32_t>(size);
+        slot.type = static_cast<uint16_t>(type);
+        slot.flags = flags;
+        slot.part = part;
+        slot.parts = parts;
+        size_t offset = static_cast<size_t>(part) * SLOT_PAYLOAD;
+        std::memcpy(slot.data, bytes + offset, std::min(SLOT_PAYLOAD, size - offset));
+        __atomic_store_n(&slot.sequence, first + part + 1, __ATOMIC_RELEASE);
+    }
+}
+
+bool FlightRecorder::dump(const char* path) const {
+    if (!mapping) return false;
+    int out = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (out < 0) return false;
+    bool ok = writeAll(out, static_cast<const char*>(mapping), mappingSize);
+    ::close(out);
+    return ok;
+}
+
+bool FlightRecorder::readFile(const std::string& path, std::vector<FlightEntry>& out) {
+    FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) return false;
+    std::vector<char> file;
+    char buffer[1 << 16];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), in)) > 0) file.insert(file.end(), buffer, buffer + n);
+    std::fclose(in);
+    if (file.size() < HEADER_SIZE) return false;
+    const FileHeader& header = *reinterpret_cast<const FileHeader*>(file.data());
+    uint64_t slotCount = header.slotCount;
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.slotSize != SLOT_SIZE || slotCount == 0 ||
+        (slotCount & (slotCount - 1)) != 0 || file.size() < HEADER_SIZE + slotCount * SLOT_SIZE) {
+        return false;
+    }
+    const Slot* ring = reinterpret_cast<const Slot*>(file.data() + HEADER_SIZE);
+    uint64_t end = header.nextSlot.load(std::memory_order_relaxed);
+    uint64_t begin = end > slotCount ? end - slotCount : 0;
+    auto complete = [&](uint64_t index) { return ring[index & (slotCount - 1)].sequence == index + 1; };
+    for (uint64_t i = begin; i < end;) {
+        const Slot& slot = ring[i & (slotCount - 1)];
+        // Skip the tail of an entry whose head was overwritten, and torn slots
+        if (!complete(i) || slot.part != 0) {
+            ++i;
+            continue;
+        }
+        bool whole = i + slot.parts <= end;
+        for (uint32_t part = 1; whole && part < slot.parts; ++part) {
+            const Slot& next = ring[(i + part) & (slotCount - 1)];
+            whole = complete(i + part) && next.part == part && next.timestampNs == slot.timestampNs;
+        }
+        if (!whole) {
+            ++i;
+            continue;
+        }
+        FlightEntry entry{i, slot.timestampNs, static_cast<FlightRecordType>(slot.type), (slot.flags & 1) != 0, {}};
+        entry.data.reserve(slot.length);
+        for (uint32_t part = 0; part < slot.parts; ++part) {
+            size_t offset = static_cast<size_t>(part) * SLOT_PAYLOAD;
+            entry.data.append(ring[(i + part) & (slotCount - 1)].data, std::min(SLOT_PAYLOAD, slot.length - offset));
+        }
+        out.push_back(std::move(entry));
+        i += slot.parts;
+    }
+    return true;
+}
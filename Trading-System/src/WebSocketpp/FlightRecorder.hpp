@@ -0,0 +1,134 @@
+#ifndef WEBSOCKETPP_FLIGHTRECORDER_HPP
+#define WEBSOCKETPP_FLIGHTRECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What a flight recorder entry holds. The values are part of the file
+// format: append new kinds, never renumber.
+enum class FlightRecordType : uint16_t {
+    Inbound = 1,         // raw frame given to Api::onMessage
+    Outbound = 2,        // request handed to the socket
+    BookApply = 3,       // FlightBookApply
+    OrderState = 4,      // "<order id> <state>" from Trader
+    InstrumentAdded = 5, // "<name> <tick size>"
+    Note = 6,            // free text (connection events, redactions)
+};
+
+// Payload of a BookApply entry
+struct FlightBookApply {
+    uint32_t instrument;
+    uint32_t flags; // 1: snapshot, 2: has bid, 4: has ask
+    uint64_t changeId;
+    double bestBid;
+    double bestAsk;
+};
+
+// One entry read back from a recording
+struct FlightEntry {
+    uint64_t sequence;  // first slot of the entry
+    long long timestampNs; // BSocket::clockNs() when recorded
+    FlightRecordType type;
+    bool truncated;
+    std::string data;
+};
+
+// Always-on flight recorder: the last entries of raw traffic and state
+// changes in a fixed-size ring of 256-byte slots in a shared file mapping.
+// An entry takes as many consecutive slots as it needs; writers claim
+// them with one fetch_add and publish each slot by storing its sequence
+// number last, so any thread can record without locks and a reader can
+// tell complete slots from torn or overwritten ones.
+//
+// Because the mapping is the file, the ring survives the process. On
+// SIGSEGV, SIGBUS, SIGILL, SIGFPE or SIGABRT the handler also copies it to
+// "<path>.crash" with plain write() calls before the default action runs.
+// SIGUSR2 (or dump()) snapshots it to "<path>.<n>". The files hold
+// credentials seen on the wire (access tokens), so they are created 0600;
+// the auth request itself is never recorded. Read them with readFile();
+// flight_replay lists entries or feeds the inbound frames back through
+// Api::onMessage.
+class FlightRecorder {
+public:
+    static constexpr size_t SLOT_SIZE = 256;
+    static constexpr size_t SLOT_HEADER_SIZE = 32;
+    static constexpr size_t SLOT_PAYLOAD = SLOT_SIZE - SLOT_HEADER_SIZE;
+    static constexpr size_t HEADER_SIZE = 4096;
+    static constexpr char MAGIC[8] = {'T', 'S', 'F', 'L', 'I', 'G', 'H', 'T'};
+
+    static FlightRecorder& instance();
+
+    // Map a ring of about capacityBytes (rounded to a power-of-two slot
+    // count) at path and install the signal handlers. False if the file
+    // cannot be created or mapped.
+    bool start(const std::string& path, size_t capacityBytes = 64u << 20);
+    void stop();
+    bool enabled() const { return slots != nullptr; }
+
+    // Record one entry (timestamped now); no-op unless started. Entries
+    // longer than a quarter of the ring keep their head only.
+    static void record(FlightRecordType type, std::string_view data) {
+        FlightRecorder& recorder = instance();
+        if (recorder.slots) recorder.append(type, data.data(), data.size());
+    }
+    static void record(FlightRecordType type, const void* data, size_t size) {
+        FlightRecorder& recorder = instance();
+        if (recorder.slots) recorder.append(type, data, size);
+    }
+
+    // Copy the ring to a file; async-signal-safe. False on I/O errors.
+    bool dump(const char* path) const;
+
+    // Entries of a recording or dump, oldest first; false if not one
+    static bool readFile(const std::string& path, std::vector<FlightEntry>& out);
+
+private:
+    struct FileHeader {
+        char magic[8];
+        uint32_t slotSize;
+        uint32_t reserved;
+        uint64_t slotCount;
+        std::atomic<uint64_t> nextSlot; // slots ever claimed
+        int64_t wallOffsetNs; // add to a timestamp for wall clock ns
+        int64_t pid;
+    };
+    struct Slot {
+        uint64_t sequence; // slot index + 1 once complete, 0 while written
+        int64_t timestampNs;
+        uint32_t length;   // bytes of the whole entry (after truncation)
+        uint16_t type;
+        uint16_t flags;    // 1: truncated
+        uint32_t part;     // index of this slot within the entry
+        uint32_t parts;
+        char data[SLOT_PAYLOAD];
+    };
+    static_assert(sizeof(Slot) == SLOT_SIZE, "slots are written to disk as is");
+    static_assert(sizeof(FileHeader) <= HEADER_SIZE, "header fits its page");
+
+    FlightRecorder() = default;
+    ~FlightRecorder();
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    void append(FlightRecordType type, const void* data, size_t size);
+    void installHandlers();
+
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    FileHeader* header = nullptr;
+    Slot* slots = nullptr;
+    uint64_t slotMask = 0;
+    int fd = -1;
+    // Built in start() so the handlers need no allocation
+    char crashPath[512] = {};
+    char dumpPrefix[512] = {};
+    std::atomic<unsigned> dumpCount{0};
+
+    friend void flightRecorderSignal(int);
+};
+
+#endif // WEBSOCKETPP_FLIGHTRECORDER_HPP
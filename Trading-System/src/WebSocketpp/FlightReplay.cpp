@@ -0,0 +1,175 @@
+#include "Api.hpp"
+#include "FlightRecorder.hpp"
+#include "Trader.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Read a flight recording (FLIGHT_RECORDER=path, or a .crash / .<n> dump).
+//   flight_replay --list <file>   entries as JSON lines
+//   flight_replay <file>          feed the inbound frames back through
+//                                 Api::onMessage with the default Trader and
+//                                 compare the outcome with the recording
+
+namespace {
+
+// Keeps what the replayed session sends instead of sending it
+class ReplaySocket : public BSocket {
+public:
+    std::vector<std::string> sent;
+
+    bool connect(const std::string&) override { return true; }
+    bool send(std::string_view message) override {
+        sent.emplace_back(message);
+        return true;
+    }
+    void close() override {}
+};
+
+const char* typeName(FlightRecordType type) {
+    switch (type) {
+    case FlightRecordType::Inbound: return "inbound";
+    case FlightRecordType::Outbound: return "outbound";
+    case FlightRecordType::BookApply: return "book_apply";
+    case FlightRecordType::OrderState: return "order_state";
+    case FlightRecordType::InstrumentAdded: return "instrument_added";
+    case FlightRecordType::Note: return "note";
+    }
+    return "unknown";
+}
+
+bool isOrder(const std::string& request) {
+    return request.find("\"private/buy\"") != std::string::npos || request.find("\"private/sell\"") != std::string::npos;
+}
+
+int list(const std::vector<FlightEntry>& entries) {
+    for (const FlightEntry& e : entries) {
+        json line = {{"seq", e.sequence}, {"ts_ns", e.timestampNs}, {"type", typeName(e.type)}};
+        if (e.truncated) line["truncated"] = true;
+        if (e.type == FlightRecordType::BookApply && e.data.size() == sizeof(FlightBookApply)) {
+            FlightBookApply apply;
+            std::memcpy(&apply, e.data.data(), sizeof(apply));
+            line["instrument"] = apply.instrument;
+            line["snapshot"] = (apply.flags & 1) != 0;
+            line["change_id"] = apply.changeId;
+            if (apply.flags & 2) line["best_bid"] = apply.bestBid;
+            if (apply.flags & 4) line["best_ask"] = apply.bestAsk;
+        } else {
+            line["data"] = e.data;
+        }
+        std::cout << line.dump(-1, ' ', false, json::error_handler_t::replace) << "\n";
+    }
+    return 0;
+}
+
+int replay(const std::vector<FlightEntry>& entries) {
+    auto* socket = new ReplaySocket();
+    Api api(socket);
+    // Register the recorded instruments in their original order, so they
+    // get the ids the BookApply entries refer to
+    std::vector<InstrumentSpec> instruments;
+    for (const FlightEntry& e : entries) {
+        if (e.type != FlightRecordType::InstrumentAdded) continue;
+        std::istringstream in(e.data);
+        InstrumentSpec spec{"", 0.0};
+        if (!(in >> spec.name >> spec.tickSize)) continue;
+        bool known = std::any_of(instruments.begin(), instruments.end(),
+                                 [&](const InstrumentSpec& s) { return s.name == spec.name; });
+        if (!known) instruments.push_back(spec);
+    }
+    if (instruments.empty()) {
+        // The registrations fell out of the ring: assume the default setup
+        instruments.push_back({DEFAULT_INSTRUMENT, DEFAULT_TICK_SIZE});
+    }
+    api.addInstruments(instruments);
+    // Not started: the strategy reacts to the replayed books, but nothing is
+    // subscribed and no monitor thread cancels orders on wall-clock time
+    Trader trader(&api, instruments);
+    api.setTrader(&trader);
+
+    // The strategy prints each quote; keep the output to the summary
+    std::ostringstream quotes;
+    std::streambuf* console = std::cout.rdbuf(quotes.rdbuf());
+    size_t inbound = 0, recordedOrders = 0, tracked = 0;
+    std::map<uint32_t, FlightBookApply> lastApply;
+    for (const FlightEntry& e : entries) {
+        switch (e.type) {
+        case FlightRecordType::Inbound:
+            api.onMessage(e.data, BSocket::clockNs());
+            ++inbound;
+            break;
+        case FlightRecordType::Outbound:
+            // Responses to it in the recording find it pending, as they did live
+            recordedOrders += isOrder(e.data);
+            tracked += api.trackRequest(e.data);
+            break;
+        case FlightRecordType::Note:
+            if (e.data.rfind("public/auth id=", 0) == 0) {
+                json auth = {{"id", std::atoi(e.data.c_str() + std::strlen("public/auth id="))}, {"method", "public/auth"}};
+                tracked += api.trackRequest(auth.dump());
+            }
+            break;
+        case FlightRecordType::BookApply:
+            if (e.data.size() == sizeof(FlightBookApply)) {
+                FlightBookApply apply;
+                std::memcpy(&apply, e.data.data(), sizeof(apply));
+                lastApply[apply.instrument] = apply;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    std::cout.rdbuf(console);
+
+    size_t replayedOrders = 0;
+    for (const std::string& request : socket->sent) replayedOrders += isOrder(request);
+    // Each book must end where the recording last saw it
+    size_t booksChecked = 0, booksMatched = 0;
+    for (const auto& [id, apply] : lastApply) {
+        if (id >= instruments.size()) continue;
+        const OrderBook* book = api.findBook(instruments[id].name);
+        if (!book) continue;
+        ++booksChecked;
+        bool bidMatches = (apply.flags & 2) ? book->hasBids() && book->bestBid() == apply.bestBid : !book->hasBids();
+        bool askMatches = (apply.flags & 4) ? book->hasAsks() && book->bestAsk() == apply.bestAsk : !book->hasAsks();
+        if (bidMatches && askMatches && book->changeId == apply.changeId) ++booksMatched;
+        json line = {{"event", "replay_book"}, {"instrument", instruments[id].name}, {"change_id", book->changeId},
+                     {"recorded_change_id", apply.changeId}, {"matches", bidMatches && askMatches && book->changeId == apply.changeId}};
+        if (book->hasBids()) line["best_bid"] = book->bestBid();
+        if (book->hasAsks()) line["best_ask"] = book->bestAsk();
+        std::cout << line.dump() << "\n";
+    }
+    std::cout << "{\"event\":\"replay_summary\",\"entries\":" << entries.size() << ",\"inbound\":" << inbound
+              << ",\"tracked_requests\":" << tracked << ",\"recorded_orders\":" << recordedOrders
+              << ",\"replayed_orders\":" << replayedOrders << ",\"books_checked\":" << booksChecked
+              << ",\"books_matched\":" << booksMatched << "}" << std::endl;
+    // A ring that wrapped mid-stream may start on deltas; such a book only
+    // matches once a later snapshot is in the recording
+    return booksMatched == booksChecked ? 0 : 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool listOnly = argc == 3 && std::strcmp(argv[1], "--list") == 0;
+    if (argc != 2 && !listOnly) {
+        std::cerr << "usage: " << argv[0] << " [--list] <flight recording>" << std::endl;
+        return 1;
+    }
+    const char* path = argv[argc - 1];
+    std::vector<FlightEntry> entries;
+    if (!FlightRecorder::readFile(path, entries)) {
+        std::cerr << path << ": not a flight recording" << std::endl;
+        return 1;
+    }
+    return listOnly ? list(entries) : replay(entries);
+}
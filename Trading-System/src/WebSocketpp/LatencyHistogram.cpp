@@ -0,0 +1,45 @@
+#include "LatencyHistogram.hpp"
+#include <cmath>
+#include <vector>
+
+LatencyHistogram::LatencyHistogram() : counts(new std::atomic<uint64_t>[BUCKETS]) {
+    for (size_t i = 0; i < BUCKETS; ++i) counts[i].store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::highestValueAt(size_t index) {
+    if (index < SUB_BUCKETS) return index;
+    int shift = static_cast<int>(index / HALF_BUCKETS) - 1;
+    uint64_t lowest = (index % HALF_BUCKETS + HALF_BUCKETS) << shift;
+    return lowest + (1ULL << shift) - 1;
+}
+
+LatencySnapshot LatencyHistogram::takeInterval() {
+    LatencySnapshot snapshot;
+    // Reporting thread only: the copy is allocated here, never in record()
+    std::vector<uint64_t> interval(BUCKETS);
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        interval[i] = counts[i].exchange(0, std::memory_order_relaxed);
+        snapshot.count += interval[i];
+    }
+    uint64_t total = sum.exchange(0, std::memory_order_relaxed);
+    snapshot.max = max.exchange(0, std::memory_order_relaxed);
+    if (snapshot.count == 0) return snapshot;
+    snapshot.mean = static_cast<double>(total) / static_cast<double>(snapshot.count);
+
+    // Walk the buckets once, filling each percentile as its rank is reached
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    uint64_t* outputs[] = {&snapshot.p50, &snapshot.p90, &snapshot.p99, &snapshot.p999};
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS && next < 4; ++i) {
+        seen += interval[i];
+        while (next < 4 && seen >= static_cast<uint64_t>(std::ceil(quantiles[next] * snapshot.count))) {
+            *outputs[next++] = highestValueAt(i);
+        }
+    }
+    // The max is exact; a percentile's bucket bound may overshoot it
+    for (uint64_t* p : outputs) {
+        if (*p > snapshot.max) *p = snapshot.max;
+    }
+    return snapshot;
+}
@@ -0,0 +1,66 @@
+#ifndef WEBSOCKETPP_LATENCYHISTOGRAM_HPP
+#define WEBSOCKETPP_LATENCYHISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Percentiles of one interval of a LatencyHistogram, in nanoseconds
+struct LatencySnapshot {
+    uint64_t count = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+    double mean = 0.0;
+};
+
+// HDR-style latency histogram: log-linear buckets, each power of two split
+// into SUB_BUCKETS / 2 linear steps, so every recorded value is kept to
+// within 1 / (SUB_BUCKETS / 2) (about 1.6%) up to MAX_VALUE_NS (about 73 min);
+// larger values land in the top bucket. Buckets are atomic counters:
+// record() is wait-free from any number of threads, and takeInterval()
+// moves the counts out bucket by bucket, so a value recorded meanwhile is
+// counted in this interval or the next, never lost.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    static constexpr uint64_t HALF_BUCKETS = SUB_BUCKETS / 2;
+    static constexpr int MAX_VALUE_BITS = 42;
+    static constexpr uint64_t MAX_VALUE_NS = (1ULL << MAX_VALUE_BITS) - 1;
+    static constexpr size_t BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * HALF_BUCKETS + HALF_BUCKETS;
+
+    LatencyHistogram();
+
+    // Negative values (clock steps, skew against a remote timestamp) count as 0
+    void record(long long ns) {
+        uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+        if (value > MAX_VALUE_NS) value = MAX_VALUE_NS;
+        counts[indexOf(value)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t seen = max.load(std::memory_order_relaxed);
+        while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Percentiles since the previous call, and start a new interval
+    LatencySnapshot takeInterval();
+
+    static size_t indexOf(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        int shift = 63 - __builtin_clzll(value) - (SUB_BUCKET_BITS - 1);
+        return static_cast<size_t>(shift) * HALF_BUCKETS + static_cast<size_t>(value >> shift);
+    }
+    // Largest value that maps to a bucket (what a percentile reports)
+    static uint64_t highestValueAt(size_t index);
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+#endif // WEBSOCKETPP_LATENCYHISTOGRAM_HPP
@@ -0,0 +1,78 @@
+#include "LowLatency.hpp"
+#include <iostream>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+static void readEnv(const char* name, int& value) {
+    if (const char* text = std::getenv(name)) value = std::atoi(text);
+}
+
+LowLatencyConfig LowLatencyConfig::fromEnvironment() {
+    LowLatencyConfig config;
+    int spin = config.spin ? 1 : 0;
+    int quickAck = config.quickAck ? 1 : 0;
+    int spinsBeforeYield = static_cast<int>(config.spinsBeforeYield);
+    readEnv("LL_SPIN", spin);
+    readEnv("LL_SPINS_BEFORE_YIELD", spinsBeforeYield);
+    readEnv("LL_BUSY_POLL_US", config.busyPollUs);
+    readEnv("LL_QUICKACK", quickAck);
+    readEnv("LL_RCVBUF", config.recvBufferBytes);
+    readEnv("LL_SNDBUF", config.sendBufferBytes);
+    readEnv("LL_IO_CPU", config.ioCpu);
+    readEnv("LL_MONITOR_CPU", config.monitorCpu);
+    config.spin = spin != 0;
+    config.quickAck = quickAck != 0;
+    config.spinsBeforeYield = spinsBeforeYield > 0 ? static_cast<unsigned>(spinsBeforeYield) : 0;
+    return config;
+}
+
+static bool pinHandle(pthread_t handle, int cpu) {
+    if (cpu < 0) return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(handle, sizeof(set), &set);
+    if (rc != 0) {
+        std::cerr << "Failed to pin thread to CPU " << cpu << ": " << std::strerror(rc) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool pinThread(int cpu) {
+    return pinHandle(pthread_self(), cpu);
+}
+
+bool pinThread(std::thread& thread, int cpu) {
+    return pinHandle(thread.native_handle(), cpu);
+}
+
+bool setBusyPoll(int fd, int us) {
+    if (us <= 0) return true;
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &us, sizeof(us)) != 0) {
+        std::cerr << "Failed to set SO_BUSY_POLL=" << us << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void setIntOption(int fd, int level, int name, int value, const char* label) {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) != 0) {
+        std::cerr << "Failed to set " << label << "=" << value << ": " << std::strerror(errno) << std::endl;
+    }
+}
+
+void tuneSocket(int fd, const LowLatencyConfig& config) {
+    setIntOption(fd, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+    // Not sticky: the kernel may fall back to delayed acks later on
+    if (config.quickAck) setIntOption(fd, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK");
+    if (config.recvBufferBytes > 0) setIntOption(fd, SOL_SOCKET, SO_RCVBUF, config.recvBufferBytes, "SO_RCVBUF");
+    if (config.sendBufferBytes > 0) setIntOption(fd, SOL_SOCKET, SO_SNDBUF, config.sendBufferBytes, "SO_SNDBUF");
+    setBusyPoll(fd, config.busyPollUs);
+}
@@ -0,0 +1,72 @@
+#ifndef WEBSOCKETPP_LOWLATENCY_HPP
+#define WEBSOCKETPP_LOWLATENCY_HPP
+
+#include <thread>
+#include <immintrin.h>
+
+// Per-deployment trade of CPU for latency. By default every thread blocks in
+// the kernel and floats across cores. With spin set, the socket reader polls
+// a non-blocking socket in a tight loop instead of sleeping until the
+// scheduler wakes it; pin it to an isolated core (isolcpus/nohz_full) so the
+// spinning neither competes with nor is preempted by other work.
+struct LowLatencyConfig {
+    // Reader polls instead of blocking
+    bool spin = false;
+    // Empty polls between yields while spinning; 0 never yields (the core is
+    // burned entirely)
+    unsigned spinsBeforeYield = 0;
+    // SO_BUSY_POLL on the socket, in microseconds (0 = off). Values above
+    // net.core.busy_read need CAP_NET_ADMIN.
+    int busyPollUs = 0;
+    // TCP_QUICKACK on connect, so handshake replies are acked at once
+    bool quickAck = true;
+    // SO_RCVBUF / SO_SNDBUF in bytes (0 = kernel autotuning)
+    int recvBufferBytes = 0;
+    int sendBufferBytes = 0;
+
+    // CPU for each thread, -1 = leave to the scheduler. The strategy has no
+    // thread of its own: Trader reacts to book updates on the socket reader,
+    // so ioCpu is the strategy core too.
+    int ioCpu = -1;      // socket reader / io_context thread, runs the strategy
+    int monitorCpu = -1; // Trader's stale-order monitor
+
+    // LL_SPIN, LL_SPINS_BEFORE_YIELD, LL_BUSY_POLL_US, LL_QUICKACK, LL_RCVBUF,
+    // LL_SNDBUF, LL_IO_CPU and LL_MONITOR_CPU override the defaults
+    static LowLatencyConfig fromEnvironment();
+};
+
+// Pin the calling thread / a thread to one CPU; logs and returns false on
+// failure. cpu < 0 is a no-op.
+bool pinThread(int cpu);
+bool pinThread(std::thread& thread, int cpu);
+
+// Set SO_BUSY_POLL on a socket; logs and returns false on failure.
+// us <= 0 is a no-op.
+bool setBusyPoll(int fd, int us);
+
+// Apply the socket side of the profile to a connected TCP socket:
+// TCP_NODELAY always, then quick ack, buffer sizes and busy polling.
+// Failures are logged and do not fail the connection.
+void tuneSocket(int fd, const LowLatencyConfig& config);
+
+// Idle step of a poll loop: pause, and yield every spinsBeforeYield idle
+// polls so a shared core still makes progress
+class SpinWait {
+public:
+    explicit SpinWait(unsigned spinsBeforeYield) : limit(spinsBeforeYield) {}
+
+    void idle() {
+        _mm_pause();
+        if (limit != 0 && ++spins >= limit) {
+            spins = 0;
+            std::this_thread::yield();
+        }
+    }
+    void reset() { spins = 0; }
+
+private:
+    unsigned limit;
+    unsigned spins = 0;
+};
+
+#endif // WEBSOCKETPP_LOWLATENCY_HPP
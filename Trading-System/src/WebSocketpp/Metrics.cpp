@@ -0,0 +1,72 @@
+#include "Metrics.hpp"
+#include "EventLog.hpp"
+
+Metrics::Metrics(size_t channels) : channels(channels), channelHistograms(channels), channelNames(channels) {
+    for (auto& h : this->channels) h.store(nullptr, std::memory_order_relaxed);
+}
+
+Metrics::~Metrics() {
+    stopReporting();
+}
+
+void Metrics::addChannel(InstrumentId instrument, const std::string& name) {
+    if (instrument >= channels.size()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (channelHistograms[instrument]) return;
+    channelHistograms[instrument] = std::make_unique<LatencyHistogram>();
+    channelNames[instrument] = "process.book." + name;
+    channels[instrument].store(channelHistograms[instrument].get(), std::memory_order_release);
+}
+
+void Metrics::startReporting(std::chrono::milliseconds interval) {
+    if (reporter.joinable()) return;
+    stopping = false;
+    reporter = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+            lock.unlock();
+            report(interval);
+            lock.lock();
+        }
+    });
+}
+
+void Metrics::stopReporting() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (reporter.joinable()) reporter.join();
+}
+
+void Metrics::log(const std::string& name, LatencyHistogram& histogram, std::chrono::milliseconds interval) {
+    LatencySnapshot s = histogram.takeInterval();
+    if (s.count == 0) return;
+    EventRecord event(EventType::LatencySnapshot);
+    EventRecord::setText(event.key, name);
+    event.count = static_cast<uint32_t>(interval.count());
+    event.ids[0] = s.count;
+    event.ids[1] = s.max;
+    event.values[0] = static_cast<double>(s.p50);
+    event.values[1] = static_cast<double>(s.p90);
+    event.values[2] = static_cast<double>(s.p99);
+    event.values[3] = static_cast<double>(s.p999);
+    EventLog::log(event);
+}
+
+void Metrics::report(std::chrono::milliseconds interval) {
+    for (size_t kind = 1; kind < REQUEST_KINDS; ++kind) {
+        log(std::string("request.") + requestKindName(static_cast<RequestKind>(kind)), requests[kind], interval);
+    }
+    log("propagation", propagation, interval);
+    log("parse", parse, interval);
+    log("tick_to_trade", tickToTrade, interval);
+    for (size_t stage = 0; stage < TRACE_STAGES; ++stage) {
+        log(std::string("trace.") + traceStageName(static_cast<TraceStage>(stage)), traceStages[stage], interval);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < channelHistograms.size(); ++i) {
+        if (channelHistograms[i]) log(channelNames[i], *channelHistograms[i], interval);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef WEBSOCKETPP_METRICS_HPP
+#define WEBSOCKETPP_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BookRegistry.hpp"
+#include "Dispatch.hpp"
+#include "LatencyHistogram.hpp"
+#include "Tracer.hpp"
+
+// In-process latency metrics: one histogram per request kind (request to
+// response), one per book channel (receive to handled), and one each for
+// propagation (exchange timestamp to receive), parsing (receive to decoded)
+// and tick-to-trade (receive to a triggered order sent), plus one per
+// stage of the traces closed by Tracer. Recording is wait-free; a reporter
+// thread logs a latency_snapshot event per metric every interval and
+// starts the next one.
+class Metrics {
+public:
+    static constexpr size_t REQUEST_KINDS = static_cast<size_t>(RequestKind::GetPositions) + 1;
+
+    explicit Metrics(size_t channels = BookRegistry::DEFAULT_CAPACITY);
+    ~Metrics();
+
+    void recordRequest(RequestKind kind, long long ns) { requests[static_cast<size_t>(kind)].record(ns); }
+    // Processing time of a book update; dropped for instruments never added
+    void recordProcessing(InstrumentId instrument, long long ns) {
+        if (instrument >= channels.size()) return;
+        if (LatencyHistogram* h = channels[instrument].load(std::memory_order_acquire)) h->record(ns);
+    }
+    void recordPropagation(long long ns) { propagation.record(ns); }
+    void recordParse(long long ns) { parse.record(ns); }
+    void recordTickToTrade(long long ns) { tickToTrade.record(ns); }
+    void recordTraceStage(TraceStage stage, long long ns) { traceStages[static_cast<size_t>(stage)].record(ns); }
+
+    // Track the book channel of a registered instrument (not on the hot path)
+    void addChannel(InstrumentId instrument, const std::string& name);
+
+    // Report every interval from a background thread until stopReporting()
+    void startReporting(std::chrono::milliseconds interval);
+    void stopReporting();
+    // Log one snapshot per metric that saw values, and reset them
+    void report(std::chrono::milliseconds interval);
+
+private:
+    void log(const std::string& name, LatencyHistogram& histogram, std::chrono::milliseconds interval);
+
+    std::array<LatencyHistogram, REQUEST_KINDS> requests;
+    LatencyHistogram propagation;
+    LatencyHistogram parse;
+    LatencyHistogram tickToTrade;
+    std::array<LatencyHistogram, TRACE_STAGES> traceStages;
+    std::vector<std::atomic<LatencyHistogram*>> channels;
+    // Owned histograms and their names; guarded by mutex
+    std::vector<std::unique_ptr<LatencyHistogram>> channelHistograms;
+    std::vector<std::string> channelNames;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false; // guarded by mutex
+    std::thread reporter;
+};
+
+#endif // WEBSOCKETPP_METRICS_HPP
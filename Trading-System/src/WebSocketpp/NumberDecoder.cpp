@@ -0,0 +1,58 @@
+#include "NumberDecoder.hpp"
+#include <charconv>
+#include <cstdint>
+
+namespace {
+
+// Largest digit count whose value is exact in a double mantissa
+constexpr int MAX_FAST_DIGITS = 15;
+
+constexpr double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16
+};
+
+inline bool isDigit(char c) { return static_cast<unsigned char>(c - '0') <= 9; }
+
+inline const char* fallback(const char* start, const char* end, double& out) {
+    auto result = std::from_chars(start, end, out);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// mantissa / 10^fracDigits is correctly rounded when both are exact doubles
+inline double finish(uint64_t mantissa, int fracDigits, bool negative) {
+    double value = static_cast<double>(mantissa) / POW10[fracDigits];
+    return negative ? -value : value;
+}
+
+} // namespace
+
+const char* NumberDecoder::decode(const char* p, const char* end, double& out) {
+    const char* start = p;
+    bool negative = p < end && *p == '-';
+    if (negative) ++p;
+    const char* intStart = p;
+    uint64_t mantissa = 0;
+    while (p < end && isDigit(*p)) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    int digits = static_cast<int>(p - intStart);
+    if (digits == 0) return nullptr;
+    int fracDigits = 0;
+    if (p < end && *p == '.') {
+        const char* fracStart = ++p;
+        while (p < end && isDigit(*p)) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            ++p;
+        }
+        fracDigits = static_cast<int>(p - fracStart);
+        if (fracDigits == 0) return nullptr;
+        digits += fracDigits;
+    }
+    if (digits > MAX_FAST_DIGITS || (p < end && (*p == 'e' || *p == 'E'))) {
+        return fallback(start, end, out);
+    }
+    out = finish(mantissa, fracDigits, negative);
+    return p;
+}
@@ -0,0 +1,16 @@
+#ifndef WEBSOCKETPP_NUMBERDECODER_HPP
+#define WEBSOCKETPP_NUMBERDECODER_HPP
+
+// Decodes the JSON decimal numbers that dominate book messages ("66990.5",
+// "12340.0") into doubles: one pass accumulates the digits into an integer
+// mantissa, divided once by a power of ten. Numbers with an exponent or more
+// than 15 significant digits go through std::from_chars, so results always
+// match it.
+class NumberDecoder {
+public:
+    // Decode the number starting at p; returns the end of the number,
+    // or nullptr if p does not start a number
+    static const char* decode(const char* p, const char* end, double& out);
+};
+
+#endif // WEBSOCKETPP_NUMBERDECODER_HPP
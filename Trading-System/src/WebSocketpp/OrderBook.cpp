@@ -0,0 +1,92 @@
+#include "OrderBook.hpp"
+
+OrderBook::OrderBook(double tickSize, size_t depth)
+    : bids(true, tickSize, depth), asks(false, tickSize, depth) {
+    buffered.reserve(RECOVERY_BUFFER_LEVELS);
+}
+
+void OrderBook::clear() {
+    bids.clear();
+    asks.clear();
+    changeId = 0;
+}
+
+void OrderBook::reset() {
+    clear();
+    syncState = SyncState::Empty;
+    recoveryRequested = false;
+    buffered.clear();
+    overflowed = false;
+}
+
+void OrderBook::setTickSize(double tickSize) {
+    bids.setTickSize(tickSize);
+    asks.setTickSize(tickSize);
+    changeId = 0;
+    syncState = SyncState::Empty;
+    recoveryRequested = false;
+    buffered.clear();
+    overflowed = false;
+}
+
+void OrderBook::setLevel(Side side, double price, double amount) {
+    if (side == Side::Bid) {
+        bids.set(price, amount);
+    } else {
+        asks.set(price, amount);
+    }
+}
+
+void OrderBook::applyLevel(Side side, Action action, double price, double amount) {
+    // "new" and "change" both carry the full amount at that price, so they
+    // overwrite the slot for that tick; "delete" empties it
+    if (action == Action::Delete) {
+        setLevel(side, price, 0.0);
+    } else {
+        setLevel(side, price, amount);
+    }
+}
+
+void OrderBook::beginRecovery() {
+    syncState = SyncState::Recovering;
+    buffered.clear();
+    overflowed = false;
+}
+
+bool OrderBook::bufferLevel(uint64_t deltaChangeId, uint64_t prevChangeId, Side side, Action action,
+                            double price, double amount) {
+    // Never grow past the preallocated buffer; an overflow forces another snapshot
+    if (buffered.size() >= RECOVERY_BUFFER_LEVELS) {
+        overflowed = true;
+        return false;
+    }
+    buffered.push_back({deltaChangeId, prevChangeId, side, action, price, amount});
+    return true;
+}
+
+bool OrderBook::replayBuffered() {
+    if (overflowed) return false;
+    uint64_t applying = 0;
+    for (const auto& level : buffered) {
+        if (level.changeId != applying) {
+            // Already contained in the snapshot
+            if (level.changeId <= changeId) continue;
+            // First level of the next delta must chain onto the book
+            if (level.prevChangeId != changeId) return false;
+            applying = level.changeId;
+            changeId = level.changeId;
+        }
+        applyLevel(level.side, level.action, level.price, level.amount);
+    }
+    buffered.clear();
+    syncState = SyncState::Synced;
+    recoveryRequested = false;
+    return true;
+}
+
+bool OrderBook::parseAction(std::string_view action, Action& out) {
+    if (action == "new") { out = Action::New; return true; }
+    if (action == "change") { out = Action::Change; return true; }
+    if (action == "delete") { out = Action::Delete; return true; }
+    return false;
+}
@@ -0,0 +1,98 @@
+#ifndef WEBSOCKETPP_ORDERBOOK_HPP
+#define WEBSOCKETPP_ORDERBOOK_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "PriceLadder.hpp"
+#include "utility.hpp"
+
+// Small integer handle for an instrument, assigned once by BookRegistry
+using InstrumentId = uint16_t;
+constexpr InstrumentId INVALID_INSTRUMENT = 0xFFFF;
+
+// L2 order book maintained incrementally from Deribit book.* notifications.
+// Levels are updated in place; the book is only rebuilt on a snapshot.
+class OrderBook {
+public:
+    enum class Side { Bid, Ask };
+    // Level actions carried by raw/100ms book deltas
+    enum class Action { New, Change, Delete };
+
+    // Where the book stands relative to the channel's change_id chain
+    enum class SyncState { Empty, Synced, Recovering };
+
+    // Ticks held per side around the touch
+    static constexpr size_t DEFAULT_LADDER_DEPTH = 4096;
+    // Levels buffered per book while waiting for a recovery snapshot
+    static constexpr size_t RECOVERY_BUFFER_LEVELS = 1024;
+
+    explicit OrderBook(double tickSize = DEFAULT_TICK_SIZE, size_t depth = DEFAULT_LADDER_DEPTH);
+
+    // Drop all levels (before applying a snapshot)
+    void clear();
+    // Drop levels and channel state (after a reconnect); the next snapshot reseeds the book
+    void reset();
+    // Change the instrument's tick size (drops all levels)
+    void setTickSize(double tickSize);
+    // Set a level from a snapshot or grouped book message ([price, amount])
+    void setLevel(Side side, double price, double amount);
+    // Apply a level delta (["new"|"change"|"delete", price, amount])
+    void applyLevel(Side side, Action action, double price, double amount);
+
+    // True if a delta with this prev_change_id continues the book without a gap
+    bool continues(uint64_t prevChangeId) const {
+        return syncState == SyncState::Synced && prevChangeId == changeId;
+    }
+    // Enter recovery: deltas are buffered until a snapshot is applied
+    void beginRecovery();
+    // Buffer a delta level received while recovering; false if the buffer is full
+    bool bufferLevel(uint64_t changeId, uint64_t prevChangeId, Side side, Action action,
+                     double price, double amount);
+    // After a snapshot has been applied, replay buffered deltas newer than it.
+    // Returns false if the buffered deltas do not continue from the snapshot.
+    bool replayBuffered();
+    bool bufferOverflowed() const { return overflowed; }
+
+    // Map Deribit's action string to an Action, returns false if unknown
+    static bool parseAction(std::string_view action, Action& out);
+
+    bool hasBids() const { return !bids.empty(); }
+    bool hasAsks() const { return !asks.empty(); }
+    double bestBid() const { return bids.bestPrice(); }
+    double bestAsk() const { return asks.bestPrice(); }
+    double bestBidAmount() const { return bids.bestAmount(); }
+    double bestAskAmount() const { return asks.bestAmount(); }
+
+    const PriceLadder& getBids() const { return bids; }
+    const PriceLadder& getAsks() const { return asks; }
+    double getTickSize() const { return bids.getTickSize(); }
+
+    // change_id of the last snapshot or delta applied (0 if never seeded)
+    uint64_t changeId = 0;
+    SyncState syncState = SyncState::Empty;
+    // A recovery snapshot request is in flight
+    bool recoveryRequested = false;
+    // Instrument this book tracks, set on registration
+    std::string instrument;
+    InstrumentId id = INVALID_INSTRUMENT;
+
+private:
+    struct BufferedLevel {
+        uint64_t changeId;
+        uint64_t prevChangeId;
+        Side side;
+        Action action;
+        double price;
+        double amount;
+    };
+
+    PriceLadder bids;
+    PriceLadder asks;
+    std::vector<BufferedLevel> buffered;
+    bool overflowed = false;
+};
+
+#endif // WEBSOCKETPP_ORDERBOOK_HPP
@@ -0,0 +1,185 @@
+#include "OrderEncoder.hpp"
+#include <charconv>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+// Large enough for a request with a typical access token; grows once if not
+constexpr size_t BUFFER_RESERVE = 2048;
+
+std::string& threadBuffer() {
+    thread_local std::string buffer = [] {
+        std::string s;
+        s.reserve(BUFFER_RESERVE);
+        return s;
+    }();
+    return buffer;
+}
+
+constexpr int MAX_FIXED_DECIMALS = 8;
+constexpr double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+constexpr uint64_t POW10_INT[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+// Integers below this convert to double exactly
+constexpr double EXACT_INTEGER_LIMIT = 9007199254740992.0;
+
+// Prices and amounts carry a few decimals: print the fewest decimals that
+// round-trip, which is far cheaper than the general shortest-form search.
+// Anything else falls back to std::to_chars.
+inline void appendNumber(std::string& out, double value) {
+    char digits[32];
+    double magnitude = value < 0 ? -value : value;
+    for (int decimals = 0; decimals <= MAX_FIXED_DECIMALS; ++decimals) {
+        double scaled = magnitude * POW10[decimals];
+        if (!(scaled < EXACT_INTEGER_LIMIT)) break;
+        uint64_t units = static_cast<uint64_t>(scaled + 0.5);
+        if (static_cast<double>(units) / POW10[decimals] != magnitude) continue;
+        char* p = digits;
+        if (value < 0) *p++ = '-';
+        p = std::to_chars(p, digits + sizeof(digits), units / POW10_INT[decimals]).ptr;
+        if (decimals > 0) {
+            *p++ = '.';
+            uint64_t fraction = units % POW10_INT[decimals];
+            for (int i = decimals - 1; i >= 0; --i) {
+                p[i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            p += decimals;
+        }
+        out.append(digits, p);
+        return;
+    }
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+inline void appendNumber(std::string& out, int value) {
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Close params, then the id goes last so every prefix stays constant
+inline std::string_view finishRequest(std::string& out, int id) {
+    out.append("},\"id\":");
+    appendNumber(out, id);
+    out.push_back('}');
+    return out;
+}
+
+std::string requestPrefix(std::string_view method, std::string_view token) {
+    std::string prefix = "{\"jsonrpc\":\"2.0\",\"method\":\"";
+    prefix.append(method);
+    prefix.append("\",\"params\":{");
+    if (!token.empty()) {
+        prefix.append("\"access_token\":\"");
+        prefix.append(token);
+        prefix.append("\",");
+    }
+    return prefix;
+}
+
+std::string orderPrefix(std::string_view method, std::string_view instrument, std::string_view token) {
+    std::string prefix = requestPrefix(method, token);
+    prefix.append("\"instrument_name\":\"");
+    prefix.append(instrument);
+    prefix.append("\",\"type\":\"limit\",\"amount\":");
+    return prefix;
+}
+
+} // namespace
+
+OrderEncoder::OrderEncoder() : current(nullptr) {
+    std::lock_guard<std::mutex> lock(updateMutex);
+    publish();
+}
+
+void OrderEncoder::addInstrument(InstrumentId id, std::string_view name) {
+    addInstruments({{id, std::string(name)}});
+}
+
+void OrderEncoder::addInstruments(const std::vector<std::pair<InstrumentId, std::string>>& instruments) {
+    if (instruments.empty()) return;
+    std::lock_guard<std::mutex> lock(updateMutex);
+    for (const auto& [id, name] : instruments) {
+        if (id >= instrumentNames.size()) instrumentNames.resize(id + 1);
+        instrumentNames[id] = name;
+    }
+    publish();
+}
+
+void OrderEncoder::setAccessToken(std::string_view token) {
+    std::lock_guard<std::mutex> lock(updateMutex);
+    if (token == accessToken) return;
+    accessToken = std::string(token);
+    publish();
+}
+
+std::unique_ptr<OrderEncoder::Templates> OrderEncoder::render() const {
+    auto templates = std::make_unique<Templates>();
+    templates->buy.resize(instrumentNames.size());
+    templates->sell.resize(instrumentNames.size());
+    for (size_t i = 0; i < instrumentNames.size(); ++i) {
+        if (instrumentNames[i].empty()) continue;
+        templates->buy[i] = orderPrefix("private/buy", instrumentNames[i], accessToken);
+        templates->sell[i] = orderPrefix("private/sell", instrumentNames[i], accessToken);
+    }
+    templates->cancel = requestPrefix("private/cancel", accessToken) + "\"order_id\":\"";
+    templates->edit = requestPrefix("private/edit", accessToken) + "\"order_id\":\"";
+    return templates;
+}
+
+void OrderEncoder::publish() {
+    std::unique_ptr<Templates> previous = std::move(published);
+    published = render();
+    current.store(published.get(), std::memory_order_seq_cst);
+    // An encoder that loaded the previous set is counted by now; once none
+    // is left, nothing can reach it. Encoders hold it for one copy only.
+    while (readers.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+}
+
+OrderEncoder::ReadGuard::ReadGuard(const OrderEncoder& encoder) : readers(encoder.readers) {
+    // Counted before the load, so publish() either sees this reader or this
+    // reader sees the new set
+    readers.fetch_add(1, std::memory_order_seq_cst);
+    templates = encoder.current.load(std::memory_order_seq_cst);
+}
+
+std::string_view OrderEncoder::encodeOrder(InstrumentId instrument, bool buy, int id, double price, double amount,
+                                           std::string_view label) const {
+    ReadGuard guard(*this);
+    const auto& prefixes = buy ? guard.templates->buy : guard.templates->sell;
+    if (instrument >= prefixes.size() || prefixes[instrument].empty()) return {};
+    std::string& out = threadBuffer();
+    out.assign(prefixes[instrument]);
+    appendNumber(out, amount);
+    out.append(",\"price\":");
+    appendNumber(out, price);
+    if (!label.empty()) {
+        out.append(",\"label\":\"");
+        out.append(label);
+        out.push_back('"');
+    }
+    return finishRequest(out, id);
+}
+
+std::string_view OrderEncoder::encodeCancel(int id, std::string_view orderId) const {
+    ReadGuard guard(*this);
+    std::string& out = threadBuffer();
+    out.assign(guard.templates->cancel);
+    out.append(orderId);
+    out.push_back('"');
+    return finishRequest(out, id);
+}
+
+std::string_view OrderEncoder::encodeEdit(int id, std::string_view orderId, double price, double amount) const {
+    ReadGuard guard(*this);
+    std::string& out = threadBuffer();
+    out.assign(guard.templates->edit);
+    out.append(orderId);
+    out.append("\",\"amount\":");
+    appendNumber(out, amount);
+    out.append(",\"price\":");
+    appendNumber(out, price);
+    return finishRequest(out, id);
+}
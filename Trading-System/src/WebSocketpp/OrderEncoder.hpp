@@ -0,0 +1,72 @@
+#ifndef WEBSOCKETPP_ORDERENCODER_HPP
+#define WEBSOCKETPP_ORDERENCODER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "OrderBook.hpp"
+
+// Renders private/buy, private/sell, private/cancel and private/edit requests
+// from JSON-RPC prefixes pre-rendered per (method, instrument) with the access
+// token already inlined. Encoding copies the prefix and appends the amount,
+// price and id digits into a per-thread buffer, so it does not allocate once
+// the buffer has grown to fit.
+//
+// Template sets are immutable once published; adding instruments or a new
+// token publishes a new generation. The previous one is freed as soon as no
+// encoder is still copying from it, so only one generation is kept.
+class OrderEncoder {
+public:
+    OrderEncoder();
+
+    // Template maintenance (rare, not on the order path). Each call renders
+    // and publishes once: add a batch of instruments in a single call.
+    void addInstrument(InstrumentId id, std::string_view name);
+    void addInstruments(const std::vector<std::pair<InstrumentId, std::string>>& instruments);
+    void setAccessToken(std::string_view token);
+
+    // The returned view points into the calling thread's buffer and is valid
+    // until that thread encodes again. Empty if the instrument has no template.
+    // A non-empty label is sent as the order's label (at most 64 characters).
+    std::string_view encodeOrder(InstrumentId instrument, bool buy, int id, double price, double amount,
+                                 std::string_view label = {}) const;
+    std::string_view encodeCancel(int id, std::string_view orderId) const;
+    std::string_view encodeEdit(int id, std::string_view orderId, double price, double amount) const;
+
+private:
+    struct Templates {
+        // Indexed by InstrumentId; each ends with "amount":
+        std::vector<std::string> buy;
+        std::vector<std::string> sell;
+        // Each ends with "order_id":"
+        std::string cancel;
+        std::string edit;
+    };
+
+    // Counts an encoder in for as long as it reads the current templates
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const OrderEncoder& encoder);
+        ~ReadGuard() { readers.fetch_sub(1, std::memory_order_release); }
+        const Templates* templates;
+    private:
+        std::atomic<int>& readers;
+    };
+
+    std::unique_ptr<Templates> render() const;
+    void publish();
+
+    std::mutex updateMutex;
+    std::vector<std::string> instrumentNames;
+    std::string accessToken;
+    std::unique_ptr<Templates> published;
+    std::atomic<const Templates*> current;
+    // Encoders between loading current and finishing their copy
+    mutable std::atomic<int> readers{0};
+};
+
+#endif // WEBSOCKETPP_ORDERENCODER_HPP
@@ -0,0 +1,103 @@
+#include "PriceLadder.hpp"
+#include <algorithm>
+
+// Amounts below this are treated as an empty level
+static constexpr double MIN_LEVEL_AMOUNT = 1e-12;
+
+PriceLadder::PriceLadder(bool isBid, double tickSize, size_t depth)
+    : levels(depth, 0.0), baseTick(0), bestIdx(-1), isBid(isBid),
+      tickSize(tickSize), invTickSize(1.0 / tickSize), count(0), dropped(0) {}
+
+void PriceLadder::clear() {
+    std::fill(levels.begin(), levels.end(), 0.0);
+    bestIdx = -1;
+    count = 0;
+}
+
+void PriceLadder::setTickSize(double newTickSize) {
+    clear();
+    tickSize = newTickSize;
+    invTickSize = 1.0 / newTickSize;
+}
+
+void PriceLadder::setTick(int64_t tick, double amount) {
+    const int depth = static_cast<int>(levels.size());
+    bool present = amount > MIN_LEVEL_AMOUNT;
+    int64_t offset = tick - baseTick;
+    if (offset < 0 || offset >= depth) {
+        // Removing a level we never tracked is a no-op
+        if (!present) return;
+        // A new touch outside the window moves the window; deep levels
+        // beyond the window are not worth tracking
+        if (empty() || better(tick, bestTick())) {
+            recenter(tick);
+        } else {
+            ++dropped;
+            return;
+        }
+        offset = tick - baseTick;
+    }
+    int idx = static_cast<int>(offset);
+    double& slot = levels[static_cast<size_t>(idx)];
+    if (present) {
+        if (slot <= 0.0) ++count;
+        slot = amount;
+        if (bestIdx < 0 || better(idx, bestIdx)) {
+            bestIdx = idx;
+        }
+    } else {
+        if (slot <= 0.0) return;
+        slot = 0.0;
+        --count;
+        if (idx == bestIdx) {
+            bestIdx = findBestFrom(idx);
+        }
+    }
+    // Keep the touch away from the edges so it has room to move either way
+    if (bestIdx >= 0 && (bestIdx < depth / 8 || bestIdx >= depth - depth / 8)) {
+        recenter(bestTick());
+    }
+}
+
+double PriceLadder::amountAt(double price) const {
+    int64_t offset = toTick(price) - baseTick;
+    if (offset < 0 || offset >= static_cast<int64_t>(levels.size())) return 0.0;
+    return levels[static_cast<size_t>(offset)];
+}
+
+void PriceLadder::recenter(int64_t centerTick) {
+    const int64_t depth = static_cast<int64_t>(levels.size());
+    int64_t newBase = centerTick - depth / 2;
+    int64_t shift = newBase - baseTick;
+    if (shift == 0) return;
+    if (shift >= depth || shift <= -depth) {
+        std::fill(levels.begin(), levels.end(), 0.0);
+    } else if (shift > 0) {
+        // Window moves up: index i now holds what was at i + shift
+        std::copy(levels.begin() + shift, levels.end(), levels.begin());
+        std::fill(levels.end() - shift, levels.end(), 0.0);
+    } else {
+        std::copy_backward(levels.begin(), levels.end() + shift, levels.end());
+        std::fill(levels.begin(), levels.begin() - shift, 0.0);
+    }
+    baseTick = newBase;
+    size_t kept = static_cast<size_t>(std::count_if(levels.begin(), levels.end(),
+                                                    [](double a) { return a > 0.0; }));
+    dropped += count - kept;
+    count = kept;
+    bestIdx = findBestFrom(isBid ? static_cast<int>(depth) - 1 : 0);
+}
+
+int PriceLadder::findBestFrom(int idx) const {
+    const int depth = static_cast<int>(levels.size());
+    if (isBid) {
+        for (int i = std::min(idx, depth - 1); i >= 0; --i) {
+            if (levels[static_cast<size_t>(i)] > 0.0) return i;
+        }
+    } else {
+        for (int i = std::max(idx, 0); i < depth; ++i) {
+            if (levels[static_cast<size_t>(i)] > 0.0) return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,58 @@
+#ifndef WEBSOCKETPP_PRICELADDER_HPP
+#define WEBSOCKETPP_PRICELADDER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+// One side of an L2 book stored as a flat array of amounts indexed by price tick.
+// The array covers a fixed window of ticks around the touch and is recentred when
+// the market moves towards either edge. Level updates and best price reads are O(1);
+// removing the best level scans outwards to the next populated tick.
+class PriceLadder {
+public:
+    PriceLadder(bool isBid, double tickSize, size_t depth);
+
+    // Drop all levels, keeping the tick size and window size
+    void clear();
+    // Change tick size (drops all levels)
+    void setTickSize(double tickSize);
+
+    // Set the amount at a price; an amount of zero removes the level
+    void set(double price, double amount) { setTick(toTick(price), amount); }
+    void setTick(int64_t tick, double amount);
+
+    bool empty() const { return bestIdx < 0; }
+    int64_t bestTick() const { return baseTick + bestIdx; }
+    double bestPrice() const { return static_cast<double>(bestTick()) * tickSize; }
+    double bestAmount() const { return levels[static_cast<size_t>(bestIdx)]; }
+
+    // Amount at a price (0 if empty or outside the window)
+    double amountAt(double price) const;
+
+    int64_t toTick(double price) const { return std::llround(price * invTickSize); }
+    double getTickSize() const { return tickSize; }
+    size_t levelCount() const { return count; }
+    // Levels that arrived outside the window and were not tracked
+    uint64_t droppedLevels() const { return dropped; }
+
+private:
+    // True if tick a is closer to the touch than tick b for this side
+    bool better(int64_t a, int64_t b) const { return isBid ? a > b : a < b; }
+    // Move the window so centerTick sits in the middle
+    void recenter(int64_t centerTick);
+    // Find the next populated index moving away from the touch, -1 if none
+    int findBestFrom(int idx) const;
+
+    std::vector<double> levels;
+    int64_t baseTick;   // tick stored at index 0
+    int bestIdx;        // index of the best level, -1 when empty
+    bool isBid;
+    double tickSize;
+    double invTickSize;
+    size_t count;
+    uint64_t dropped;
+};
+
+#endif // WEBSOCKETPP_PRICELADDER_HPP
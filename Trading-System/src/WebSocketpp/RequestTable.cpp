@@ -0,0 +1,42 @@
+#include "RequestTable.hpp"
+
+RequestTable::RequestTable(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+}
+
+void RequestTable::insert(int id, const RequestInfo& info) {
+    Slot& slot = slots[static_cast<uint32_t>(id) & mask];
+    // Claim the slot; only waits if another thread is mid-write on it
+    uint64_t current = slot.tag.load(std::memory_order_relaxed);
+    while ((current & STATE_MASK) == WRITING ||
+           !slot.tag.compare_exchange_weak(current, tagOf(id, WRITING), std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+        if ((current & STATE_MASK) == WRITING) current = slot.tag.load(std::memory_order_relaxed);
+    }
+    slot.kind.store(info.kind, std::memory_order_relaxed);
+    slot.instrument.store(info.instrument, std::memory_order_relaxed);
+    slot.sentNs.store(info.sentNs, std::memory_order_relaxed);
+    slot.triggerNs.store(info.triggerNs, std::memory_order_relaxed);
+    slot.tag.store(tagOf(id, READY), std::memory_order_release);
+}
+
+bool RequestTable::take(int id, RequestInfo& out) {
+    Slot& slot = slots[static_cast<uint32_t>(id) & mask];
+    uint64_t expected = tagOf(id, READY);
+    if (slot.tag.load(std::memory_order_acquire) != expected) return false;
+    RequestInfo info;
+    info.kind = slot.kind.load(std::memory_order_relaxed);
+    info.instrument = slot.instrument.load(std::memory_order_relaxed);
+    info.sentNs = slot.sentNs.load(std::memory_order_relaxed);
+    info.triggerNs = slot.triggerNs.load(std::memory_order_relaxed);
+    // Retiring validates the read: it fails if a writer reclaimed the slot meanwhile
+    if (!slot.tag.compare_exchange_strong(expected, tagOf(id, EMPTY), std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+        return false;
+    }
+    out = info;
+    return true;
+}
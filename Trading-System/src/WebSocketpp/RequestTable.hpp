@@ -0,0 +1,60 @@
+#ifndef WEBSOCKETPP_REQUESTTABLE_HPP
+#define WEBSOCKETPP_REQUESTTABLE_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "Dispatch.hpp"
+#include "OrderBook.hpp"
+
+// A request awaiting its response, kept for latency measurement and routing
+struct RequestInfo {
+    RequestKind kind = RequestKind::None;
+    long long sentNs = 0; // BSocket::clockNs() when sent
+    InstrumentId instrument = INVALID_INSTRUMENT;
+    // Receive time of the market data that triggered the request, 0 if none
+    long long triggerNs = 0;
+};
+
+// Fixed-capacity, lock-free table of pending requests, indexed by request id
+// modulo capacity. Each slot carries a tag (request id + state) that is
+// published last, so any number of request threads can insert while the
+// socket thread retires responses without a mutex. A request still pending
+// when its slot is reused capacity ids later is overwritten, and its response
+// is then reported as unknown.
+class RequestTable {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    // Capacity is rounded up to a power of two
+    explicit RequestTable(size_t capacity = DEFAULT_CAPACITY);
+
+    void insert(int id, const RequestInfo& info);
+    // Remove the request with this id; false if unknown, already retired or overwritten
+    bool take(int id, RequestInfo& out);
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    enum : uint64_t { EMPTY = 0, WRITING = 1, READY = 2, STATE_MASK = 3 };
+
+    static uint64_t tagOf(int id, uint64_t state) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(id)) << 2) | state;
+    }
+
+    // One cache line per slot: neighbouring ids are written and retired by
+    // different threads
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> tag{EMPTY};
+        std::atomic<RequestKind> kind{RequestKind::None};
+        std::atomic<InstrumentId> instrument{INVALID_INSTRUMENT};
+        std::atomic<int64_t> sentNs{0};
+        std::atomic<int64_t> triggerNs{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+};
+
+#endif // WEBSOCKETPP_REQUESTTABLE_HPP
@@ -1,9 +1,29 @@
 #include "Socket.hpp"
 #include <iostream>
 
+using tcp = boost::asio::ip::tcp;
+namespace websocket = boost::beast::websocket;
+namespace ssl = boost::asio::ssl;
+
+// Spin mode keeps this handler queued at all times. While any handler is
+// ready, run() checks the reactor without blocking, so the io thread
+// busy-polls the socket; unlike a poll() loop it stays inside one run() call
+// and keeps asio's per-thread handler memory cache.
+namespace {
+struct IdleSpin {
+    boost::asio::io_context* ioc;
+    SpinWait* spin;
+    void operator()() const {
+        spin->idle();
+        boost::asio::post(*ioc, *this);
+    }
+};
+}
+
 Socket::Socket()
-    : sslCtx(ssl::context::tlsv12_client), ws(ioc, sslCtx), open(false) {
+    : sslCtx(ssl::context::tlsv12_client), ws(ioc, sslCtx), plainWs(ioc), open(false) {
     sslCtx.set_verify_mode(boost::asio::ssl::verify_none);
+    ConnectionCache::enableResumption(sslCtx.native_handle());
 }
 
 Socket::~Socket() {
@@ -15,31 +35,56 @@ bool Socket::connect(const std::string& url) {
         std::string uri = url;
         std::string host = uri;
         std::string path = "/";
+        std::string port = "443";
         // Strip scheme
+        secure = true;
         if (host.rfind("wss://", 0) == 0) host = host.substr(6);
-        if (host.rfind("ws://", 0) == 0) host = host.substr(5);
+        if (host.rfind("ws://", 0) == 0) {
+            host = host.substr(5);
+            port = "80";
+            secure = false;
+        }
         // Split host and path
         size_t pos = host.find('/');
         if (pos != std::string::npos) {
             path = host.substr(pos);
             host = host.substr(0, pos);
         }
-        std::string port = "443";
-        // Resolve and connect TCP
-        tcp::resolver resolver(ioc);
-        auto results = resolver.resolve(host, port);
-        boost::beast::get_lowest_layer(ws).connect(results);
-        // SSL handshake
-        ws.next_layer().handshake(ssl::stream_base::client);
+        // Optional explicit port: host:port
+        size_t colon = host.rfind(':');
+        if (colon != std::string::npos) {
+            port = host.substr(colon + 1);
+            host = host.substr(0, colon);
+        }
+        // Connect TCP through the cached addresses (resolved on first use)
+        int family = AF_INET;
+        int fd = ConnectionCache::instance().connect(host, port, &family);
+        if (fd < 0) return false;
+        tcp::socket& socket = secure ? boost::beast::get_lowest_layer(ws) : plainWs.next_layer();
+        socket.assign(family == AF_INET6 ? tcp::v6() : tcp::v4(), fd);
+        tuneSocket(fd, lowLatency);
+        // SSL handshake, resuming the last session with this server if there is one
+        if (secure) {
+            SSL* ssl = ws.next_layer().native_handle();
+            SSL_set_tlsext_host_name(ssl, host.c_str());
+            ConnectionCache::instance().prepareSession(ssl, host + ":" + port);
+            ws.next_layer().handshake(ssl::stream_base::client);
+            ConnectionCache::instance().recordHandshake(ssl);
+        }
         // WebSocket handshake
-        ws.set_option(websocket::stream_base::timeout::suggested(websocket::role_type::client));
-        ws.handshake(host, path);
-        ws.text(true);
+        withStream([&](auto& stream) {
+            stream.set_option(websocket::stream_base::timeout::suggested(boost::beast::role_type::client));
+            stream.handshake(host, path);
+            stream.text(true);
+        });
         open = true;
         // Start asynchronous read loop
         doRead();
         ioThread = std::thread([this]() {
+            pinThread(lowLatency.ioCpu);
             try {
+                SpinWait spin(lowLatency.spinsBeforeYield);
+                if (lowLatency.spin) boost::asio::post(ioc, IdleSpin{&ioc, &spin});
                 ioc.run();
             } catch (const std::exception& e) {
                 std::cerr << "Socket io_thread exception: " << e.what() << std::endl;
@@ -54,46 +99,115 @@ bool Socket::connect(const std::string& url) {
 }
 
 void Socket::doRead() {
-    // Allocate a buffer for each read
-    auto buffer = std::make_shared<boost::beast::flat_buffer>();
-    ws.async_read(*buffer, [this, buffer](boost::beast::error_code ec, std::size_t bytes) {
-        if (!ec) {
-            std::string message((char*)buffer->data().data(), bytes);
-            if (messageHandler) {
-                messageHandler(message);
-            }
-            doRead(); // continue reading next message
-        } else {
-            if (ec != websocket::error::closed) {
-                std::cerr << "Socket read error: " << ec.message() << std::endl;
-            }
-            open = false;
-        }
+    withStream([this](auto& stream) {
+        stream.async_read(readBuffer, [this](boost::beast::error_code ec, std::size_t bytes) { onRead(ec, bytes); });
     });
 }
 
-void Socket::send(const std::string& message) {
-    if (!open) return;
-    // Post send task to I/O context for thread safety
-    boost::asio::post(ioc, [this, message]() {
-        std::lock_guard<std::mutex> lock(writeMutex);
-        boost::beast::error_code ec;
-        ws.write(boost::asio::buffer(message), ec);
-        if (ec) {
-            std::cerr << "Socket send error: " << ec.message() << std::endl;
+void Socket::onRead(boost::beast::error_code ec, std::size_t bytes) {
+    if (!ec) {
+        // Hand the payload over in place; it is consumed once the handler returns
+        if (messageHandler) {
+            messageHandler(std::string_view(static_cast<const char*>(readBuffer.data().data()), bytes), clockNs());
         }
+        readBuffer.consume(bytes);
+        doRead(); // continue reading next message
+    } else {
+        // closed: the server closed; operation_aborted: close() stopped the io thread
+        if (ec != websocket::error::closed && ec != boost::asio::error::operation_aborted) {
+            std::cerr << "Socket read error: " << ec.message() << std::endl;
+        }
+        open = false;
+        if (!closing) notifyDisconnect();
+    }
+}
+
+bool Socket::send(std::string_view message) {
+    if (!open) return false;
+    // Copy into a preallocated slot (the heap only for oversized messages);
+    // no handler is allocated per message
+    if (!writeQueue.push(message, clockNs())) {
+        rejectedCount.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Socket send rejected: write queue full (" << message.size() << " bytes)" << std::endl;
+        return false;
+    }
+    enqueuedCount.fetch_add(1, std::memory_order_relaxed);
+    size_t depth = writeQueue.depth();
+    size_t seen = maxDepth.load(std::memory_order_relaxed);
+    while (depth > seen && !maxDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+    scheduleDrain();
+    return true;
+}
+
+void Socket::scheduleDrain() {
+    // Sends arriving while a drain is pending ride along with it
+    if (drainScheduled.exchange(true, std::memory_order_acq_rel)) return;
+    boost::asio::post(ioc, [this]() {
+        // Clear before draining so a message pushed after the last front() posts again
+        drainScheduled.store(false, std::memory_order_release);
+        if (!writing) doWrite();
+    });
+}
+
+void Socket::doWrite() {
+    WriteQueue::Message msg;
+    if (!writeQueue.front(msg)) {
+        writing = false;
+        return;
+    }
+    // One write in flight at a time; its completion starts the next, so a
+    // burst is written back to back without returning to the queue of handlers
+    writing = true;
+    withStream([&](auto& stream) {
+        stream.async_write(boost::asio::buffer(msg.data, msg.size),
+                           [this, enqueuedNs = msg.enqueuedNs](boost::beast::error_code ec, std::size_t) {
+            onWrite(ec, enqueuedNs);
+        });
     });
 }
 
+void Socket::onWrite(boost::beast::error_code ec, long long enqueuedNs) {
+    writeQueue.pop();
+    if (ec) {
+        failedCount.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Socket send error: " << ec.message() << std::endl;
+    } else {
+        long long latency = clockNs() - enqueuedNs;
+        writtenCount.fetch_add(1, std::memory_order_relaxed);
+        latencySumNs.fetch_add(latency, std::memory_order_relaxed);
+        if (latency > latencyMaxNs.load(std::memory_order_relaxed)) {
+            latencyMaxNs.store(latency, std::memory_order_relaxed);
+        }
+    }
+    doWrite();
+}
+
+Socket::WriteStats Socket::writeStats() const {
+    WriteStats stats;
+    stats.enqueued = enqueuedCount.load(std::memory_order_relaxed);
+    stats.rejected = rejectedCount.load(std::memory_order_relaxed);
+    stats.written = writtenCount.load(std::memory_order_relaxed);
+    stats.failed = failedCount.load(std::memory_order_relaxed);
+    stats.oversized = writeQueue.overflowCount();
+    stats.depth = writeQueue.depth();
+    stats.maxDepth = maxDepth.load(std::memory_order_relaxed);
+    stats.avgLatencyNs = stats.written ? latencySumNs.load(std::memory_order_relaxed) / static_cast<long long>(stats.written) : 0;
+    stats.maxLatencyNs = latencyMaxNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void Socket::close() {
+    closing = true;
     if (!open) {
+        // A spinning io thread does not run out of work on its own
+        ioc.stop();
         if (ioThread.joinable()) ioThread.join();
         return;
     }
     // Signal closure on I/O thread
     boost::asio::post(ioc, [this]() {
         boost::beast::error_code ec;
-        ws.close(websocket::close_code::normal, ec);
+        withStream([&](auto& stream) { stream.close(websocket::close_code::normal, ec); });
     });
     ioc.stop();
     if (ioThread.joinable()) {
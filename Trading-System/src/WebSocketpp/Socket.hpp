@@ -6,28 +6,75 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <boost/beast/ssl.hpp>
+#include <atomic>
+#include <cstdint>
 #include <thread>
-#include <mutex>
+#include "ConnectionCache.hpp"
+#include "WriteQueue.hpp"
 
 class Socket : public BSocket {
 public:
     Socket();
     ~Socket() override;
     bool connect(const std::string& url) override;
-    void send(const std::string& message) override;
+    bool send(std::string_view message) override;
     void close() override;
+
+    // Outgoing queue counters; latency runs from send() to write completion
+    struct WriteStats {
+        uint64_t enqueued;
+        uint64_t rejected;   // queue full
+        uint64_t oversized;  // larger than a queue slot, sent from the heap
+        uint64_t written;
+        uint64_t failed;
+        size_t depth;
+        size_t maxDepth;
+        long long avgLatencyNs;
+        long long maxLatencyNs;
+    };
+    WriteStats writeStats() const;
+
 private:
     void doRead();
-    // Boost Beast WebSocket over TLS
-    using tcp = boost::asio::ip::tcp;
-    namespace websocket = boost::beast::websocket;
-    namespace ssl = boost::asio::ssl;
+    void onRead(boost::beast::error_code ec, std::size_t bytes);
+    // Wake the io thread to drain the write queue, at most once per batch
+    void scheduleDrain();
+    // io thread: write the oldest queued message, then the next on completion
+    void doWrite();
+    void onWrite(boost::beast::error_code ec, long long enqueuedNs);
+    // Run f on the stream connect() chose
+    template<typename F>
+    void withStream(F&& f) {
+        if (secure) {
+            f(ws);
+        } else {
+            f(plainWs);
+        }
+    }
+    // Boost Beast WebSocket over TLS, or plain TCP for ws:// URLs
     boost::asio::io_context ioc;
-    ssl::context sslCtx;
-    websocket::stream<boost::beast::ssl_stream<tcp::socket>> ws;
+    boost::asio::ssl::context sslCtx;
+    boost::beast::websocket::stream<boost::beast::ssl_stream<boost::asio::ip::tcp::socket>> ws;
+    boost::beast::websocket::stream<boost::asio::ip::tcp::socket> plainWs;
+    bool secure = true;
+    // Reused for every read; grows to the largest message seen, then stays
+    boost::beast::flat_buffer readBuffer;
     std::thread ioThread;
-    std::mutex writeMutex;
     bool open;
+    // Set by close(), so the failed read it causes is not reported as a drop
+    std::atomic<bool> closing{false};
+
+    WriteQueue writeQueue;
+    std::atomic<bool> drainScheduled{false};
+    bool writing = false; // io thread only
+    std::atomic<uint64_t> enqueuedCount{0};
+    std::atomic<uint64_t> rejectedCount{0};
+    std::atomic<uint64_t> writtenCount{0};
+    std::atomic<uint64_t> failedCount{0};
+    std::atomic<size_t> maxDepth{0};
+    std::atomic<long long> latencySumNs{0};
+    std::atomic<long long> latencyMaxNs{0};
 };
 
 #endif // WEBSOCKETPP_SOCKET_HPP
\ No newline at end of file
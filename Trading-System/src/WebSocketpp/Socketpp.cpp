@@ -11,18 +11,26 @@ Socketpp::Socketpp() : connected(false) {
     endpoint.set_tls_init_handler([this](websocketpp::connection_hdl) {
         return onTlsInit();
     });
+    // Connected, before the TLS handshake: tune the socket like the other
+    // transports and offer the cached TLS session
+    endpoint.set_socket_init_handler([this](websocketpp::connection_hdl, boost::asio::ssl::stream<boost::asio::ip::tcp::socket>& socket) {
+        tuneSocket(socket.lowest_layer().native_handle(), lowLatency);
+        ConnectionCache::instance().prepareSession(socket.native_handle(), sessionKey);
+    });
     // Message handler
     endpoint.set_message_handler([this](websocketpp::connection_hdl, Client::message_ptr msg) {
         if (messageHandler) {
-            messageHandler(msg->get_payload());
+            messageHandler(msg->get_payload(), clockNs());
         }
     });
     // Open handler
     endpoint.set_open_handler([this](websocketpp::connection_hdl hdl) {
         connHdl = hdl;
+        ConnectionCache::instance().recordHandshake(endpoint.get_con_from_hdl(hdl)->get_socket().native_handle());
         {
             std::lock_guard<std::mutex> lock(connectMutex);
             connected = true;
+            attemptFinished = true;
         }
         connectCond.notify_one();
     });
@@ -30,12 +38,16 @@ Socketpp::Socketpp() : connected(false) {
     endpoint.set_fail_handler([this](websocketpp::connection_hdl) {
         std::lock_guard<std::mutex> lock(connectMutex);
         connected = false;
+        attemptFinished = true;
         connectCond.notify_one();
     });
     // Close handler
     endpoint.set_close_handler([this](websocketpp::connection_hdl) {
-        std::lock_guard<std::mutex> lock(connectMutex);
-        connected = false;
+        {
+            std::lock_guard<std::mutex> lock(connectMutex);
+            connected = false;
+        }
+        if (!closing) notifyDisconnect();
     });
 }
 
@@ -48,6 +60,7 @@ std::shared_ptr<boost::asio::ssl::context> Socketpp::onTlsInit() {
     try {
         ctx->set_options(boost::asio::ssl::context::default_workarounds);
         ctx->set_verify_mode(boost::asio::ssl::verify_none);
+        ConnectionCache::enableResumption(ctx->native_handle());
     } catch (...) {
         std::cerr << "TLS init error\n";
     }
@@ -61,31 +74,51 @@ bool Socketpp::connect(const std::string& url) {
         std::cerr << "Socketpp connection error: " << ec.message() << std::endl;
         return false;
     }
+    sessionKey = con->get_host() + ":" + std::to_string(con->get_port());
+    {
+        std::lock_guard<std::mutex> lock(connectMutex);
+        attemptFinished = false;
+    }
     endpoint.connect(con);
     // Run networking in separate thread
     ioThread = std::thread([this]() {
+        pinThread(lowLatency.ioCpu);
+        if (lowLatency.spin) {
+            // Poll instead of sleeping in the reactor; perpetual mode keeps
+            // the endpoint from stopping between messages until close()
+            endpoint.start_perpetual();
+            SpinWait spin(lowLatency.spinsBeforeYield);
+            while (!endpoint.stopped()) {
+                if (endpoint.poll() == 0) spin.idle();
+            }
+            return;
+        }
         endpoint.run();
     });
-    // Wait for open or fail
+    // Wait for open or fail; a failed attempt returns false, so the caller
+    // (ConnectionManager) can back off and retry
     std::unique_lock<std::mutex> lock(connectMutex);
-    connectCond.wait(lock, [this] { return connected; });
+    connectCond.wait(lock, [this] { return attemptFinished; });
     return connected;
 }
 
-void Socketpp::send(const std::string& message) {
-    if (!connected) return;
-    websocketpp::lib::error_code ec;
+bool Socketpp::send(std::string_view message) {
+    if (!connected) return false;
     // Post the send to the endpoint's io_service to ensure thread safety
-    endpoint.get_io_service()->post([this, message]() {
+    endpoint.get_io_service()->post([this, message = std::string(message)]() {
         websocketpp::lib::error_code e;
         endpoint.send(connHdl, message, websocketpp::frame::opcode::text, e);
         if (e) {
             std::cerr << "Socketpp send error: " << e.message() << std::endl;
         }
     });
+    return true;
 }
 
 void Socketpp::close() {
+    closing = true;
+    // Let a spinning io thread exit once it runs out of work
+    if (lowLatency.spin) endpoint.stop_perpetual();
     if (!connected) {
         if (ioThread.joinable()) ioThread.join();
         return;
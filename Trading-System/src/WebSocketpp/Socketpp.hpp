@@ -2,18 +2,21 @@
 #define WEBSOCKETPP_SOCKETPP_HPP
 
 #include "BSocket.hpp"
+#include "ConnectionCache.hpp"
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/client.hpp>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <string>
 
 class Socketpp : public BSocket {
 public:
     Socketpp();
     ~Socketpp() override;
     bool connect(const std::string& url) override;
-    void send(const std::string& message) override;
+    bool send(std::string_view message) override;
     void close() override;
 private:
     // WebSocket++ client with TLS
@@ -24,6 +27,12 @@ private:
     std::mutex connectMutex;
     std::condition_variable connectCond;
     bool connected;
+    // The open or fail handler ran for the current connect(); guarded by connectMutex
+    bool attemptFinished = false;
+    // Set by close(), so the close handler does not report a drop
+    std::atomic<bool> closing{false};
+    // host:port, for the TLS session cache
+    std::string sessionKey;
 
     // TLS initialization callback
     std::shared_ptr<boost::asio::ssl::context> onTlsInit();
@@ -0,0 +1,101 @@
+#include "Tracer.hpp"
+#include "EventLog.hpp"
+#include "Metrics.hpp"
+#include <charconv>
+#include <cstring>
+
+thread_local const TraceContext* Tracer::active = nullptr;
+
+static_assert((Tracer::CAPACITY & (Tracer::CAPACITY - 1)) == 0, "slots are indexed with a mask");
+
+Tracer::Tracer(Metrics& metrics)
+    : metrics(metrics), openSlots(new OpenSlot[CAPACITY]), fillSlots(new FillSlot[CAPACITY]) {}
+
+size_t Tracer::formatLabel(uint64_t traceId, char* out) {
+    std::memcpy(out, LABEL_PREFIX.data(), LABEL_PREFIX.size());
+    char* end = std::to_chars(out + LABEL_PREFIX.size(), out + LABEL_SIZE, traceId).ptr;
+    return static_cast<size_t>(end - out);
+}
+
+bool Tracer::parseLabel(std::string_view label, uint64_t& traceId) {
+    if (label.substr(0, LABEL_PREFIX.size()) != LABEL_PREFIX) return false;
+    const char* first = label.data() + LABEL_PREFIX.size();
+    const char* last = label.data() + label.size();
+    auto result = std::from_chars(first, last, traceId);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+void Tracer::open(int requestId, const TraceContext& context, long long decidedNs, long long encodedNs, long long sentNs) {
+    OpenSlot& slot = openSlots[static_cast<uint32_t>(requestId) & (CAPACITY - 1)];
+    // Invalidate first, so a close() reading the old trace sees it change
+    slot.requestId.store(-1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.traceId.store(context.traceId, std::memory_order_relaxed);
+    slot.receivedNs.store(context.receivedNs, std::memory_order_relaxed);
+    slot.deliveredNs.store(context.deliveredNs, std::memory_order_relaxed);
+    slot.parsedNs.store(context.parsedNs, std::memory_order_relaxed);
+    slot.appliedNs.store(context.appliedNs, std::memory_order_relaxed);
+    slot.decidedNs.store(decidedNs, std::memory_order_relaxed);
+    slot.encodedNs.store(encodedNs, std::memory_order_relaxed);
+    slot.sentNs.store(sentNs, std::memory_order_relaxed);
+    slot.requestId.store(requestId, std::memory_order_release);
+}
+
+bool Tracer::close(int requestId, long long ackNs, std::string_view orderId, std::string_view orderState) {
+    OpenSlot& slot = openSlots[static_cast<uint32_t>(requestId) & (CAPACITY - 1)];
+    int64_t expected = requestId;
+    if (slot.requestId.load(std::memory_order_acquire) != expected) return false;
+    uint64_t traceId = slot.traceId.load(std::memory_order_relaxed);
+    long long received = slot.receivedNs.load(std::memory_order_relaxed);
+    long long delivered = slot.deliveredNs.load(std::memory_order_relaxed);
+    long long parsed = slot.parsedNs.load(std::memory_order_relaxed);
+    long long applied = slot.appliedNs.load(std::memory_order_relaxed);
+    long long decided = slot.decidedNs.load(std::memory_order_relaxed);
+    long long encoded = slot.encodedNs.load(std::memory_order_relaxed);
+    long long sent = slot.sentNs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Fails if open() reused the slot while we were reading it
+    if (!slot.requestId.compare_exchange_strong(expected, -1, std::memory_order_relaxed)) return false;
+
+    const long long stages[] = {
+        delivered - received, parsed - delivered, applied - parsed, decided - applied,
+        encoded - decided, sent - encoded, ackNs - sent, ackNs - received,
+    };
+    for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); ++i) {
+        metrics.recordTraceStage(static_cast<TraceStage>(i), stages[i]);
+    }
+    if (orderState == "open") {
+        FillSlot& fillSlot = fillSlots[traceId & (CAPACITY - 1)];
+        fillSlot.traceId = traceId;
+        fillSlot.ackNs = ackNs;
+    }
+
+    uint32_t every = sampleEvery.load(std::memory_order_relaxed);
+    if (every != 0 && ++closed % every == 0) {
+        // trace: key: order id; detail: order state; ids: trace id, request id;
+        // values: socket read, parse, book apply, strategy. The trace_stages
+        // record that follows carries encode, send, exchange round trip and
+        // tick-to-ack. All in ns.
+        EventRecord records[2] = {EventRecord(EventType::Trace), EventRecord(EventType::TraceStages)};
+        records[0].count = 1;
+        records[0].ids[0] = traceId;
+        records[0].ids[1] = static_cast<uint64_t>(requestId);
+        EventRecord::setText(records[0].key, orderId);
+        EventRecord::setText(records[0].detail, orderState);
+        for (int i = 0; i < 4; ++i) {
+            records[0].values[i] = static_cast<double>(stages[i]);
+            records[1].values[i] = static_cast<double>(stages[i + 4]);
+        }
+        EventLog::instance().write(records, 2);
+    }
+    return true;
+}
+
+void Tracer::fill(std::string_view label, long long filledNs) {
+    uint64_t traceId;
+    if (!parseLabel(label, traceId)) return;
+    FillSlot& slot = fillSlots[traceId & (CAPACITY - 1)];
+    if (slot.traceId != traceId) return;
+    metrics.recordTraceStage(TraceStage::AckToFill, filledNs - slot.ackNs);
+    slot.traceId = 0;
+}
@@ -0,0 +1,114 @@
+#ifndef WEBSOCKETPP_TRACER_HPP
+#define WEBSOCKETPP_TRACER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+class Metrics;
+
+// Stage boundaries of the book update being handled, on BSocket::clockNs()
+struct TraceContext {
+    uint64_t traceId = 0;
+    long long receivedNs = 0;  // bytes came off the socket (transport stamp)
+    long long deliveredNs = 0; // frame decoded, Api::onMessage entered
+    long long parsedNs = 0;
+    long long appliedNs = 0;   // book updated, strategy about to run
+};
+
+// Durations a closed trace is split into, in pipeline order
+enum class TraceStage : uint8_t {
+    SocketRead,        // received -> delivered
+    Parse,             // delivered -> parsed
+    BookApply,         // parsed -> applied
+    Strategy,          // applied -> order decided (placeOrder entered)
+    Encode,            // decided -> request encoded
+    Send,              // encoded -> handed to the socket
+    ExchangeRoundTrip, // sent -> ack received
+    TickToAck,         // received -> ack received
+    AckToFill,         // ack -> fill notification (user.orders)
+};
+
+constexpr size_t TRACE_STAGES = static_cast<size_t>(TraceStage::AckToFill) + 1;
+
+constexpr const char* traceStageName(TraceStage stage) {
+    switch (stage) {
+    case TraceStage::SocketRead: return "socket_read";
+    case TraceStage::Parse: return "parse";
+    case TraceStage::BookApply: return "book_apply";
+    case TraceStage::Strategy: return "strategy";
+    case TraceStage::Encode: return "encode";
+    case TraceStage::Send: return "send";
+    case TraceStage::ExchangeRoundTrip: return "exchange_round_trip";
+    case TraceStage::TickToAck: return "tick_to_ack";
+    case TraceStage::AckToFill: return "ack_to_fill";
+    }
+    return "unknown";
+}
+
+// Tick-to-trade tracing. Every book update gets a trace id; while the
+// strategy runs on it, Tracer::active points at its context, and orders
+// placed meanwhile are opened here under their request id and labelled
+// "trace-<id>" at the exchange. The ack closes the trace into the stage
+// histograms of Metrics and, for every sampleEvery-th trace, a trace event
+// in the event log; a later fill is matched back through the label.
+//
+// open() may run on any thread; close() and fill() run on the socket
+// thread. An order whose response arrives before open() returns (strategy
+// on another thread) is not traced. Slots are reused CAPACITY requests
+// (or traces) later; a trace still open by then is lost.
+class Tracer {
+public:
+    static constexpr size_t CAPACITY = 1024;
+    static constexpr std::string_view LABEL_PREFIX = "trace-";
+
+    explicit Tracer(Metrics& metrics);
+
+    // Context of the update the strategy is reacting to on this thread
+    static thread_local const TraceContext* active;
+
+    uint64_t nextTraceId() { return traceIds.fetch_add(1, std::memory_order_relaxed); }
+    // Log every n-th closed trace as a trace event (0: none)
+    void setSampleEvery(uint32_t n) { sampleEvery.store(n, std::memory_order_relaxed); }
+
+    void open(int requestId, const TraceContext& context, long long decidedNs, long long encodedNs, long long sentNs);
+    // Order response: record the stages; false if the request was not traced
+    bool close(int requestId, long long ackNs, std::string_view orderId, std::string_view orderState);
+    // user.orders notification for a traced order (label "trace-<id>")
+    void fill(std::string_view label, long long filledNs);
+
+    static constexpr size_t LABEL_SIZE = 32;
+    // Writes "trace-<id>" into out (LABEL_SIZE bytes); returns its length
+    static size_t formatLabel(uint64_t traceId, char* out);
+    static bool parseLabel(std::string_view label, uint64_t& traceId);
+
+private:
+    // Slots share no cache line; the fields are published by the requestId store
+    struct alignas(64) OpenSlot {
+        std::atomic<int64_t> requestId{-1};
+        std::atomic<uint64_t> traceId{0};
+        std::atomic<long long> receivedNs{0};
+        std::atomic<long long> deliveredNs{0};
+        std::atomic<long long> parsedNs{0};
+        std::atomic<long long> appliedNs{0};
+        std::atomic<long long> decidedNs{0};
+        std::atomic<long long> encodedNs{0};
+        std::atomic<long long> sentNs{0};
+    };
+    // Acked orders waiting for a fill (socket thread only)
+    struct FillSlot {
+        uint64_t traceId = 0;
+        long long ackNs = 0;
+    };
+
+    Metrics& metrics;
+    std::atomic<uint64_t> traceIds{1};
+    std::atomic<uint32_t> sampleEvery{0};
+    uint64_t closed = 0; // socket thread only
+    std::unique_ptr<OpenSlot[]> openSlots;
+    std::unique_ptr<FillSlot[]> fillSlots;
+};
+
+#endif // WEBSOCKETPP_TRACER_HPP
@@ -1,9 +1,19 @@
 #include "Trader.hpp"
 #include "Api.hpp"
+#include "FlightRecorder.hpp"
 #include <chrono>
 #include <iostream>
+#include <set>
+#include <algorithm>
 
-Trader::Trader(Api* api) : api(api), running(false) {}
+// "<order id> <state>" into the flight recorder
+static void recordOrderState(const std::string& orderId, const char* state) {
+    if (!FlightRecorder::instance().enabled()) return;
+    FlightRecorder::record(FlightRecordType::OrderState, orderId + " " + state);
+}
+
+Trader::Trader(Api* api, std::vector<InstrumentSpec> instruments)
+    : api(api), instruments(std::move(instruments)), running(false) {}
 
 Trader::~Trader() {
     running = false;
@@ -13,15 +23,31 @@ Trader::~Trader() {
 }
 
 void Trader::start() {
-    // Subscribe to public order book and user orders (private)
-    api->subscribePublic("book.BTC-PERPETUAL.raw");    // high-frequency raw updates
-    api->subscribePrivate("user.orders.BTC-PERPETUAL.raw");
-    // Get initial positions and order book snapshot
-    api->getPositions("BTC");
-    api->getOrderBook("BTC-PERPETUAL");
+    std::set<std::string> currencies;
+    // Books must be registered before their channels start delivering
+    std::vector<InstrumentId> ids = api->addInstruments(instruments);
+    for (size_t i = 0; i < instruments.size(); ++i) {
+        const InstrumentSpec& spec = instruments[i];
+        if (ids[i] == INVALID_INSTRUMENT) {
+            std::cerr << "Cannot track instrument " << spec.name << std::endl;
+            continue;
+        }
+        // Subscribe to public order book and user orders (private)
+        api->subscribePublic("book." + spec.name + ".raw");    // high-frequency raw updates
+        api->subscribePrivate("user.orders." + spec.name + ".raw");
+        // Initial order book snapshot
+        api->getOrderBook(spec.name);
+        // Currency is the instrument prefix, e.g. "BTC" for BTC-PERPETUAL
+        currencies.insert(spec.name.substr(0, spec.name.find('-')));
+    }
+    // Get initial positions
+    for (const auto& currency : currencies) {
+        api->getPositions(currency);
+    }
     // Start monitor thread for stale order cancellation
     running = true;
     monitorThread = std::thread([this]() {
+        pinThread(lowLatency.monitorCpu);
         const int cancelTimeoutSec = 5;
         while (running) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -33,6 +59,7 @@ void Trader::start() {
                     auto age = std::chrono::duration_cast<std::chrono::seconds>(now - it->time).count();
                     if (age >= cancelTimeoutSec) {
                         toCancel.push_back(it->id);
+                        recordOrderState(it->id, "stale");
                         it = openOrders.erase(it);
                     } else {
                         ++it;
@@ -50,37 +77,41 @@ void Trader::start() {
 template<typename OrderBookType>
 void Trader::onOrderBookUpdate(const OrderBookType& book) {
     // Simple strategy: if spread is wide, place buy and sell orders
-    if (book.bids.empty() || book.asks.empty()) {
+    if (!book.hasBids() || !book.hasAsks()) {
         return;
     }
-    double bestBid = book.bids.begin()->first;
-    double bestAsk = book.asks.begin()->first;
-    double spread = bestAsk - bestBid;
-    // Example threshold for placing orders
-    if (spread > 10.0) {
-        // Only place if no current open orders
+    // Compare and price in ticks, so the thresholds suit any instrument
+    int64_t bidTick = book.getBids().bestTick();
+    int64_t askTick = book.getAsks().bestTick();
+    double tickSize = book.getTickSize();
+    double spread = book.bestAsk() - book.bestBid();
+    if (askTick - bidTick > WIDE_SPREAD_TICKS) {
+        // Only place if no current open orders on this instrument
         std::lock_guard<std::mutex> lock(ordersMutex);
-        if (openOrders.empty()) {
-            double buyPrice = bestBid + 0.5;
-            double sellPrice = bestAsk - 0.5;
+        bool hasOpen = std::any_of(openOrders.begin(), openOrders.end(),
+                                   [&](const OpenOrder& o) { return o.instrument == book.id; });
+        if (!hasOpen) {
+            double buyPrice = static_cast<double>(bidTick + QUOTE_OFFSET_TICKS) * tickSize;
+            double sellPrice = static_cast<double>(askTick - QUOTE_OFFSET_TICKS) * tickSize;
             double qty = 10.0;
-            std::cout << "Placing buy at " << buyPrice << " and sell at " << sellPrice 
+            std::cout << "Placing " << book.instrument << " buy at " << buyPrice << " and sell at " << sellPrice 
                       << " (spread " << spread << ")\n";
-            api->placeOrder("BTC-PERPETUAL", "buy", buyPrice, qty);
-            api->placeOrder("BTC-PERPETUAL", "sell", sellPrice, qty);
+            api->placeOrder(book.instrument, "buy", buyPrice, qty);
+            api->placeOrder(book.instrument, "sell", sellPrice, qty);
             // We will add to openOrders when ack is received in onOrderOpen
         }
     }
 }
 
-// Explicitly instantiate template for the expected OrderBook type (map<double,double>)
-template void Trader::onOrderBookUpdate<const Api::OrderBook&>(const Api::OrderBook& book);
+// Explicitly instantiate template for the incremental OrderBook
+template void Trader::onOrderBookUpdate<OrderBook>(const OrderBook& book);
 
-void Trader::onOrderOpen(const std::string& order_id) {
+void Trader::onOrderOpen(const std::string& order_id, InstrumentId instrument) {
     // Record the open order with current time
     std::lock_guard<std::mutex> lock(ordersMutex);
-    OpenOrder o{order_id, std::chrono::steady_clock::now()};
+    OpenOrder o{order_id, std::chrono::steady_clock::now(), instrument};
     openOrders.push_back(o);
+    recordOrderState(order_id, "open");
 }
 
 void Trader::onOrderClosed(const std::string& order_id) {
@@ -88,4 +119,5 @@ void Trader::onOrderClosed(const std::string& order_id) {
     std::lock_guard<std::mutex> lock(ordersMutex);
     openOrders.erase(std::remove_if(openOrders.begin(), openOrders.end(),
                     [&](const OpenOrder& o){ return o.id == order_id; }), openOrders.end());
+    recordOrderState(order_id, "closed");
 }
\ No newline at end of file
@@ -6,15 +6,29 @@
 #include <map>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "BookRegistry.hpp"
+#include "LowLatency.hpp"
+#include "utility.hpp"
 
 class Api; // forward declaration
 
 class Trader {
 public:
-    Trader(Api* api);
+    // Quote both sides when the spread is wider than this many ticks,
+    // improving each side's best price by the offset
+    static constexpr int64_t WIDE_SPREAD_TICKS = 20;
+    static constexpr int64_t QUOTE_OFFSET_TICKS = 1;
+
+    Trader(Api* api, std::vector<InstrumentSpec> instruments = {{DEFAULT_INSTRUMENT, DEFAULT_TICK_SIZE}});
     ~Trader();
 
-    // Start trading logic: subscribe to data and private channels
+    // Strategy and monitor thread pinning; set before start()
+    void setLowLatency(const LowLatencyConfig& config) { lowLatency = config; }
+
+    // Start trading logic: register instruments, subscribe to data and private channels
     void start();
 
     // Callback from Api when order book updates
@@ -22,16 +36,18 @@ public:
     void onOrderBookUpdate(const OrderBookType& book);
 
     // Callback from Api when an order is confirmed open
-    void onOrderOpen(const std::string& order_id);
+    void onOrderOpen(const std::string& order_id, InstrumentId instrument);
     // Callback from Api when an order is closed (filled or cancelled)
     void onOrderClosed(const std::string& order_id);
 
 private:
     Api* api;
+    std::vector<InstrumentSpec> instruments;
     std::thread monitorThread;
+    LowLatencyConfig lowLatency;
     std::atomic<bool> running;
     std::mutex ordersMutex;
-    struct OpenOrder { std::string id; std::chrono::steady_clock::time_point time; };
+    struct OpenOrder { std::string id; std::chrono::steady_clock::time_point time; InstrumentId instrument; };
     std::vector<OpenOrder> openOrders;
 };
 
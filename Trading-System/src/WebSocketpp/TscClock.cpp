@@ -0,0 +1,189 @@
+#include "TscClock.hpp"
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#ifdef TSC_CLOCK_X86
+#include <cpuid.h>
+#endif
+
+std::atomic<bool> TscClock::enabled{false};
+std::atomic<bool> TscClock::started{false};
+std::atomic<uint32_t> TscClock::sequence{0};
+std::atomic<uint64_t> TscClock::baseTicks{0};
+std::atomic<int64_t> TscClock::baseNs{0};
+std::atomic<uint64_t> TscClock::mult{0};
+std::atomic<int64_t> TscClock::wallOffsetNs{0};
+std::atomic<int64_t> TscClock::lastDrift{0};
+
+// A TSC reading and CLOCK_MONOTONIC at the same instant
+struct ClockSample {
+    uint64_t ticks = 0;
+    long long monotonicNs = 0;
+};
+
+class TscCalibrator {
+public:
+    static TscCalibrator& instance() {
+        static TscCalibrator calibrator;
+        return calibrator;
+    }
+
+    ~TscCalibrator() { stop(); }
+
+    bool start(bool useTsc, std::chrono::milliseconds interval);
+    void stop();
+    double ticksPerUs() const {
+        double nsPerTick = rate.load(std::memory_order_relaxed);
+        return nsPerTick > 0 ? 1000.0 / nsPerTick : 0.0;
+    }
+
+private:
+    static constexpr int SAMPLE_TRIES = 16;
+    // Drift above this is stepped over instead of slewed (e.g. after a suspend)
+    static constexpr long long MAX_SLEW_NS = 1'000'000;
+
+    ClockSample sample();
+    static long long sampleWallOffset();
+    void publish(uint64_t ticks, long long ns, double nsPerTick);
+    void recalibrate(std::chrono::milliseconds interval);
+
+    ClockSample first;
+    std::atomic<double> rate{0.0}; // ns per tick, over everything since first
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false; // guarded by mutex
+    std::thread thread;
+};
+
+ClockSample TscCalibrator::sample() {
+    ClockSample best;
+#ifdef TSC_CLOCK_X86
+    // Bracket clock_gettime between two ordered TSC reads and keep the
+    // tightest pair (a preempted try is wide); the midpoint is the reading's
+    // tick count
+    uint64_t bestWidth = UINT64_MAX;
+    unsigned int aux;
+    for (int i = 0; i < SAMPLE_TRIES; ++i) {
+        uint64_t before = __rdtscp(&aux);
+        long long ns = TscClock::monotonicNs();
+        uint64_t after = __rdtscp(&aux);
+        if (after - before < bestWidth) {
+            bestWidth = after - before;
+            best.ticks = before + (after - before) / 2;
+            best.monotonicNs = ns;
+        }
+    }
+#else
+    best.monotonicNs = TscClock::monotonicNs();
+#endif
+    return best;
+}
+
+long long TscCalibrator::sampleWallOffset() {
+    // Same bracketing, on the two kernel clocks
+    long long best = 0;
+    long long bestWidth = -1;
+    for (int i = 0; i < SAMPLE_TRIES; ++i) {
+        long long before = TscClock::monotonicNs();
+        long long wall = TscClock::realtimeNs();
+        long long after = TscClock::monotonicNs();
+        if (bestWidth < 0 || after - before < bestWidth) {
+            bestWidth = after - before;
+            best = wall - (before + (after - before) / 2);
+        }
+    }
+    return best;
+}
+
+void TscCalibrator::publish(uint64_t ticks, long long ns, double nsPerTick) {
+    uint32_t seq = TscClock::sequence.load(std::memory_order_relaxed);
+    TscClock::sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    TscClock::baseTicks.store(ticks, std::memory_order_relaxed);
+    TscClock::baseNs.store(ns, std::memory_order_relaxed);
+    TscClock::mult.store(static_cast<uint64_t>(nsPerTick * 4294967296.0), std::memory_order_relaxed);
+    TscClock::sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool TscCalibrator::start(bool useTsc, std::chrono::milliseconds interval) {
+    if (thread.joinable()) return TscClock::usingTsc();
+    TscClock::wallOffsetNs.store(sampleWallOffset(), std::memory_order_relaxed);
+    TscClock::started.store(true, std::memory_order_release);
+    if (useTsc && TscClock::invariantTsc()) {
+        first = sample();
+        ClockSample second;
+        do {
+            std::this_thread::sleep_for(TscClock::CALIBRATION_WINDOW / 4);
+            second = sample();
+        } while (second.monotonicNs - first.monotonicNs < std::chrono::nanoseconds(TscClock::CALIBRATION_WINDOW).count());
+        double nsPerTick = static_cast<double>(second.monotonicNs - first.monotonicNs) / static_cast<double>(second.ticks - first.ticks);
+        rate.store(nsPerTick, std::memory_order_relaxed);
+        publish(second.ticks, second.monotonicNs, nsPerTick);
+        TscClock::enabled.store(true, std::memory_order_release);
+    } else if (useTsc) {
+        std::cerr << "TscClock: no invariant TSC, using CLOCK_MONOTONIC" << std::endl;
+    }
+    stopping = false;
+    thread = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+            lock.unlock();
+            recalibrate(interval);
+            lock.lock();
+        }
+    });
+    return TscClock::usingTsc();
+}
+
+void TscCalibrator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void TscCalibrator::recalibrate(std::chrono::milliseconds interval) {
+    TscClock::wallOffsetNs.store(sampleWallOffset(), std::memory_order_relaxed);
+    if (!TscClock::usingTsc()) return;
+    ClockSample now = sample();
+    // The longer the window, the better the rate
+    double nsPerTick = static_cast<double>(now.monotonicNs - first.monotonicNs) / static_cast<double>(now.ticks - first.ticks);
+    rate.store(nsPerTick, std::memory_order_relaxed);
+    long long predicted = TscClock::fromTicks(now.ticks);
+    long long drift = now.monotonicNs - predicted;
+    TscClock::lastDrift.store(drift, std::memory_order_relaxed);
+    double intervalNs = static_cast<double>(std::chrono::nanoseconds(interval).count());
+    if (drift > MAX_SLEW_NS || drift < -MAX_SLEW_NS || 2.0 * static_cast<double>(drift < 0 ? -drift : drift) > intervalNs) {
+        publish(now.ticks, now.monotonicNs, nsPerTick);
+        return;
+    }
+    // Slew: continue from the current reading so time never steps back, at
+    // a rate that absorbs the drift over the next interval
+    publish(now.ticks, predicted, nsPerTick * (intervalNs + static_cast<double>(drift)) / intervalNs);
+}
+
+bool TscClock::start(bool useTsc, std::chrono::milliseconds recalibrateEvery) {
+    return TscCalibrator::instance().start(useTsc, recalibrateEvery);
+}
+
+void TscClock::stop() {
+    TscCalibrator::instance().stop();
+}
+
+double TscClock::ticksPerUs() {
+    return TscCalibrator::instance().ticksPerUs();
+}
+
+bool TscClock::invariantTsc() {
+#ifdef TSC_CLOCK_X86
+    unsigned int eax, ebx, ecx, edx;
+    // CPUID 0x80000007: EDX bit 8 is the invariant TSC flag
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
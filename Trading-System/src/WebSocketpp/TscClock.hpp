@@ -0,0 +1,100 @@
+#ifndef WEBSOCKETPP_TSCCLOCK_HPP
+#define WEBSOCKETPP_TSCCLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TSC_CLOCK_X86 1
+#endif
+
+// Hot-path clock: nanoseconds on the CLOCK_MONOTONIC timeline, read from the
+// invariant TSC with one rdtsc and a multiply instead of a clock_gettime
+// call. start() calibrates the tick rate against CLOCK_MONOTONIC and keeps
+// it in line from a background thread; until then, or when the CPU has no
+// invariant TSC (or start() is told not to use it), nowNs() reads
+// CLOCK_MONOTONIC. toWallNs() maps a reading to CLOCK_REALTIME for
+// comparison with exchange timestamps.
+class TscClock {
+public:
+    static long long nowNs() {
+#ifdef TSC_CLOCK_X86
+        if (enabled.load(std::memory_order_relaxed)) return fromTicks(__rdtsc());
+#endif
+        return monotonicNs();
+    }
+    // Like nowNs(), but waits for earlier instructions to finish (rdtscp):
+    // for the end point of a short measured section
+    static long long nowNsOrdered() {
+#ifdef TSC_CLOCK_X86
+        if (enabled.load(std::memory_order_relaxed)) {
+            unsigned int aux;
+            return fromTicks(__rdtscp(&aux));
+        }
+#endif
+        return monotonicNs();
+    }
+    // Wall clock (ns since the Unix epoch) at a nowNs() reading
+    static long long toWallNs(long long ns) {
+        if (!started.load(std::memory_order_acquire)) return ns + realtimeNs() - monotonicNs();
+        return ns + wallOffsetNs.load(std::memory_order_relaxed);
+    }
+
+    // Calibrate (about CALIBRATION_WINDOW of spinning) and start the thread
+    // that corrects drift and tracks the wall clock; returns whether the TSC
+    // is in use
+    static bool start(bool useTsc = true, std::chrono::milliseconds recalibrateEvery = std::chrono::seconds(1));
+    static void stop();
+
+    static bool usingTsc() { return enabled.load(std::memory_order_relaxed); }
+    // True if the CPU reports a constant, non-stop TSC
+    static bool invariantTsc();
+    // Ticks per microsecond, as calibrated
+    static double ticksPerUs();
+    // CLOCK_MONOTONIC minus nowNs() at the last recalibration, before correcting
+    static long long lastDriftNs() { return lastDrift.load(std::memory_order_relaxed); }
+
+    static long long monotonicNs() { return clockNs(CLOCK_MONOTONIC); }
+    static long long realtimeNs() { return clockNs(CLOCK_REALTIME); }
+
+    static constexpr std::chrono::milliseconds CALIBRATION_WINDOW{20};
+
+private:
+    static long long clockNs(clockid_t id) {
+        timespec ts;
+        clock_gettime(id, &ts);
+        return static_cast<long long>(ts.tv_sec) * 1'000'000'000LL + ts.tv_nsec;
+    }
+
+    // ns = baseNs + (ticks - baseTicks) * mult / 2^32. The parameters are
+    // replaced under a sequence lock; readers retry if they raced a write.
+    static long long fromTicks(uint64_t ticks) {
+        uint32_t seq;
+        uint64_t t0, m;
+        int64_t n0;
+        do {
+            seq = sequence.load(std::memory_order_acquire);
+            t0 = baseTicks.load(std::memory_order_relaxed);
+            n0 = baseNs.load(std::memory_order_relaxed);
+            m = mult.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) != 0 || seq != sequence.load(std::memory_order_relaxed));
+        __int128 delta = static_cast<__int128>(static_cast<int64_t>(ticks - t0)) * static_cast<__int128>(m);
+        return n0 + static_cast<long long>(delta >> 32);
+    }
+
+    friend class TscCalibrator;
+
+    static std::atomic<bool> enabled;
+    static std::atomic<bool> started;
+    static std::atomic<uint32_t> sequence;
+    static std::atomic<uint64_t> baseTicks;
+    static std::atomic<int64_t> baseNs;
+    static std::atomic<uint64_t> mult;
+    static std::atomic<int64_t> wallOffsetNs;
+    static std::atomic<int64_t> lastDrift;
+};
+
+#endif // WEBSOCKETPP_TSCCLOCK_HPP
@@ -0,0 +1,72 @@
+#include "WriteQueue.hpp"
+#include <cstring>
+
+WriteQueue::WriteQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask = size - 1;
+}
+
+bool WriteQueue::push(std::string_view message, long long nowNs) {
+    // Rare oversized messages are copied before claiming a slot, so a
+    // failed allocation or a full queue leaves nothing half-published
+    std::unique_ptr<char[]> large;
+    if (message.size() > MAX_MESSAGE_SIZE) {
+        large.reset(new char[message.size()]);
+        std::memcpy(large.get(), message.data(), message.size());
+    }
+    uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[pos & mask];
+        uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0) {
+            // Our turn: claim the position
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // The consumer has not released this slot yet: full
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    if (large) {
+        slot->large = std::move(large);
+        overflows.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::memcpy(slot->data, message.data(), message.size());
+    }
+    slot->size = static_cast<uint32_t>(message.size());
+    slot->enqueuedNs = nowNs;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool WriteQueue::front(Message& out) const {
+    uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+    const Slot& slot = slots[pos & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+    out.data = slot.large ? slot.large.get() : slot.data;
+    out.size = slot.size;
+    out.enqueuedNs = slot.enqueuedNs;
+    return true;
+}
+
+void WriteQueue::pop() {
+    uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+    slots[pos & mask].large.reset();
+    // Hand the slot back to producers one lap later
+    slots[pos & mask].sequence.store(pos + mask + 1, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_relaxed);
+}
+
+size_t WriteQueue::depth() const {
+    uint64_t head = dequeuePos.load(std::memory_order_relaxed);
+    uint64_t tail = enqueuePos.load(std::memory_order_relaxed);
+    return tail > head ? static_cast<size_t>(tail - head) : 0;
+}
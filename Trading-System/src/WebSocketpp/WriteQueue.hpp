@@ -0,0 +1,63 @@
+#ifndef WEBSOCKETPP_WRITEQUEUE_HPP
+#define WEBSOCKETPP_WRITEQUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+// Bounded multi-producer, single-consumer queue of outgoing messages.
+// Messages are copied into preallocated slots, so pushing a message of up
+// to MAX_MESSAGE_SIZE bytes never allocates; a larger one (multi-channel
+// subscribes, long requests) is copied to the heap and its slot points at
+// it. The consumer keeps the front slot until its write has completed.
+// Each slot carries a sequence number that says whose turn it is
+// (producer for position p when it equals p, consumer when it equals p + 1).
+class WriteQueue {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    // Inline slot size: orders, cancels and single subscriptions fit comfortably
+    static constexpr size_t MAX_MESSAGE_SIZE = 2048;
+
+    // A queued message; the data stays valid until pop()
+    struct Message {
+        const char* data;
+        size_t size;
+        long long enqueuedNs;
+    };
+
+    // Capacity is rounded up to a power of two
+    explicit WriteQueue(size_t capacity = DEFAULT_CAPACITY);
+
+    // Any thread; false if the queue is full
+    bool push(std::string_view message, long long nowNs);
+    // Consumer only: peek at the oldest message
+    bool front(Message& out) const;
+    // Consumer only: release the slot returned by front()
+    void pop();
+
+    // Messages queued or in flight (approximate while producers are active)
+    size_t depth() const;
+    // Messages that did not fit a slot and went through the heap
+    uint64_t overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        uint32_t size = 0;
+        long long enqueuedNs = 0;
+        // Heap copy of a message larger than data, freed by pop()
+        std::unique_ptr<char[]> large;
+        char data[MAX_MESSAGE_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<uint64_t> enqueuePos{0};
+    alignas(64) std::atomic<uint64_t> dequeuePos{0};
+    std::atomic<uint64_t> overflows{0};
+};
+
+#endif // WEBSOCKETPP_WRITEQUEUE_HPP
@@ -1,26 +1,121 @@
 #include "../Custom_WebSocket/CSocket.hpp"
 #include "Api.hpp"
+#include "ArbitratedSocket.hpp"
+#include "ConnectionManager.hpp"
+#include "EventLog.hpp"
+#include "FlightRecorder.hpp"
 #include "Trader.hpp"
 #include "Socketpp.hpp"
 #include "Socket.hpp"
+#include "TscClock.hpp"
 #include "utility.hpp"
 #include <iostream>
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
 
-int main() {
+// Transport chosen at startup: csocket (default), beast or socketpp. The
+// io_uring transport stays in the test harnesses (make URING=1) until it
+// has been measured there.
+static BSocket* makeTransport(const char* name) {
+    if (std::strcmp(name, "csocket") == 0) return new CustomWebSocket::CSocket();
+    if (std::strcmp(name, "beast") == 0) return new Socket();
+    if (std::strcmp(name, "socketpp") == 0) return new Socketpp();
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
     try {
-        // ✅ Initialize WebSocket client using Custom WebSocket (Boost.Beast)
-        CSocket wsClient("test.deribit.com", "443");
+        // A peer reset must surface as a send error, not kill the process
+        std::signal(SIGPIPE, SIG_IGN);
+
+        // Latency timestamps come from the TSC, calibrated here; TSC_CLOCK=0
+        // falls back to CLOCK_MONOTONIC
+        const char* tscClock = std::getenv("TSC_CLOCK");
+        bool useTsc = !(tscClock && std::strcmp(tscClock, "0") == 0);
+        if (TscClock::start(useTsc)) {
+            std::cout << "✅ TSC clock at " << TscClock::ticksPerUs() << " ticks/us.\n";
+        }
+
+        // FLIGHT_RECORDER=path keeps the last FLIGHT_RECORDER_MB (64) of raw
+        // traffic and state changes in a mapped ring; it is copied to
+        // path.crash on a crash and to path.<n> on SIGUSR2 (see flight_replay)
+        const char* flightPath = std::getenv("FLIGHT_RECORDER");
+        if (flightPath && *flightPath) {
+            const char* flightMb = std::getenv("FLIGHT_RECORDER_MB");
+            size_t megabytes = flightMb ? std::strtoul(flightMb, nullptr, 10) : 64;
+            if (megabytes == 0) megabytes = 64;
+            if (!FlightRecorder::instance().start(flightPath, megabytes << 20)) return 1;
+            std::cout << "✅ Flight recorder at " << flightPath << ".\n";
+        }
+
+        // Events are written by a background thread: JSON lines on stdout, or
+        // binary records to $EVENT_LOG (convert with eventlog_dump)
+        const char* eventLogPath = std::getenv("EVENT_LOG");
+        if (eventLogPath && *eventLogPath) {
+            if (!EventLog::instance().start(EventLog::Format::Binary, eventLogPath)) return 1;
+        } else {
+            EventLog::instance().start(EventLog::Format::Json);
+        }
+
+        // ✅ Initialize WebSocket client (Api takes ownership)
+        const char* transport = argc > 1 ? argv[1] : "csocket";
+        // Check the name up front; the connection manager builds the transports
+        BSocket* probe = makeTransport(transport);
+        if (!probe) {
+            std::cerr << "❌ Unknown transport: " << transport << "\n";
+            return 1;
+        }
+        delete probe;
+        std::cout << "✅ Using " << transport << " transport.\n";
+        // Market data lines: 1 = a single connection, more = redundant
+        // connections arbitrated on change_id (orders use the first)
+        int lineCount = argc > 2 ? std::atoi(argv[2]) : 1;
+        auto factory = [transport] { return makeTransport(transport); };
+        // Each connection reconnects on its own after a drop; Api resubscribes in onReconnect
+        ConnectionManager* single = nullptr;
+        ArbitratedSocket* arbitrated = nullptr;
+        BSocket* wsClient;
+        if (lineCount > 1) {
+            wsClient = arbitrated = new ArbitratedSocket(factory, lineCount);
+            std::cout << "✅ Arbitrating " << lineCount << " market data lines.\n";
+        } else {
+            wsClient = single = new ConnectionManager(factory);
+        }
+        // Spin/busy-poll and thread pinning from LL_* environment variables
+        LowLatencyConfig lowLatency = LowLatencyConfig::fromEnvironment();
+        wsClient->setLowLatency(lowLatency);
 
         // ✅ Initialize API with WebSocket
-        Api api(&wsClient);
+        Api api(wsClient);
+        ConnectionHandler onReconnect = ConnectionHandler::bind<Api, &Api::onReconnect>(&api);
+        if (arbitrated) {
+            // The other lines keep the books current while the primary reconnects
+            api.setResetBooksOnReconnect(false);
+            arbitrated->setReconnectHandler(onReconnect);
+        } else {
+            single->setReconnectHandler(onReconnect);
+        }
         Trader trader(&api);
+        trader.setLowLatency(lowLatency);
+        // Latency percentiles are logged every $METRICS_INTERVAL_MS (10 s);
+        // LOG_MARKET_UPDATES=1 also logs every book update
+        const char* metricsInterval = std::getenv("METRICS_INTERVAL_MS");
+        std::chrono::milliseconds reportInterval(metricsInterval ? std::atoi(metricsInterval) : 10000);
+        if (reportInterval.count() <= 0) reportInterval = std::chrono::milliseconds(10000);
+        api.setLogMarketUpdates(std::getenv("LOG_MARKET_UPDATES") != nullptr);
+        api.latencyMetrics().startReporting(reportInterval);
+        // TRACE_SAMPLE=n logs every n-th tick-to-trade trace in full
+        if (const char* traceSample = std::getenv("TRACE_SAMPLE")) {
+            api.orderTracer().setSampleEvery(static_cast<uint32_t>(std::atoi(traceSample)));
+        }
 
         // ✅ Connect to Deribit testnet WebSocket
         std::string url = "wss://test.deribit.com/ws/api/v2";
-        if (!wsClient.connect()) {
+        if (!api.connect(url)) {
             std::cerr << "❌ Connection failed, exiting.\n";
             return 1;
         }
@@ -33,16 +128,9 @@ int main() {
             std::this_thread::sleep_for(std::chrono::seconds(1));  // Wait for authentication
         }
 
-        // ✅ Subscribe to order book & trade updates
-        std::string subscribeMessage = R"({
-            "jsonrpc": "2.0",
-            "method": "public/subscribe",
-            "params": {
-                "channels": ["book.BTC-PERP.100ms", "trades.BTC-PERP"]
-            }
-        })";
-
-        wsClient.sendMessage(subscribeMessage);
+        // ✅ Subscribe to order book & trade updates (restored after a reconnect)
+        api.subscribePublic("book.BTC-PERP.100ms");
+        api.subscribePublic("trades.BTC-PERP");
         std::cout << "✅ Subscribed to BTC-PERP market data.\n";
 
         // ✅ Link trader to API and start trading logic
@@ -55,6 +143,23 @@ int main() {
 
         // ✅ Close API connection
         api.close();
+        api.latencyMetrics().stopReporting();
+        api.latencyMetrics().report(reportInterval);
+        if (arbitrated) {
+            std::vector<ArbitratedSocket::LineStats> lines = arbitrated->stats();
+            for (size_t i = 0; i < lines.size(); ++i) {
+                const ArbitratedSocket::LineStats& l = lines[i];
+                std::cout << "{\"event\":\"line_arbitration\",\"line\":" << i << ",\"wins\":" << l.wins
+                          << ",\"duplicates\":" << l.duplicates << ",\"stale\":" << l.stale
+                          << ",\"avg_lead_ns\":" << (l.leadSamples ? l.leadNsTotal / static_cast<long long>(l.leadSamples) : 0)
+                          << ",\"max_lead_ns\":" << l.maxLeadNs << "}" << std::endl;
+            }
+        }
+        EventLog::instance().stop();
+        TscClock::stop();
+        if (EventLog::instance().dropped() > 0) {
+            std::cerr << "⚠️ Event log dropped " << EventLog::instance().dropped() << " events\n";
+        }
 
     } catch (const std::exception& e) {
         std::cerr << "❌ Error in main: " << e.what() << std::endl;
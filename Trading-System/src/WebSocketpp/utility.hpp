@@ -7,5 +7,7 @@
 static std::mutex logMutex;
 
 constexpr const char* DEFAULT_INSTRUMENT = "BTC-PERPETUAL";
+// Minimum price increment of DEFAULT_INSTRUMENT
+constexpr double DEFAULT_TICK_SIZE = 0.5;
 
 #endif // WEBSOCKETPP_UTILITY_HPP
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include "../../src/Custom_WebSocket/CSocket.hpp"
+#include "../../src/WebSocketpp/Socket.hpp"
+#include "../../src/WebSocketpp/ArbitratedSocket.hpp"
+
+// Line arbitration benchmark: local feed servers publish the same book
+// update stream, each with its own delay profile (a base delay, jitter and
+// periodic stalls, like a retransmit holding up one connection). The client
+// subscribes through ArbitratedSocket on line A alone, line B alone, and
+// both; measured is the time from an update's scheduled publish time to its
+// delivery, and every run checks the delivered stream for gaps and
+// duplicates.
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+static constexpr int UPDATES = 20000;
+static constexpr long long INTERVAL_NS = 200'000;
+static constexpr uint64_t FIRST_CHANGE_ID = 63482781000;
+
+// Delay of one line relative to the shared publish schedule
+struct DelayProfile {
+    const char* name;
+    long long baseNs;
+    long long jitterNs;
+    int stallEvery;
+    long long stallNs;
+    unsigned seed;
+    // Update i is never sent when i % skipEvery == skipEvery - 1 (0 = none)
+    int skipEvery;
+};
+
+static const DelayProfile LINE_A = {"a", 20'000, 40'000, 37, 1'500'000, 1, 0};
+static const DelayProfile LINE_B = {"b", 60'000, 40'000, 53, 1'500'000, 2, 0};
+// The fast line loses updates; the complete one trails it by two updates,
+// so the update after each loss arrives before the other line's copy of it
+static const DelayProfile LINE_A_LOSSY = {"a_lossy", 20'000, 40'000, 37, 1'500'000, 1, 101};
+static const DelayProfile LINE_B_SLOW = {"b_slow", 400'000, 40'000, 53, 1'500'000, 2, 0};
+
+// Publish schedule shared by every feed: update i goes out at startNs + i * INTERVAL_NS
+struct Schedule {
+    std::atomic<int> subscribed{0};
+    std::atomic<long long> startNs{0};
+};
+
+static std::string bookUpdate(int i) {
+    uint64_t changeId = FIRST_CHANGE_ID + i;
+    std::string msg = R"({"jsonrpc":"2.0","method":"subscription","params":{"channel":"book.BTC-PERPETUAL.raw","data":{"type":")";
+    msg += i == 0 ? "snapshot" : "change";
+    msg += R"(","timestamp":1718000000123,)";
+    if (i > 0) msg += "\"prev_change_id\":" + std::to_string(changeId - 1) + ",";
+    msg += R"("instrument_name":"BTC-PERPETUAL","change_id":)" + std::to_string(changeId);
+    msg += R"(,"bids":[["change",66990.5,12340.0]],"asks":[["new",67001.0,5000.0]]}}})";
+    return msg;
+}
+
+static uint64_t changeIdOf(std::string_view payload) {
+    constexpr std::string_view key = "\"change_id\":";
+    uint64_t id = 0;
+    size_t pos = payload.find(key);
+    if (pos == std::string_view::npos) return 0;
+    std::from_chars(payload.data() + pos + key.size(), payload.data() + payload.size(), id);
+    return id;
+}
+
+// One plain ws:// feed, serving a single subscriber on its own thread
+class FeedServer {
+public:
+    FeedServer(const DelayProfile& profile, Schedule& schedule)
+        : acceptor(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)), profile(profile), schedule(schedule) {
+        thread = std::thread([this] { run(); });
+    }
+    ~FeedServer() {
+        if (thread.joinable()) thread.join();
+    }
+    std::string url() const { return "ws://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port()) + "/ws/api/v2"; }
+
+private:
+    void run() {
+        try {
+            tcp::socket socket(ioc);
+            acceptor.accept(socket);
+            socket.set_option(tcp::no_delay(true));
+            websocket::stream<tcp::socket> ws(std::move(socket));
+            ws.accept();
+            beast::flat_buffer buffer;
+            ws.read(buffer);
+            ws.text(true);
+            schedule.subscribed.fetch_add(1);
+            long long start;
+            while ((start = schedule.startNs.load()) == 0) std::this_thread::yield();
+
+            std::mt19937 rng(profile.seed);
+            std::uniform_int_distribution<long long> jitter(0, profile.jitterNs);
+            beast::error_code ec;
+            for (int i = 0; i < UPDATES && !ec; ++i) {
+                long long delay = profile.baseNs + jitter(rng);
+                if (i % profile.stallEvery == profile.stallEvery - 1) delay += profile.stallNs;
+                long long due = start + i * INTERVAL_NS + delay;
+                // Sleep most of the way, spin the rest
+                long long wait = due - BSocket::clockNs();
+                if (wait > 100'000) std::this_thread::sleep_for(std::chrono::nanoseconds(wait - 80'000));
+                while (BSocket::clockNs() < due) std::this_thread::yield();
+                if (profile.skipEvery > 0 && i % profile.skipEvery == profile.skipEvery - 1) continue;
+                std::string msg = bookUpdate(i);
+                ws.write(net::buffer(msg), ec);
+            }
+            // Hold the connection until the client closes
+            while (!ec) ws.read(buffer, ec);
+        } catch (const std::exception& e) {
+            std::cerr << "FeedServer error: " << e.what() << std::endl;
+        }
+    }
+
+    net::io_context ioc;
+    tcp::acceptor acceptor;
+    const DelayProfile& profile;
+    Schedule& schedule;
+    std::thread thread;
+};
+
+// Stands in for Api: checks the stream is complete and in order
+struct FeedClient {
+    const Schedule* schedule = nullptr;
+    std::vector<long long> latencies;
+    std::atomic<uint64_t> lastChangeId{0};
+    uint64_t gaps = 0;
+    uint64_t duplicates = 0;
+
+    void onMessage(std::string_view payload, long long receivedNs) {
+        uint64_t id = changeIdOf(payload);
+        if (id == 0) return; // subscribe response
+        uint64_t last = lastChangeId.load(std::memory_order_relaxed);
+        if (id <= last) {
+            // Both lines' initial snapshots are delivered by design
+            if (payload.find("\"snapshot\"") == std::string_view::npos) ++duplicates;
+            return;
+        }
+        if (last != 0 && id != last + 1) ++gaps;
+        long long due = schedule->startNs.load(std::memory_order_relaxed) +
+                        static_cast<long long>(id - FIRST_CHANGE_ID) * INTERVAL_NS;
+        latencies.push_back(receivedNs - due);
+        lastChangeId.store(id, std::memory_order_release);
+    }
+};
+
+static BSocket* makeTransport(const std::string& name) {
+    if (name == "csocket") return new CustomWebSocket::CSocket();
+    if (name == "beast_socket") return new Socket();
+    return nullptr;
+}
+
+// True if every update was delivered once, in order
+static bool runFeeds(const std::string& transport, const std::vector<const DelayProfile*>& profiles) {
+    Schedule schedule;
+    std::vector<std::unique_ptr<FeedServer>> servers;
+    std::vector<std::string> urls;
+    std::string name;
+    for (const DelayProfile* profile : profiles) {
+        servers.push_back(std::make_unique<FeedServer>(*profile, schedule));
+        urls.push_back(servers.back()->url());
+        name += name.empty() ? profile->name : std::string("+") + profile->name;
+    }
+
+    FeedClient client;
+    client.schedule = &schedule;
+    client.latencies.reserve(UPDATES);
+    ArbitratedSocket socket([transport] { return makeTransport(transport); }, urls.size());
+    socket.setMessageHandler(MessageHandler::bind<FeedClient, &FeedClient::onMessage>(&client));
+    if (!socket.connect(urls)) return false;
+    socket.send(R"({"jsonrpc":"2.0","id":1,"method":"public/subscribe","params":{"channels":["book.BTC-PERPETUAL.raw"]}})");
+    while (schedule.subscribed.load() < static_cast<int>(urls.size())) std::this_thread::yield();
+    schedule.startNs.store(BSocket::clockNs() + 5'000'000);
+
+    uint64_t lastId = FIRST_CHANGE_ID + UPDATES - 1;
+    long long deadline = BSocket::clockNs() + 60'000'000'000LL;
+    while (client.lastChangeId.load(std::memory_order_acquire) < lastId && BSocket::clockNs() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Let the losing copies of the last updates arrive before reading the stats
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::vector<ArbitratedSocket::LineStats> lines = socket.stats();
+    socket.close();
+
+    std::vector<long long>& l = client.latencies;
+    std::cout << "{\"event\":\"arbitration_bench_summary\""
+              << ",\"client\":\"" << transport << "\""
+              << ",\"lines\":\"" << name << "\""
+              << ",\"updates\":" << UPDATES
+              << ",\"delivered\":" << l.size()
+              << ",\"gaps\":" << client.gaps
+              << ",\"duplicates\":" << client.duplicates;
+    if (!l.empty()) {
+        std::sort(l.begin(), l.end());
+        long long sum = 0;
+        for (long long v : l) sum += v;
+        std::cout << ",\"avg_ns\":" << sum / static_cast<long long>(l.size())
+                  << ",\"p50_ns\":" << l[l.size() / 2]
+                  << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+                  << ",\"p999_ns\":" << l[l.size() * 999 / 1000]
+                  << ",\"max_ns\":" << l.back();
+    }
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const ArbitratedSocket::LineStats& s = lines[i];
+        std::string prefix = std::string(",\"") + profiles[i]->name + "_";
+        std::cout << prefix << "wins\":" << s.wins
+                  << prefix << "dropped\":" << s.duplicates + s.stale
+                  << prefix << "held\":" << s.held
+                  << prefix << "filled\":" << s.filled
+                  << prefix << "avg_lead_ns\":" << (s.leadSamples ? s.leadNsTotal / static_cast<long long>(s.leadSamples) : 0)
+                  << prefix << "max_lead_ns\":" << s.maxLeadNs;
+    }
+    std::cout << "}" << std::endl;
+    return client.gaps == 0 && client.duplicates == 0 && l.size() == static_cast<size_t>(UPDATES);
+}
+
+int main(int argc, char** argv) {
+    std::string transport = argc > 1 ? argv[1] : "csocket";
+    if (!std::unique_ptr<BSocket>(makeTransport(transport))) {
+        std::cerr << "Unknown transport: " << transport << std::endl;
+        return 1;
+    }
+    runFeeds(transport, {&LINE_A});
+    runFeeds(transport, {&LINE_B});
+    bool ok = runFeeds(transport, {&LINE_A, &LINE_B});
+    // Alone, the lossy line leaves gaps; the trailing line must fill each one
+    runFeeds(transport, {&LINE_A_LOSSY});
+    ok = runFeeds(transport, {&LINE_A_LOSSY, &LINE_B_SLOW}) && ok;
+    return ok ? 0 : 1;
+}
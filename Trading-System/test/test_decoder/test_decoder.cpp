@@ -0,0 +1,129 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <chrono>
+#include <random>
+#include <charconv>
+#include <cstring>
+#include "../../src/WebSocketpp/NumberDecoder.hpp"
+
+// Microbenchmark: NumberDecoder vs std::from_chars on the
+// price/amount arrays of book.X.raw payloads. Every decoded value is also
+// checked bit-for-bit against from_chars.
+
+inline long long nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// A raw-channel snapshot body: [["new",price,amount],...]
+static std::string rawLevels(std::mt19937_64& rng, int levels) {
+    std::uniform_int_distribution<int> amountDist(1, 500000);
+    std::uniform_int_distribution<int> fracDist(0, 9);
+    std::string text = "[";
+    double price = 66990.5;
+    char buf[64];
+    for (int i = 0; i < levels; ++i) {
+        if (i) text += ',';
+        text += "[\"new\",";
+        auto r = std::to_chars(buf, buf + sizeof(buf), price, std::chars_format::fixed, 1);
+        text.append(buf, r.ptr);
+        text += ',';
+        r = std::to_chars(buf, buf + sizeof(buf), amountDist(rng) + fracDist(rng) / 10.0, std::chars_format::fixed, 1);
+        text.append(buf, r.ptr);
+        text += ']';
+        price -= 0.5;
+    }
+    text += "]";
+    return text;
+}
+
+// Offsets of every number in the payload, as the parser would reach them
+static std::vector<size_t> numberOffsets(const std::string& text) {
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == ',' && i + 1 < text.size() && (text[i + 1] == '-' || (text[i + 1] >= '0' && text[i + 1] <= '9'))) {
+            offsets.push_back(i + 1);
+        }
+    }
+    return offsets;
+}
+
+using DecodeFn = const char* (*)(const char*, const char*, double&);
+
+static const char* fromChars(const char* p, const char* end, double& out) {
+    auto result = std::from_chars(p, end, out);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+// Edge cases around the exact-digit limit and the end of the buffer
+static long long checkEdgeCases(DecodeFn decode) {
+    const char* cases[] = {
+        "0", "0.0", "-0.5", "1", "12345678901234", "123456789012345", "1234567890123456",
+        "0.000000000000001", "99999.99999", "66990.5", "1e-5", "2.5E3", "-12345.678",
+        "123456789012345678901234567890", "0.1234567890123456789", "5000.0",
+    };
+    long long mismatches = 0;
+    for (const char* c : cases) {
+        // Followed by more JSON, and ending the buffer
+        for (std::string text : {std::string(c) + ",\"pad\":\"........................................\"", std::string(c)}) {
+            const char* end = text.data() + text.size();
+            double expected = 0.0, actual = 0.0;
+            const char* expectedEnd = fromChars(text.data(), end, expected);
+            const char* actualEnd = decode(text.data(), end, actual);
+            if (expectedEnd != actualEnd || std::memcmp(&expected, &actual, sizeof(double)) != 0) ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+static void runBench(const char* path, DecodeFn decode, const std::string& text,
+                     const std::vector<size_t>& offsets, int iterations) {
+    long long minNs = std::numeric_limits<long long>::max();
+    long long maxNs = 0;
+    long long sumNs = 0;
+    long long mismatches = checkEdgeCases(decode);
+    double sink = 0.0;
+    const char* base = text.data();
+    const char* end = base + text.size();
+    for (size_t offset : offsets) {
+        double expected = 0.0, actual = 0.0;
+        fromChars(base + offset, end, expected);
+        decode(base + offset, end, actual);
+        if (std::memcmp(&expected, &actual, sizeof(double)) != 0) ++mismatches;
+    }
+    for (int i = 0; i < iterations; ++i) {
+        long long start = nowNs();
+        for (size_t offset : offsets) {
+            double value = 0.0;
+            decode(base + offset, end, value);
+            sink += value;
+        }
+        long long elapsed = nowNs() - start;
+        if (elapsed < minNs) minNs = elapsed;
+        if (elapsed > maxNs) maxNs = elapsed;
+        sumNs += elapsed;
+    }
+    std::cout << "{\"event\":\"decoder_bench_summary\""
+              << ",\"path\":\"" << path << "\""
+              << ",\"numbers\":" << offsets.size()
+              << ",\"samples\":" << iterations
+              << ",\"avg_ns\":" << sumNs / iterations
+              << ",\"min_ns\":" << minNs
+              << ",\"max_ns\":" << maxNs
+              << ",\"ns_per_number\":" << static_cast<double>(sumNs) / iterations / offsets.size()
+              << ",\"mismatches\":" << mismatches
+              << ",\"checksum\":" << sink << "}" << std::endl;
+}
+
+int main() {
+    const int iterations = 20000;
+    std::mt19937_64 rng(42);
+    std::string text = rawLevels(rng, 1000);
+    std::vector<size_t> offsets = numberOffsets(text);
+
+    runBench("from_chars", &fromChars, text, offsets, iterations);
+    runBench("number_decoder", &NumberDecoder::decode, text, offsets, iterations);
+    return 0;
+}
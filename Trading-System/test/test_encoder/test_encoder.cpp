@@ -0,0 +1,191 @@
+#include <iostream>
+#include <string>
+#include <limits>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../../src/WebSocketpp/OrderEncoder.hpp"
+
+// Microbenchmark: OrderEncoder templates vs the nlohmann build + dump()
+// previously used by Api::placeOrder/cancelOrder/editOrder. Every encoded
+// request is also parsed back and compared with the DOM-built one.
+
+using json = nlohmann::json;
+
+// Count heap allocations made while encoding
+static std::atomic<long long> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC flags free() on memory from the replaced operator new; they are paired here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+inline long long nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static const std::string INSTRUMENT = "BTC-PERPETUAL";
+static const std::string ORDER_ID = "31085463972";
+static const std::string TOKEN = "1582198456231.1Ml2bJjR.vv4HFu1pZlAcuCn1rTCyhXzQKbQtFOajd8fOrQqXnEqf";
+
+static std::string domOrder(int id, double price, double amount, const std::string& label = "") {
+    json params = {
+        {"instrument_name", INSTRUMENT},
+        {"amount", amount},
+        {"type", "limit"},
+        {"price", price}
+    };
+    params["access_token"] = TOKEN;
+    if (!label.empty()) params["label"] = label;
+    json req = {
+        {"jsonrpc", "2.0"},
+        {"id", id},
+        {"method", "private/buy"},
+        {"params", params}
+    };
+    return req.dump();
+}
+
+static std::string domCancel(int id) {
+    json params = { {"order_id", ORDER_ID} };
+    params["access_token"] = TOKEN;
+    json req = {
+        {"jsonrpc", "2.0"},
+        {"id", id},
+        {"method", "private/cancel"},
+        {"params", params}
+    };
+    return req.dump();
+}
+
+static std::string domEdit(int id, double price, double amount) {
+    json params = {
+        {"order_id", ORDER_ID},
+        {"amount", amount},
+        {"price", price}
+    };
+    params["access_token"] = TOKEN;
+    json req = {
+        {"jsonrpc", "2.0"},
+        {"id", id},
+        {"method", "private/edit"},
+        {"params", params}
+    };
+    return req.dump();
+}
+
+template<typename Encode>
+static void runBench(const char* path, const char* request, int iterations, Encode encode) {
+    long long minNs = std::numeric_limits<long long>::max();
+    long long maxNs = 0;
+    long long sumNs = 0;
+    size_t sink = 0;
+    // Warm up (lets the per-thread buffer reach its working size)
+    for (int i = 0; i < 1000; ++i) sink += encode(i).size();
+    long long allocsBefore = allocationCount.load();
+    for (int i = 0; i < iterations; ++i) {
+        long long start = nowNs();
+        sink += encode(i).size();
+        long long elapsed = nowNs() - start;
+        if (elapsed < minNs) minNs = elapsed;
+        if (elapsed > maxNs) maxNs = elapsed;
+        sumNs += elapsed;
+    }
+    long long allocs = allocationCount.load() - allocsBefore;
+    std::cout << "{\"event\":\"encoder_bench_summary\""
+              << ",\"path\":\"" << path << "\""
+              << ",\"request\":\"" << request << "\""
+              << ",\"samples\":" << iterations
+              << ",\"avg_ns\":" << sumNs / iterations
+              << ",\"min_ns\":" << minNs
+              << ",\"max_ns\":" << maxNs
+              << ",\"allocs_per_msg\":" << static_cast<double>(allocs) / iterations
+              << ",\"bytes\":" << sink << "}" << std::endl;
+}
+
+// Encoded requests must be the same JSON document as the DOM-built ones
+static int checkEquivalence(const OrderEncoder& encoder, InstrumentId instrument) {
+    int mismatches = 0;
+    for (int i = 0; i < 1000; ++i) {
+        double price = 60000.0 + i * 0.5;
+        double amount = 10.0 * (1 + i % 7);
+        if (json::parse(encoder.encodeOrder(instrument, true, i, price, amount)) != json::parse(domOrder(i, price, amount))) ++mismatches;
+        std::string label = "trace-" + std::to_string(i);
+        if (json::parse(encoder.encodeOrder(instrument, true, i, price, amount, label)) != json::parse(domOrder(i, price, amount, label))) ++mismatches;
+        if (json::parse(encoder.encodeCancel(i, ORDER_ID)) != json::parse(domCancel(i))) ++mismatches;
+        if (json::parse(encoder.encodeEdit(i, ORDER_ID, price, amount)) != json::parse(domEdit(i, price, amount))) ++mismatches;
+    }
+    return mismatches;
+}
+
+// Encode on one thread while another keeps publishing new template sets
+// (token changes, instrument batches); every request must come out whole,
+// with one of the tokens, while the replaced sets are freed under it
+static int checkRepublish(OrderEncoder& encoder, InstrumentId instrument) {
+    const std::string otherToken = TOKEN + "-renewed";
+    std::atomic<bool> done{false};
+    std::atomic<int> encoded{0};
+    int mismatches = 0;
+    std::thread reader([&] {
+        for (int i = 0; !done.load(std::memory_order_relaxed); ++i) {
+            json req = json::parse(encoder.encodeOrder(instrument, true, i, 66980.5, 10.0), nullptr, false);
+            std::string token = req.is_discarded() ? "" : req["params"].value("access_token", "");
+            if (token != TOKEN && token != otherToken) ++mismatches;
+            encoded.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        encoder.setAccessToken(i % 2 ? TOKEN : otherToken);
+        if (i % 100 == 0) {
+            std::vector<std::pair<InstrumentId, std::string>> batch;
+            for (int k = 0; k < 8; ++k) batch.emplace_back(1 + i / 100 * 8 + k, "ETH-" + std::to_string(i + k));
+            encoder.addInstruments(batch);
+        }
+        if (i % 16 == 0) std::this_thread::yield();
+    }
+    encoder.setAccessToken(TOKEN);
+    done = true;
+    reader.join();
+    std::cout << "{\"event\":\"encoder_republish\",\"publishes\":2000,\"encoded\":" << encoded.load()
+              << ",\"mismatches\":" << mismatches << "}" << std::endl;
+    return mismatches;
+}
+
+int main() {
+    const int iterations = 200000;
+    OrderEncoder encoder;
+    InstrumentId instrument = 0;
+    encoder.addInstrument(instrument, INSTRUMENT);
+    encoder.setAccessToken(TOKEN);
+
+    int mismatches = checkEquivalence(encoder, instrument);
+    std::cout << "{\"event\":\"encoder_check\",\"mismatches\":" << mismatches << "}" << std::endl;
+    mismatches += checkRepublish(encoder, instrument);
+
+    runBench("nlohmann_dom", "order", iterations,
+             [](int i) { return domOrder(i, 66980.5 + (i & 15) * 0.5, 10.0); });
+    runBench("order_encoder", "order", iterations,
+             [&](int i) { return encoder.encodeOrder(instrument, true, i, 66980.5 + (i & 15) * 0.5, 10.0); });
+    runBench("nlohmann_dom", "cancel", iterations,
+             [](int i) { return domCancel(i); });
+    runBench("order_encoder", "cancel", iterations,
+             [&](int i) { return encoder.encodeCancel(i, ORDER_ID); });
+    runBench("nlohmann_dom", "edit", iterations,
+             [](int i) { return domEdit(i, 66980.5 + (i & 15) * 0.5, 20.0); });
+    runBench("order_encoder", "edit", iterations,
+             [&](int i) { return encoder.encodeEdit(i, ORDER_ID, 66980.5 + (i & 15) * 0.5, 20.0); });
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include "../../src/WebSocketpp/EventLog.hpp"
+
+// Event log benchmark. First checks that every event kind written to a
+// binary log comes back from formatEvent() exactly as Api used to print it,
+// then compares the hot-path cost of one market_update: the old way (build
+// a json, dump it, lock, write with std::endl) against EventLog::log with
+// the background writer producing the same JSON, or binary records.
+
+using json = nlohmann::json;
+
+static std::mutex logMutex;
+
+inline long long nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Sample {
+    EventRecord record;
+    json expected;
+};
+
+static std::vector<Sample> sampleEvents() {
+    std::vector<Sample> samples;
+    auto add = [&](EventRecord r, json j) { samples.push_back({r, j}); };
+
+    EventRecord market(EventType::MarketUpdate);
+    EventRecord::setText(market.key, "book.BTC-PERPETUAL.100ms");
+    market.values[0] = 3;
+    market.values[1] = 0.012;
+    market.values[2] = 66990.5;
+    market.values[3] = 67001.0;
+    market.flags = EventRecord::HasBestBid | EventRecord::HasBestAsk;
+    add(market, {{"event", "market_update"}, {"channel", "book.BTC-PERPETUAL.100ms"}, {"propagation_ms", 3},
+                 {"process_ms", 0.012}, {"best_bid", 66990.5}, {"best_ask", 67001.0}});
+
+    EventRecord oneSided(EventType::MarketUpdate);
+    EventRecord::setText(oneSided.key, "book.ETH-PERPETUAL.raw");
+    oneSided.values[1] = 0.004;
+    oneSided.values[3] = 3500.25;
+    oneSided.flags = EventRecord::HasBestAsk;
+    add(oneSided, {{"event", "market_update"}, {"channel", "book.ETH-PERPETUAL.raw"}, {"propagation_ms", 0},
+                   {"process_ms", 0.004}, {"best_ask", 3500.25}});
+
+    EventRecord update(EventType::OrderUpdate);
+    EventRecord::setText(update.key, "ETH-349224563");
+    EventRecord::setText(update.detail, "filled");
+    update.values[0] = 40.0;
+    update.flags = EventRecord::HasFilled;
+    add(update, {{"event", "order_update"}, {"order_id", "ETH-349224563"}, {"order_state", "filled"}, {"filled_amount", 40.0}});
+
+    EventRecord error(EventType::Error);
+    EventRecord::setText(error.detail, "order");
+    error.ids[0] = static_cast<uint64_t>(int64_t{-32602});
+    EventRecord::setText(error.key, "Invalid params");
+    add(error, {{"event", "error"}, {"type", "order"}, {"details", R"({"code":-32602,"message":"Invalid params"})"}});
+
+    EventRecord auth(EventType::AuthSuccess);
+    auth.values[0] = 12.5;
+    add(auth, {{"event", "auth_success"}, {"latency_ms", 12.5}});
+    add(EventRecord(EventType::AuthFailed), {{"event", "auth_failed"}});
+
+    EventRecord ack(EventType::OrderAck);
+    EventRecord::setText(ack.key, "ETH-349224564");
+    EventRecord::setText(ack.detail, "open");
+    ack.values[0] = 1.75;
+    ack.values[1] = 2.25;
+    ack.flags = EventRecord::HasLoopLatency;
+    add(ack, {{"event", "order_ack"}, {"order_id", "ETH-349224564"}, {"order_state", "open"}, {"latency_ms", 1.75},
+              {"trading_loop_latency_ms", 2.25}});
+
+    for (EventType type : {EventType::CancelAck, EventType::EditAck, EventType::SubscribeAck}) {
+        EventRecord r(type);
+        r.values[0] = 0.5;
+        const char* name = type == EventType::CancelAck ? "cancel_ack" : type == EventType::EditAck ? "edit_ack" : "subscribe_ack";
+        add(r, {{"event", name}, {"latency_ms", 0.5}});
+    }
+
+    EventRecord snapshot(EventType::OrderBookSnapshot);
+    EventRecord::setText(snapshot.key, "BTC-PERPETUAL");
+    snapshot.values[0] = 4.0;
+    snapshot.values[1] = 66990.5;
+    snapshot.flags = EventRecord::HasBestBid;
+    add(snapshot, {{"event", "order_book_snapshot"}, {"instrument", "BTC-PERPETUAL"}, {"latency_ms", 4.0}, {"best_bid", 66990.5}});
+
+    EventRecord gap(EventType::BookGap);
+    EventRecord::setText(gap.key, "BTC-PERPETUAL");
+    gap.ids[0] = 63482781091;
+    gap.ids[1] = 63482781095;
+    add(gap, {{"event", "book_gap"}, {"instrument", "BTC-PERPETUAL"}, {"change_id", 63482781091ULL}, {"prev_change_id", 63482781095ULL}});
+
+    EventRecord resync(EventType::BookResync);
+    EventRecord::setText(resync.key, "BTC-PERPETUAL");
+    resync.ids[0] = 63482781099;
+    add(resync, {{"event", "book_resync"}, {"instrument", "BTC-PERPETUAL"}, {"change_id", 63482781099ULL}});
+
+    EventRecord reconnected(EventType::Reconnected);
+    reconnected.ids[0] = 2;
+    reconnected.ids[1] = 1;
+    add(reconnected, {{"event", "reconnected"}, {"public_channels", 2}, {"private_channels", 1}});
+
+    EventRecord latency(EventType::LatencySnapshot);
+    EventRecord::setText(latency.key, "process.book.BTC-PERPETUAL");
+    latency.count = 10000;
+    latency.ids[0] = 98213;
+    latency.ids[1] = 412345;
+    latency.values[0] = 8191;
+    latency.values[1] = 12287;
+    latency.values[2] = 40959;
+    latency.values[3] = 131071;
+    add(latency, {{"event", "latency_snapshot"}, {"metric", "process.book.BTC-PERPETUAL"}, {"interval_ms", 10000}, {"count", 98213},
+                  {"p50_ns", 8191}, {"p90_ns", 12287}, {"p99_ns", 40959}, {"p999_ns", 131071}, {"max_ns", 412345}});
+    return samples;
+}
+
+// Positions are a snapshot record followed by one record per position
+static json logPositions(double latency, const std::vector<std::pair<std::string, double>>& positions) {
+    std::vector<EventRecord> records(1 + positions.size(), EventRecord(EventType::PositionsSnapshot));
+    records[0].values[0] = latency;
+    records[0].count = static_cast<uint32_t>(positions.size());
+    json expected = {{"event", "positions_snapshot"}, {"latency_ms", latency}};
+    for (size_t i = 0; i < positions.size(); ++i) {
+        records[i + 1].type = EventType::Position;
+        EventRecord::setText(records[i + 1].key, positions[i].first);
+        records[i + 1].values[0] = positions[i].second;
+        records[i + 1].values[1] = 100.0 * (i + 1);
+        expected["positions"].push_back({{"instrument", positions[i].first}, {"size", positions[i].second}, {"avg_price", 100.0 * (i + 1)}});
+    }
+    EventLog::instance().write(records.data(), records.size());
+    return expected;
+}
+
+static bool roundTrip(const std::string& path) {
+    EventLog& log = EventLog::instance();
+    if (!log.start(EventLog::Format::Binary, path)) return false;
+    std::vector<std::string> expected;
+    for (const Sample& s : sampleEvents()) {
+        EventLog::log(s.record);
+        expected.push_back(s.expected.dump());
+    }
+    expected.push_back(logPositions(3.5, {{"BTC-PERPETUAL", 1000.0}, {"ETH-PERPETUAL", -20.0}}).dump());
+    expected.push_back(logPositions(1.0, {}).dump());
+    log.stop();
+
+    std::vector<EventRecord> records;
+    if (!EventLog::readFile(path, records)) return false;
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < records.size();) {
+        std::string line;
+        size_t consumed = formatEvent(records.data() + i, records.size() - i, line);
+        i += consumed ? consumed : 1;
+        line.pop_back();
+        lines.push_back(line);
+    }
+    size_t mismatches = 0;
+    for (size_t i = 0; i < std::max(lines.size(), expected.size()); ++i) {
+        std::string got = i < lines.size() ? lines[i] : "<missing>";
+        std::string want = i < expected.size() ? expected[i] : "<extra>";
+        if (got != want) {
+            ++mismatches;
+            std::cerr << "mismatch: " << got << " != " << want << std::endl;
+        }
+    }
+    std::cout << "{\"event\":\"eventlog_roundtrip\",\"events\":" << expected.size() << ",\"records\":" << records.size()
+              << ",\"mismatches\":" << mismatches << "}" << std::endl;
+    return mismatches == 0;
+}
+
+static void report(const char* mode, std::vector<long long>& l, uint64_t dropped) {
+    std::sort(l.begin(), l.end());
+    long long sum = 0;
+    for (long long v : l) sum += v;
+    std::cout << "{\"event\":\"eventlog_bench_summary\",\"mode\":\"" << mode << "\""
+              << ",\"samples\":" << l.size()
+              << ",\"avg_ns\":" << sum / static_cast<long long>(l.size())
+              << ",\"p50_ns\":" << l[l.size() / 2]
+              << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+              << ",\"p999_ns\":" << l[l.size() * 999 / 1000]
+              << ",\"max_ns\":" << l.back()
+              << ",\"dropped\":" << dropped << "}" << std::endl;
+}
+
+// Bursts well under a ring's capacity, with time for the writer to drain
+// (and, on a single core, format) each one in between
+static constexpr int BURSTS = 200;
+static constexpr int BURST_SIZE = 1000;
+static constexpr auto BURST_GAP = std::chrono::milliseconds(6);
+
+static void runRing(const char* mode, EventLog::Format format, const std::string& path, std::vector<long long>& latencies) {
+    EventLog& log = EventLog::instance();
+    uint64_t droppedBefore = log.dropped();
+    log.start(format, path);
+    latencies.clear();
+    for (int b = 0; b < BURSTS; ++b) {
+        for (int i = 0; i < BURST_SIZE; ++i) {
+            long long start = nowNs();
+            EventRecord logEvent(EventType::MarketUpdate);
+            EventRecord::setText(logEvent.key, "book.BTC-PERPETUAL.100ms");
+            logEvent.values[0] = 3;
+            logEvent.values[1] = 0.012;
+            logEvent.values[2] = 66990.5 + i;
+            logEvent.values[3] = 67001.0 + i;
+            logEvent.flags = EventRecord::HasBestBid | EventRecord::HasBestAsk;
+            EventLog::log(logEvent);
+            latencies.push_back(nowNs() - start);
+        }
+        std::this_thread::sleep_for(BURST_GAP);
+    }
+    log.stop();
+    report(mode, latencies, log.dropped() - droppedBefore);
+}
+
+int main() {
+    if (!roundTrip("/tmp/test_eventlog.bin")) return 1;
+
+    std::ofstream devNull("/dev/null");
+    std::streambuf* console = std::cout.rdbuf();
+    std::vector<long long> latencies;
+    latencies.reserve(BURSTS * BURST_SIZE);
+
+    // Old path: what Api::logJsonEvent did on the reader thread
+    std::cout.rdbuf(devNull.rdbuf());
+    for (int b = 0; b < BURSTS; ++b) {
+        for (int i = 0; i < BURST_SIZE; ++i) {
+            long long start = nowNs();
+            json logEvent = {
+                {"event", "market_update"},
+                {"channel", "book.BTC-PERPETUAL.100ms"},
+                {"propagation_ms", 3},
+                {"process_ms", 0.012}
+            };
+            logEvent["best_bid"] = 66990.5 + i;
+            logEvent["best_ask"] = 67001.0 + i;
+            {
+                std::lock_guard<std::mutex> lock(logMutex);
+                std::cout << logEvent.dump() << std::endl;
+            }
+            latencies.push_back(nowNs() - start);
+        }
+        std::this_thread::sleep_for(BURST_GAP);
+    }
+    std::cout.rdbuf(console);
+    report("json_inline", latencies, 0);
+
+    // New path: fill a record, copy it into this thread's ring
+    runRing("eventlog_json", EventLog::Format::Json, "/dev/null", latencies);
+    runRing("eventlog_binary", EventLog::Format::Binary, "/tmp/test_eventlog_bench.bin", latencies);
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <csignal>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+#include "../../src/WebSocketpp/Api.hpp"
+#include "../../src/WebSocketpp/FlightRecorder.hpp"
+#include "../../src/WebSocketpp/Trader.hpp"
+
+// Flight recorder check and benchmark.
+//  - wrap: a small ring overwritten many times reads back as an exact
+//    suffix of what was recorded, multi-slot entries included
+//  - dumps: SIGUSR2 writes a snapshot; a child that abort()s leaves a
+//    .crash dump holding its last entries
+//  - cost: record() of a typical book frame, recorder off and on
+//  - replay: a session driven through Api and the default Trader (book
+//    deltas, acks, fills) is recorded, then its inbound frames are fed to
+//    a fresh Api; the books and the orders sent must come out the same
+
+using json = nlohmann::json;
+
+static constexpr int ROUNDS = 3000;
+// Registered alongside the traded instrument; its tick must read back exactly
+static const InstrumentSpec FINE_TICK_INSTRUMENT{"SHIB-PERPETUAL", 0.0000001};
+static constexpr int COST_RECORDS = 1'000'000;
+static const std::string BASE = "/tmp/test_flightrecorder";
+
+// Captures what Api sends
+class CaptureSocket : public BSocket {
+public:
+    std::vector<std::string> sent;
+
+    bool connect(const std::string&) override { return true; }
+    bool send(std::string_view message) override {
+        sent.emplace_back(message);
+        return true;
+    }
+    void close() override {}
+};
+
+static std::string entryText(int i) {
+    // 1 to 4 slots, so entries straddle the ring's end
+    return "entry-" + std::to_string(i) + "-" + std::string(static_cast<size_t>(i * 37 % 700), 'x');
+}
+
+static bool checkWrap() {
+    const std::string path = BASE + ".wrap";
+    FlightRecorder& recorder = FlightRecorder::instance();
+    if (!recorder.start(path, 1024 * FlightRecorder::SLOT_SIZE)) return false;
+    const int count = 20000;
+    for (int i = 0; i < count; ++i) FlightRecorder::record(FlightRecordType::Note, entryText(i));
+    recorder.stop();
+    std::vector<FlightEntry> entries;
+    bool ok = FlightRecorder::readFile(path, entries) && !entries.empty();
+    // The survivors are the newest entries, in order and intact
+    size_t mismatches = 0;
+    int first = count - static_cast<int>(entries.size());
+    for (size_t i = 0; ok && i < entries.size(); ++i) {
+        mismatches += entries[i].data != entryText(first + static_cast<int>(i));
+    }
+    std::cout << "{\"event\":\"flight_wrap\",\"recorded\":" << count << ",\"read_back\":" << entries.size()
+              << ",\"mismatches\":" << mismatches << "}" << std::endl;
+    return ok && mismatches == 0 && entries.size() > 200;
+}
+
+static bool checkDumps() {
+    const std::string path = BASE + ".dumps";
+    ::unlink((path + ".1").c_str());
+    ::unlink((path + ".crash").c_str());
+    FlightRecorder& recorder = FlightRecorder::instance();
+    if (!recorder.start(path, 1 << 20)) return false;
+    FlightRecorder::record(FlightRecordType::Note, "before signal");
+    ::raise(SIGUSR2);
+    recorder.stop();
+    std::vector<FlightEntry> snapshot;
+    bool snapshotOk = FlightRecorder::readFile(path + ".1", snapshot) && snapshot.size() == 1 &&
+                      snapshot[0].data == "before signal";
+    struct stat info;
+    bool privateFile = ::stat((path + ".1").c_str(), &info) == 0 && (info.st_mode & 0777) == 0600;
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        FlightRecorder::instance().start(path, 1 << 20);
+        for (int i = 0; i < 1000; ++i) FlightRecorder::record(FlightRecordType::Note, "step " + std::to_string(i));
+        std::abort();
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    std::vector<FlightEntry> crash;
+    bool crashOk = WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT &&
+                   FlightRecorder::readFile(path + ".crash", crash) && crash.size() == 1000 &&
+                   crash.back().data == "step 999";
+    std::cout << "{\"event\":\"flight_dumps\",\"sigusr2_entries\":" << snapshot.size() << ",\"mode_0600\":"
+              << (privateFile ? "true" : "false") << ",\"child_aborted\":"
+              << (WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT ? "true" : "false")
+              << ",\"crash_entries\":" << crash.size() << "}" << std::endl;
+    return snapshotOk && privateFile && crashOk;
+}
+
+static std::string bookFrame(int round) {
+    json bids = json::array(), asks = json::array();
+    if (round == 0) {
+        for (int i = 0; i < 20; ++i) {
+            bids.push_back(json::array({"new", 66980.0 - i, 100.0 + i}));
+            asks.push_back(json::array({"new", 67000.0 + i, 100.0 + i}));
+        }
+    } else {
+        // Walk the top of book in and out, so the strategy re-quotes
+        double offset = (round % 17) * 0.5;
+        bids.push_back(json::array({"new", 66980.0 + offset, 10.0 + round % 5}));
+        asks.push_back(json::array({"new", 67000.0 - offset, 10.0 + round % 7}));
+        bids.push_back(json::array({"delete", 66980.0 + ((round + 8) % 17) * 0.5, 0.0}));
+        asks.push_back(json::array({"delete", 67000.0 - ((round + 8) % 17) * 0.5, 0.0}));
+    }
+    json data = {{"type", round == 0 ? "snapshot" : "change"}, {"timestamp", 1700000000000LL + round},
+                 {"instrument_name", DEFAULT_INSTRUMENT}, {"change_id", round + 1}, {"bids", bids}, {"asks", asks}};
+    if (round > 0) data["prev_change_id"] = round;
+    json msg = {{"jsonrpc", "2.0"}, {"method", "subscription"},
+                {"params", {{"channel", std::string("book.") + DEFAULT_INSTRUMENT + ".raw"}, {"data", data}}}};
+    return msg.dump();
+}
+
+static size_t countOrders(const std::vector<std::string>& sent) {
+    size_t orders = 0;
+    for (const std::string& request : sent) {
+        orders += request.find("\"private/buy\"") != std::string::npos || request.find("\"private/sell\"") != std::string::npos;
+    }
+    return orders;
+}
+
+struct BookState {
+    bool hasBid = false, hasAsk = false;
+    double bid = 0, ask = 0;
+    uint64_t changeId = 0;
+    bool operator==(const BookState& o) const {
+        return hasBid == o.hasBid && hasAsk == o.hasAsk && bid == o.bid && ask == o.ask && changeId == o.changeId;
+    }
+};
+
+static BookState bookState(const Api& api) {
+    BookState state;
+    const OrderBook* book = api.findBook(DEFAULT_INSTRUMENT);
+    if (!book) return state;
+    state.hasBid = book->hasBids();
+    state.hasAsk = book->hasAsks();
+    if (state.hasBid) state.bid = book->bestBid();
+    if (state.hasAsk) state.ask = book->bestAsk();
+    state.changeId = book->changeId;
+    return state;
+}
+
+static bool checkReplay() {
+    const std::string path = BASE + ".session";
+    const std::string dumpPath = BASE + ".session.dump";
+    if (!FlightRecorder::instance().start(path)) return false;
+
+    BookState live;
+    size_t liveOrders = 0;
+    std::ostringstream quotes;
+    std::streambuf* console = std::cout.rdbuf(quotes.rdbuf());
+    {
+        auto* socket = new CaptureSocket();
+        Api api(socket);
+        Trader trader(&api);
+        api.setTrader(&trader);
+        trader.start();
+        api.addInstrument(FINE_TICK_INSTRUMENT);
+        for (int round = 0; round < ROUNDS; ++round) {
+            size_t first = socket->sent.size();
+            api.onMessage(bookFrame(round), BSocket::clockNs());
+            for (size_t i = first; i < socket->sent.size(); ++i) {
+                json req = json::parse(socket->sent[i]);
+                std::string method = req.value("method", "");
+                if (method != "private/buy" && method != "private/sell") continue;
+                int id = req["id"].get<int>();
+                std::string orderId = "ETH-" + std::to_string(id);
+                json ack = {{"jsonrpc", "2.0"}, {"id", id},
+                            {"result", {{"order", {{"order_id", orderId}, {"order_state", "open"}}}, {"trades", json::array()}}}};
+                api.onMessage(ack.dump(), BSocket::clockNs());
+                // The quotes fill at once, so the strategy quotes again on the next wide spread
+                json fill = {{"jsonrpc", "2.0"}, {"method", "subscription"},
+                             {"params", {{"channel", std::string("user.orders.") + DEFAULT_INSTRUMENT + ".raw"},
+                                         {"data", {{"order_id", orderId}, {"order_state", "filled"}}}}}};
+                api.onMessage(fill.dump(), BSocket::clockNs());
+            }
+        }
+        live = bookState(api);
+        liveOrders = countOrders(socket->sent);
+    }
+    FlightRecorder::instance().dump(dumpPath.c_str());
+    FlightRecorder::instance().stop();
+
+    // Replay the dump into a fresh session
+    std::vector<FlightEntry> entries;
+    if (!FlightRecorder::readFile(dumpPath, entries)) {
+        std::cout.rdbuf(console);
+        return false;
+    }
+    BookState replayed;
+    size_t replayedOrders = 0, inbound = 0;
+    bool ticksExact = false;
+    std::map<FlightRecordType, size_t> kinds;
+    {
+        auto* socket = new CaptureSocket();
+        Api api(socket);
+        Trader trader(&api);
+        api.setTrader(&trader);
+        for (const FlightEntry& e : entries) {
+            ++kinds[e.type];
+            if (e.type == FlightRecordType::InstrumentAdded) {
+                std::istringstream in(e.data);
+                InstrumentSpec spec{"", 0.0};
+                if (in >> spec.name >> spec.tickSize) api.addInstrument(spec);
+                if (spec.name == FINE_TICK_INSTRUMENT.name) ticksExact = spec.tickSize == FINE_TICK_INSTRUMENT.tickSize;
+            } else if (e.type == FlightRecordType::Outbound) {
+                api.trackRequest(e.data);
+            } else if (e.type == FlightRecordType::Inbound) {
+                api.onMessage(e.data, BSocket::clockNs());
+                ++inbound;
+            }
+        }
+        replayed = bookState(api);
+        replayedOrders = countOrders(socket->sent);
+    }
+    std::cout.rdbuf(console);
+    bool ok = inbound > static_cast<size_t>(ROUNDS) && replayed == live && replayedOrders == liveOrders && ticksExact &&
+              kinds[FlightRecordType::BookApply] == static_cast<size_t>(ROUNDS) && kinds[FlightRecordType::OrderState] == 2 * liveOrders && liveOrders > 0;
+    std::cout << "{\"event\":\"flight_replay\",\"entries\":" << entries.size() << ",\"inbound\":" << inbound
+              << ",\"book_applies\":" << kinds[FlightRecordType::BookApply] << ",\"order_states\":"
+              << kinds[FlightRecordType::OrderState] << ",\"live_orders\":" << liveOrders << ",\"replayed_orders\":"
+              << replayedOrders << ",\"books_match\":" << (replayed == live ? "true" : "false")
+              << ",\"ticks_exact\":" << (ticksExact ? "true" : "false") << "}" << std::endl;
+    return ok;
+}
+
+static double recordCostNs(const std::string& frame) {
+    long long start = BSocket::clockNs();
+    for (int i = 0; i < COST_RECORDS; ++i) FlightRecorder::record(FlightRecordType::Inbound, frame);
+    return static_cast<double>(BSocket::clockNs() - start) / COST_RECORDS;
+}
+
+int main() {
+    TscClock::start();
+    bool ok = checkWrap();
+    ok = checkDumps() && ok;
+
+    std::string frame = bookFrame(1);
+    double offNs = recordCostNs(frame);
+    if (!FlightRecorder::instance().start(BASE + ".cost")) return 1;
+    recordCostNs(frame); // touch every slot once
+    double onNs = recordCostNs(frame);
+    FlightRecorder::instance().stop();
+    std::cout << "{\"event\":\"flight_record_cost\",\"frame_bytes\":" << frame.size() << ",\"records\":" << COST_RECORDS
+              << ",\"disabled_ns\":" << offNs << ",\"enabled_ns\":" << onNs << "}" << std::endl;
+
+    ok = checkReplay() && ok;
+    return ok ? 0 : 1;
+}
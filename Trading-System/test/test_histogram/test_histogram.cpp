@@ -0,0 +1,124 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "../../src/WebSocketpp/LatencyHistogram.hpp"
+
+// Latency histogram benchmark. Records a lognormal latency distribution
+// (median ~20 us with a long tail) and compares the reported percentiles
+// with exact ones from the sorted samples, checks that concurrent writers
+// lose no samples and that an interval starts empty, then measures what
+// record() costs on the hot path against pushing into a vector (what the
+// per-event log lines amounted to, minus the formatting).
+
+inline long long nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static constexpr int SAMPLES = 1000000;
+static constexpr int THREADS = 4;
+
+static uint64_t exactPercentile(const std::vector<long long>& sorted, double q) {
+    size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return static_cast<uint64_t>(sorted[rank ? rank - 1 : 0]);
+}
+
+static bool accuracy() {
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> dist(std::log(20000.0), 0.8);
+    std::vector<long long> values(SAMPLES);
+    LatencyHistogram histogram;
+    for (long long& v : values) {
+        v = static_cast<long long>(dist(rng));
+        histogram.record(v);
+    }
+    LatencySnapshot s = histogram.takeInterval();
+    std::sort(values.begin(), values.end());
+
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    const uint64_t reported[] = {s.p50, s.p90, s.p99, s.p999};
+    const char* names[] = {"p50", "p90", "p99", "p999"};
+    double worstError = 0.0;
+    std::cout << "{\"event\":\"histogram_accuracy\",\"samples\":" << s.count;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t exact = exactPercentile(values, quantiles[i]);
+        double error = (static_cast<double>(reported[i]) - static_cast<double>(exact)) / static_cast<double>(exact);
+        worstError = std::max(worstError, std::fabs(error));
+        std::cout << ",\"" << names[i] << "_ns\":" << reported[i] << ",\"" << names[i] << "_exact_ns\":" << exact;
+    }
+    std::cout << ",\"max_ns\":" << s.max << ",\"max_exact_ns\":" << values.back()
+              << ",\"worst_relative_error\":" << worstError << "}" << std::endl;
+    // Bucket width bounds the error at 1/64
+    return s.count == SAMPLES && s.max == static_cast<uint64_t>(values.back()) && worstError <= 1.0 / 64;
+}
+
+static bool concurrency() {
+    LatencyHistogram histogram;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; ++t) {
+        writers.emplace_back([&histogram, t] {
+            for (int i = 0; i < SAMPLES / THREADS; ++i) histogram.record(1000 + t * 1000 + i % 500);
+        });
+    }
+    // Take intervals while the writers run: the counts must still add up
+    uint64_t counted = 0;
+    for (int i = 0; i < 20; ++i) {
+        counted += histogram.takeInterval().count;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    for (auto& w : writers) w.join();
+    counted += histogram.takeInterval().count;
+    uint64_t afterReset = histogram.takeInterval().count;
+    std::cout << "{\"event\":\"histogram_concurrency\",\"threads\":" << THREADS << ",\"recorded\":" << SAMPLES
+              << ",\"counted\":" << counted << ",\"after_reset\":" << afterReset << "}" << std::endl;
+    return counted == SAMPLES && afterReset == 0;
+}
+
+static void report(const char* mode, std::vector<long long>& l) {
+    std::sort(l.begin(), l.end());
+    long long sum = 0;
+    for (long long v : l) sum += v;
+    std::cout << "{\"event\":\"histogram_bench_summary\",\"mode\":\"" << mode << "\""
+              << ",\"samples\":" << l.size()
+              << ",\"avg_ns\":" << sum / static_cast<long long>(l.size())
+              << ",\"p50_ns\":" << l[l.size() / 2]
+              << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+              << ",\"max_ns\":" << l.back() << "}" << std::endl;
+}
+
+static void cost() {
+    // Time batches of 100 records; one record is below the clock's resolution
+    constexpr int BATCH = 100;
+    constexpr int BATCHES = 10000;
+    std::vector<long long> perRecord;
+    perRecord.reserve(BATCHES);
+
+    LatencyHistogram histogram;
+    for (int b = 0; b < BATCHES; ++b) {
+        long long start = nowNs();
+        for (int i = 0; i < BATCH; ++i) histogram.record(15000 + (b * BATCH + i) % 20000);
+        perRecord.push_back((nowNs() - start) / BATCH);
+    }
+    report("histogram_record", perRecord);
+
+    std::vector<long long> raw;
+    raw.reserve(static_cast<size_t>(BATCH) * BATCHES);
+    perRecord.clear();
+    for (int b = 0; b < BATCHES; ++b) {
+        long long start = nowNs();
+        for (int i = 0; i < BATCH; ++i) raw.push_back(15000 + (b * BATCH + i) % 20000);
+        perRecord.push_back((nowNs() - start) / BATCH);
+    }
+    report("vector_push", perRecord);
+}
+
+int main() {
+    bool ok = accuracy();
+    ok = concurrency() && ok;
+    cost();
+    return ok ? 0 : 1;
+}
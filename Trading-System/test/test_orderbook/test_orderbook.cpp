@@ -0,0 +1,122 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <random>
+#include <limits>
+#include <chrono>
+#include <functional>
+#include "../../src/WebSocketpp/OrderBook.hpp"
+
+// Benchmark: tick-indexed OrderBook ladder vs the previous std::map book,
+// driven by a synthetic book.BTC-PERPETUAL.raw style delta stream.
+
+inline long long nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Previous Api::OrderBook representation, kept here as the baseline
+struct MapBook {
+    std::map<double,double,std::greater<double>> bids;
+    std::map<double,double,std::less<double>> asks;
+    void setLevel(OrderBook::Side side, double price, double amount) {
+        if (side == OrderBook::Side::Bid) {
+            if (amount > 1e-12) bids[price] = amount; else bids.erase(price);
+        } else {
+            if (amount > 1e-12) asks[price] = amount; else asks.erase(price);
+        }
+    }
+    double bestBid() const { return bids.begin()->first; }
+    double bestAsk() const { return asks.begin()->first; }
+};
+
+struct LevelUpdate {
+    OrderBook::Side side;
+    double price;
+    double amount;
+};
+
+// Random walk of the mid with updates concentrated near the touch
+static std::vector<LevelUpdate> makeUpdates(size_t count, double tickSize) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> depthDist(0, 50);
+    std::uniform_int_distribution<int> walkDist(-1, 1);
+    std::uniform_real_distribution<double> amountDist(10.0, 5000.0);
+    std::bernoulli_distribution deleteDist(0.3);
+    std::vector<LevelUpdate> updates;
+    updates.reserve(count);
+    double mid = 60000.0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 64 == 0) mid += walkDist(rng) * tickSize;
+        bool bid = (i & 1) == 0;
+        int depth = depthDist(rng) + 1;
+        double price = bid ? mid - depth * tickSize : mid + depth * tickSize;
+        double amount = deleteDist(rng) ? 0.0 : amountDist(rng);
+        updates.push_back({bid ? OrderBook::Side::Bid : OrderBook::Side::Ask, price, amount});
+    }
+    return updates;
+}
+
+template<typename Book>
+static void seed(Book& book, double tickSize) {
+    for (int i = 1; i <= 50; ++i) {
+        book.setLevel(OrderBook::Side::Bid, 60000.0 - i * tickSize, 100.0);
+        book.setLevel(OrderBook::Side::Ask, 60000.0 + i * tickSize, 100.0);
+    }
+}
+
+// Apply every update and read the touch after each one, as Trader does
+template<typename Book>
+static void runBench(const char* name, Book& book, const std::vector<LevelUpdate>& updates,
+                     std::vector<double>& touches, int rounds) {
+    long long minNs = std::numeric_limits<long long>::max();
+    long long maxNs = 0;
+    long long sumNs = 0;
+    for (int r = 0; r < rounds; ++r) {
+        touches.clear();
+        long long start = nowNs();
+        for (const auto& u : updates) {
+            book.setLevel(u.side, u.price, u.amount);
+            touches.push_back(book.bestBid() + book.bestAsk());
+        }
+        long long elapsed = nowNs() - start;
+        if (elapsed < minNs) minNs = elapsed;
+        if (elapsed > maxNs) maxNs = elapsed;
+        sumNs += elapsed;
+    }
+    double n = static_cast<double>(updates.size());
+    std::cout << "{\"event\":\"orderbook_bench_summary\""
+              << ",\"book\":\"" << name << "\""
+              << ",\"updates\":" << updates.size()
+              << ",\"rounds\":" << rounds
+              << ",\"avg_ns_per_update\":" << (sumNs / rounds) / n
+              << ",\"min_ns_per_update\":" << minNs / n
+              << ",\"max_ns_per_update\":" << maxNs / n << "}" << std::endl;
+}
+
+int main() {
+    const double tickSize = DEFAULT_TICK_SIZE;
+    const size_t numUpdates = 1000000;
+    const int rounds = 5;
+    std::vector<LevelUpdate> updates = makeUpdates(numUpdates, tickSize);
+
+    MapBook mapBook;
+    OrderBook ladderBook(tickSize);
+    seed(mapBook, tickSize);
+    seed(ladderBook, tickSize);
+
+    std::vector<double> mapTouches;
+    std::vector<double> ladderTouches;
+    mapTouches.reserve(numUpdates);
+    ladderTouches.reserve(numUpdates);
+    runBench("std_map", mapBook, updates, mapTouches, rounds);
+    runBench("tick_ladder", ladderBook, updates, ladderTouches, rounds);
+
+    // Both books must agree on the touch after every update
+    size_t mismatches = 0;
+    for (size_t i = 0; i < numUpdates; ++i) {
+        if (mapTouches[i] != ladderTouches[i]) ++mismatches;
+    }
+    std::cout << "{\"event\":\"orderbook_bench_check\",\"mismatches\":" << mismatches << "}" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <nlohmann/json.hpp>
+#include "../../src/WebSocketpp/DeribitParser.hpp"
+
+// Microbenchmark: DeribitParser vs the nlohmann DOM path previously used by
+// Api::onMessage, on captured book/trade/order payloads.
+
+using json = nlohmann::json;
+
+// Count heap allocations made while decoding
+static std::atomic<long long> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC flags free() on memory from the replaced operator new; they are paired here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+inline long long nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Payload {
+    const char* name;
+    std::string text;
+};
+
+static std::vector<Payload> capturedPayloads() {
+    return {
+        {"book_change", R"({"jsonrpc":"2.0","method":"subscription","params":{"channel":"book.BTC-PERPETUAL.raw","data":{"type":"change","timestamp":1718000000123,"prev_change_id":63482781091,"instrument_name":"BTC-PERPETUAL","change_id":63482781092,"bids":[["change",66990.5,12340.0],["delete",66985.0,0.0]],"asks":[["new",67001.0,5000.0]]}}})"},
+        {"book_snapshot", R"({"jsonrpc":"2.0","method":"subscription","params":{"channel":"book.BTC-PERPETUAL.raw","data":{"type":"snapshot","timestamp":1718000000001,"instrument_name":"BTC-PERPETUAL","change_id":63482781000,"bids":[["new",66990.5,12340.0],["new",66990.0,2000.0],["new",66989.5,15000.0],["new",66989.0,800.0],["new",66988.5,40000.0],["new",66988.0,1200.0],["new",66987.5,3400.0],["new",66987.0,10.0],["new",66986.5,250.0],["new",66986.0,6000.0]],"asks":[["new",66991.0,5000.0],["new",66991.5,100.0],["new",66992.0,7000.0],["new",66992.5,30.0],["new",66993.0,12000.0],["new",66993.5,450.0],["new",66994.0,8000.0],["new",66994.5,90.0],["new",66995.0,2200.0],["new",66995.5,61000.0]]}}})"},
+        {"trades", R"({"jsonrpc":"2.0","method":"subscription","params":{"channel":"trades.BTC-PERPETUAL.raw","data":[{"trade_seq":198362538,"trade_id":"309937436","timestamp":1718000000200,"tick_direction":1,"price":66991.0,"mark_price":66990.31,"instrument_name":"BTC-PERPETUAL","index_price":66985.12,"direction":"buy","amount":1000.0}]}})"},
+        {"order_ack", R"({"jsonrpc":"2.0","id":42,"result":{"trades":[],"order":{"web":false,"time_in_force":"good_til_cancelled","replaced":false,"reduce_only":false,"price":66980.5,"post_only":false,"order_type":"limit","order_state":"open","order_id":"31085463972","max_show":10.0,"last_update_timestamp":1718000000300,"label":"","is_liquidation":false,"instrument_name":"BTC-PERPETUAL","filled_amount":0.0,"direction":"buy","creation_timestamp":1718000000300,"average_price":0.0,"api":true,"amount":10.0}},"usIn":1718000000299000,"usOut":1718000000301000,"usDiff":2000,"testnet":true})"},
+        {"error", R"({"jsonrpc":"2.0","id":43,"error":{"message":"not_open_order","code":11044},"usIn":1718000000400000,"usOut":1718000000400100,"usDiff":100,"testnet":true})"},
+    };
+}
+
+// The DOM path: full parse, then repeated lookups and copies
+static double domDecode(const std::string& message) {
+    json msgJson = json::parse(message);
+    double checksum = 0.0;
+    if (msgJson.contains("method") && msgJson["method"] == "subscription") {
+        std::string channel = msgJson["params"]["channel"];
+        auto data = msgJson["params"]["data"];
+        if (data.is_object()) {
+            if (data.contains("change_id")) checksum += data["change_id"].get<double>();
+            for (const char* side : {"bids", "asks"}) {
+                if (!data.contains(side)) continue;
+                for (auto& level : data[side]) {
+                    double price = level[level.size() - 2];
+                    double amount = level[level.size() - 1];
+                    checksum += price + amount;
+                }
+            }
+        } else if (data.is_array()) {
+            for (auto& trade : data) {
+                double price = trade["price"];
+                double amount = trade["amount"];
+                checksum += price + amount;
+            }
+        }
+        checksum += static_cast<double>(channel.size());
+    } else if (msgJson.contains("id")) {
+        int id = msgJson["id"];
+        checksum += id;
+        if (msgJson.contains("result") && msgJson["result"].contains("order")) {
+            std::string orderId = msgJson["result"]["order"]["order_id"];
+            checksum += static_cast<double>(orderId.size());
+        }
+    }
+    return checksum;
+}
+
+static double fastDecode(DeribitParser& parser, DeribitMessage& msg, const std::string& message) {
+    parser.parse(message, msg);
+    double checksum = static_cast<double>(msg.changeId);
+    for (const auto& level : msg.bids) checksum += level.price + level.amount;
+    for (const auto& level : msg.asks) checksum += level.price + level.amount;
+    for (const auto& trade : msg.trades) checksum += trade.price + trade.amount;
+    checksum += static_cast<double>(msg.channel.size());
+    checksum += static_cast<double>(msg.id);
+    checksum += static_cast<double>(msg.orderId.size());
+    return checksum;
+}
+
+template<typename Decode>
+static void runBench(const char* path, const Payload& payload, int iterations, Decode decode) {
+    long long minNs = std::numeric_limits<long long>::max();
+    long long maxNs = 0;
+    long long sumNs = 0;
+    double sink = 0.0;
+    // Warm up (lets reused buffers reach their working size)
+    for (int i = 0; i < 1000; ++i) sink += decode(payload.text);
+    long long allocsBefore = allocationCount.load();
+    for (int i = 0; i < iterations; ++i) {
+        long long start = nowNs();
+        sink += decode(payload.text);
+        long long elapsed = nowNs() - start;
+        if (elapsed < minNs) minNs = elapsed;
+        if (elapsed > maxNs) maxNs = elapsed;
+        sumNs += elapsed;
+    }
+    long long allocs = allocationCount.load() - allocsBefore;
+    std::cout << "{\"event\":\"parser_bench_summary\""
+              << ",\"path\":\"" << path << "\""
+              << ",\"payload\":\"" << payload.name << "\""
+              << ",\"bytes\":" << payload.text.size()
+              << ",\"samples\":" << iterations
+              << ",\"avg_ns\":" << sumNs / iterations
+              << ",\"min_ns\":" << minNs
+              << ",\"max_ns\":" << maxNs
+              << ",\"allocs_per_msg\":" << static_cast<double>(allocs) / iterations
+              << ",\"checksum\":" << sink << "}" << std::endl;
+}
+
+int main() {
+    const int iterations = 200000;
+    DeribitParser parser;
+    DeribitMessage msg;
+    for (const auto& payload : capturedPayloads()) {
+        runBench("nlohmann_dom", payload, iterations,
+                 [](const std::string& m) { return domDecode(m); });
+        runBench("deribit_parser", payload, iterations,
+                 [&](const std::string& m) { return fastDecode(parser, msg, m); });
+    }
+    return 0;
+}
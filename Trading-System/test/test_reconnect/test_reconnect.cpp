@@ -0,0 +1,238 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include "../../src/Custom_WebSocket/CSocket.hpp"
+#include "../../src/WebSocketpp/Socket.hpp"
+#include "../../src/WebSocketpp/ConnectionCache.hpp"
+#include "../../src/WebSocketpp/ConnectionManager.hpp"
+#ifdef USE_URING
+#include "../../src/Custom_WebSocket/UringSocket.hpp"
+#endif
+
+// Reconnect benchmark: a local TLS WebSocket server streams book updates,
+// then drops the TCP connection without a close handshake, over and over.
+// ConnectionManager reconnects and resubscribes; measured is the time from
+// the drop to the first book update on the new connection. "cold" turns
+// ConnectionCache off (DNS lookup and full TLS handshake on every connect),
+// "warm" is the default (cached addresses, resumed TLS session).
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+
+// The production latency clock (TSC once calibrated in main)
+inline long long nowNs() {
+    return BSocket::clockNs();
+}
+
+// Self-signed certificate for localhost, generated in memory
+static void useSelfSignedCert(ssl::context& ctx) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    SSL_CTX_use_certificate(ctx.native_handle(), cert);
+    SSL_CTX_use_PrivateKey(ctx.native_handle(), key);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+// Book updates are tagged with the connection they were sent on
+static constexpr std::string_view GEN_PREFIX = "{\"gen\":";
+static constexpr size_t GEN_DIGITS = 6;
+
+static std::string bookMessage(int generation) {
+    std::string gen = std::to_string(generation);
+    std::string msg(GEN_PREFIX);
+    msg.append(GEN_DIGITS - gen.size(), '0');
+    msg += gen;
+    msg += R"(,"jsonrpc":"2.0","method":"subscription","params":{"channel":"book.BTC-PERPETUAL.raw","data":{"type":"change","timestamp":1718000000123,"prev_change_id":63482781091,"instrument_name":"BTC-PERPETUAL","change_id":63482781092,"bids":[["change",66990.5,12340.0]],"asks":[["new",67001.0,5000.0]]}}})";
+    return msg;
+}
+
+static int generationOf(std::string_view payload) {
+    int gen = -1;
+    if (payload.size() < GEN_PREFIX.size() + GEN_DIGITS) return gen;
+    const char* begin = payload.data() + GEN_PREFIX.size();
+    std::from_chars(begin, begin + GEN_DIGITS, gen);
+    return gen;
+}
+
+// Serves `drops + 1` connections in turn on one TLS context (so its tickets
+// stay valid). Each waits for a subscribe, streams `perConnection` updates
+// and is then cut at the TCP level; the last one stays up until the client
+// closes.
+class BookServer {
+public:
+    BookServer(int drops, int perConnection)
+        : sslCtx(ssl::context::tlsv12_server), acceptor(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)),
+          drops(drops), perConnection(perConnection), dropNs(drops) {
+        useSelfSignedCert(sslCtx);
+        thread = std::thread([this] { run(); });
+    }
+    ~BookServer() {
+        if (thread.joinable()) thread.join();
+    }
+    unsigned short port() const { return acceptor.local_endpoint().port(); }
+    long long droppedAt(int generation) const { return dropNs[generation].load(std::memory_order_acquire); }
+
+private:
+    void run() {
+        for (int gen = 0; gen <= drops; ++gen) {
+            try {
+                tcp::socket socket(ioc);
+                acceptor.accept(socket);
+                socket.set_option(tcp::no_delay(true));
+                websocket::stream<beast::ssl_stream<tcp::socket>> ws(std::move(socket), sslCtx);
+                ws.next_layer().handshake(ssl::stream_base::server);
+                ws.accept();
+                // Nothing is sent until the client (re)subscribes
+                beast::flat_buffer buffer;
+                ws.read(buffer);
+                ws.text(true);
+                std::string msg = bookMessage(gen);
+                beast::error_code ec;
+                for (int i = 0; i < perConnection && !ec; ++i) {
+                    ws.write(net::buffer(msg), ec);
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                if (gen < drops) {
+                    dropNs[gen].store(nowNs(), std::memory_order_release);
+                    beast::get_lowest_layer(ws).close(ec);
+                    continue;
+                }
+                // Last connection: the client closes once it has seen it
+                while (!ec) ws.read(buffer, ec);
+            } catch (const std::exception& e) {
+                std::cerr << "BookServer error: " << e.what() << std::endl;
+                return;
+            }
+        }
+    }
+
+    net::io_context ioc;
+    ssl::context sslCtx;
+    tcp::acceptor acceptor;
+    int drops;
+    int perConnection;
+    std::vector<std::atomic<long long>> dropNs;
+    std::thread thread;
+};
+
+// Stands in for Api: subscribes on every (re)connect and timestamps the
+// first update of each connection
+struct BookClient {
+    ConnectionManager* manager = nullptr;
+    const BookServer* server = nullptr;
+    std::vector<long long> recoveries;
+    std::atomic<int> generation{-1};
+
+    void subscribe() {
+        manager->send(R"({"jsonrpc":"2.0","id":1,"method":"public/subscribe","params":{"channels":["book.BTC-PERPETUAL.raw"]}})");
+    }
+    void onMessage(std::string_view payload, long long /*receivedNs*/) {
+        int gen = generationOf(payload);
+        if (gen <= generation.load(std::memory_order_relaxed)) return;
+        if (gen > 0) recoveries.push_back(nowNs() - server->droppedAt(gen - 1));
+        generation.store(gen, std::memory_order_release);
+    }
+};
+
+static BSocket* makeTransport(const std::string& name) {
+    if (name == "csocket") return new CustomWebSocket::CSocket();
+    if (name == "beast_socket") return new Socket();
+#ifdef USE_URING
+    if (name == "uring_socket") return new CustomWebSocket::UringSocket();
+#endif
+    return nullptr;
+}
+
+// False if the run fell short, or a warm run resumed no TLS session
+static bool runReconnects(const std::string& name, bool warm, int drops) {
+    ConnectionCache& cache = ConnectionCache::instance();
+    cache.clear();
+    cache.setEnabled(warm, warm);
+    ConnectionCache::Stats before = cache.stats();
+
+    BookServer server(drops, 20);
+    BookClient client;
+    client.server = &server;
+    ConnectionManager manager([name] { return makeTransport(name); });
+    client.manager = &manager;
+    manager.setMessageHandler(MessageHandler::bind<BookClient, &BookClient::onMessage>(&client));
+    manager.setReconnectHandler(ConnectionHandler::bind<BookClient, &BookClient::subscribe>(&client));
+    if (!manager.connect("wss://localhost:" + std::to_string(server.port()) + "/ws/api/v2")) return false;
+    client.subscribe();
+    long long deadline = nowNs() + 60'000'000'000LL;
+    while (client.generation.load(std::memory_order_acquire) < drops && nowNs() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ConnectionManager::Stats stats = manager.stats();
+    manager.close();
+    ConnectionCache::Stats after = cache.stats();
+
+    std::vector<long long>& l = client.recoveries;
+    std::cout << "{\"event\":\"reconnect_bench_summary\""
+              << ",\"client\":\"" << name << "\""
+              << ",\"mode\":\"" << (warm ? "warm" : "cold") << "\""
+              << ",\"drops\":" << drops
+              << ",\"samples\":" << l.size()
+              << ",\"reconnects\":" << stats.reconnects
+              << ",\"failed_attempts\":" << stats.failedAttempts
+              << ",\"resolves\":" << after.resolves - before.resolves
+              << ",\"dns_hits\":" << after.dnsHits - before.dnsHits
+              << ",\"handshakes\":" << after.handshakes - before.handshakes
+              << ",\"resumed\":" << after.resumed - before.resumed;
+    if (!l.empty()) {
+        std::sort(l.begin(), l.end());
+        long long sum = 0;
+        for (long long v : l) sum += v;
+        std::cout << ",\"avg_ns\":" << sum / static_cast<long long>(l.size())
+                  << ",\"min_ns\":" << l.front()
+                  << ",\"p50_ns\":" << l[l.size() / 2]
+                  << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+                  << ",\"max_ns\":" << l.back();
+    }
+    std::cout << "}" << std::endl;
+    bool resumed = !warm || after.resumed > before.resumed;
+    if (!resumed) std::cerr << name << ": warm reconnects resumed no TLS session" << std::endl;
+    return resumed && static_cast<int>(l.size()) == drops;
+}
+
+int main() {
+    TscClock::start();
+    const int drops = 100;
+    std::vector<std::string> clients = {"csocket", "beast_socket"};
+#ifdef USE_URING
+    clients.push_back("uring_socket");
+#endif
+    bool ok = true;
+    for (const std::string& name : clients) {
+        ok = runReconnects(name, false, drops) && ok;
+        ok = runReconnects(name, true, drops) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <unordered_map>
+#include "../../src/WebSocketpp/RequestTable.hpp"
+
+// Contention benchmark: N strategy threads register requests while one I/O
+// thread retires their responses, with RequestTable vs the mutex-guarded
+// unordered_map Api used before.
+
+inline long long nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// The previous Api bookkeeping
+class MutexTable {
+public:
+    void insert(int id, const RequestInfo& info) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending[id] = info;
+    }
+    bool take(int id, RequestInfo& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pending.find(id);
+        if (it == pending.end()) return false;
+        out = it->second;
+        pending.erase(it);
+        return true;
+    }
+private:
+    std::mutex mutex;
+    std::unordered_map<int, RequestInfo> pending;
+};
+
+template<typename Table>
+static void runBench(const char* path, int producers, int requestsPerProducer) {
+    Table table;
+    const int total = producers * requestsPerProducer;
+    // Requests in flight are bounded, as they are by the exchange's rate limits
+    const int maxInFlight = 1024;
+    std::atomic<int> nextId{1};
+    std::atomic<int> retired{0};
+    std::atomic<bool> start{false};
+    std::vector<long long> sumNs(producers, 0), maxNs(producers, 0);
+    std::vector<long long> minNs(producers, std::numeric_limits<long long>::max());
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < requestsPerProducer; ++i) {
+                while (nextId.load(std::memory_order_relaxed) - retired.load(std::memory_order_acquire) > maxInFlight) {
+                    std::this_thread::yield();
+                }
+                long long begin = nowNs();
+                int id = nextId.fetch_add(1, std::memory_order_relaxed);
+                table.insert(id, {RequestKind::Order, nowNs(), 0});
+                long long elapsed = nowNs() - begin;
+                sumNs[p] += elapsed;
+                if (elapsed < minNs[p]) minNs[p] = elapsed;
+                if (elapsed > maxNs[p]) maxNs[p] = elapsed;
+            }
+        });
+    }
+    // I/O thread: responses arrive roughly in request order
+    long long retireNs = 0;
+    std::thread io([&] {
+        while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+        RequestInfo info;
+        for (int id = 1; id <= total; ++id) {
+            long long begin = nowNs();
+            while (!table.take(id, info)) std::this_thread::yield();
+            retireNs += nowNs() - begin;
+            retired.store(id, std::memory_order_release);
+        }
+    });
+
+    long long wallStart = nowNs();
+    start.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    io.join();
+    long long wallNs = nowNs() - wallStart;
+
+    long long sum = 0, mx = 0, mn = std::numeric_limits<long long>::max();
+    for (int p = 0; p < producers; ++p) {
+        sum += sumNs[p];
+        if (maxNs[p] > mx) mx = maxNs[p];
+        if (minNs[p] < mn) mn = minNs[p];
+    }
+    std::cout << "{\"event\":\"request_table_bench_summary\""
+              << ",\"path\":\"" << path << "\""
+              << ",\"producers\":" << producers
+              << ",\"samples\":" << total
+              << ",\"avg_ns\":" << sum / total
+              << ",\"min_ns\":" << mn
+              << ",\"max_ns\":" << mx
+              << ",\"retire_avg_ns\":" << retireNs / total
+              << ",\"requests_per_sec\":" << static_cast<long long>(total * 1e9 / wallNs) << "}" << std::endl;
+}
+
+int main() {
+    const int requestsPerProducer = 200000;
+    // Spins yield, so oversubscribed machines still make progress
+    for (int producers : {1, 2, 4}) {
+        runBench<MutexTable>("mutex_map", producers, requestsPerProducer);
+        runBench<RequestTable>("request_table", producers, requestsPerProducer);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include "../../src/WebSocketpp/Api.hpp"
+#include "../../src/WebSocketpp/Trader.hpp"
+
+// Tick-to-trade tracing check. Drives Api and the default Trader through a
+// loopback socket: every book update has a spread wide enough for the
+// strategy to quote both sides, the "exchange" acks each order and then
+// fills it. Checks that every order carries its trace label, that every
+// ack closes a trace (sampled in full to the event log) and every fill is
+// matched back through the label, and prints the stage percentiles the
+// metrics reporter logged.
+
+using json = nlohmann::json;
+
+static constexpr int ROUNDS = 2000;
+static const char* LOG_PATH = "/tmp/test_tracing.jsonl";
+
+// Captures the orders Api sends (decoding them is in the send stage);
+// everything else is dropped
+class LoopbackSocket : public BSocket {
+public:
+    struct Order { int id; std::string label; };
+    std::vector<Order> orders;
+
+    bool connect(const std::string&) override { return true; }
+    bool send(std::string_view message) override {
+        json req = json::parse(message);
+        std::string method = req.value("method", "");
+        if (method == "private/buy" || method == "private/sell") {
+            orders.push_back({req["id"].get<int>(), req["params"].value("label", "")});
+        }
+        return true;
+    }
+    void close() override {}
+};
+
+static std::string bookUpdate(int round) {
+    json data = {
+        {"type", "snapshot"},
+        {"timestamp", TscClock::toWallNs(TscClock::nowNs()) / 1'000'000},
+        {"instrument_name", DEFAULT_INSTRUMENT},
+        {"change_id", round + 1},
+        {"bids", json::array({json::array({"new", 66980.0, 1000.0})})},
+        {"asks", json::array({json::array({"new", 67000.0, 1000.0})})},
+    };
+    json msg = {{"jsonrpc", "2.0"}, {"method", "subscription"},
+                {"params", {{"channel", std::string("book.") + DEFAULT_INSTRUMENT + ".raw"}, {"data", data}}}};
+    return msg.dump();
+}
+
+static std::string orderAck(int id, const std::string& orderId, const std::string& label) {
+    json msg = {{"jsonrpc", "2.0"}, {"id", id},
+                {"result", {{"order", {{"order_id", orderId}, {"order_state", "open"}, {"label", label}}}, {"trades", json::array()}}}};
+    return msg.dump();
+}
+
+static std::string orderFill(const std::string& orderId, const std::string& label) {
+    json data = {{"order_id", orderId}, {"order_state", "filled"}, {"label", label}, {"filled_amount", 10.0}};
+    json msg = {{"jsonrpc", "2.0"}, {"method", "subscription"},
+                {"params", {{"channel", std::string("user.orders.") + DEFAULT_INSTRUMENT + ".raw"}, {"data", data}}}};
+    return msg.dump();
+}
+
+// Stamped as a transport would, once the message is complete
+static void deliver(Api& api, const std::string& message) {
+    api.onMessage(message, BSocket::clockNs());
+}
+
+int main() {
+    TscClock::start();
+    EventLog::instance().start(EventLog::Format::Json, LOG_PATH);
+
+    auto* socket = new LoopbackSocket();
+    Api api(socket);
+    api.orderTracer().setSampleEvery(1);
+    Trader trader(&api);
+    api.setTrader(&trader);
+
+    // The strategy prints each quote; keep the output to the summaries
+    std::ostringstream quotes;
+    std::streambuf* console = std::cout.rdbuf(quotes.rdbuf());
+    trader.start();
+    size_t labelled = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        size_t first = socket->orders.size();
+        deliver(api, bookUpdate(round));
+        for (size_t i = first; i < socket->orders.size(); ++i) {
+            const LoopbackSocket::Order& o = socket->orders[i];
+            std::string orderId = "ETH-" + std::to_string(o.id);
+            labelled += o.label.rfind(Tracer::LABEL_PREFIX, 0) == 0;
+            deliver(api, orderAck(o.id, orderId, o.label));
+            deliver(api, orderFill(orderId, o.label));
+        }
+    }
+    std::cout.rdbuf(console);
+    api.latencyMetrics().report(std::chrono::milliseconds(1000));
+    EventLog::instance().stop();
+
+    // Sampled traces must name the orders' labels; every stage is a duration
+    std::map<std::string, json> snapshots;
+    size_t traces = 0, matched = 0, negative = 0;
+    std::map<int, std::string> labels;
+    for (const auto& o : socket->orders) labels[o.id] = o.label;
+    std::ifstream in(LOG_PATH);
+    for (std::string line; std::getline(in, line);) {
+        json event = json::parse(line);
+        if (event["event"] == "latency_snapshot") {
+            snapshots[event["metric"].get<std::string>()] = event;
+        } else if (event["event"] == "trace") {
+            ++traces;
+            int requestId = event["request_id"].get<int>();
+            matched += labels[requestId] == std::string(Tracer::LABEL_PREFIX) + std::to_string(event["trace_id"].get<uint64_t>());
+            for (const char* stage : {"socket_read_ns", "parse_ns", "book_apply_ns", "strategy_ns", "encode_ns", "send_ns",
+                                      "exchange_round_trip_ns", "tick_to_ack_ns"}) {
+                negative += event[stage].get<int64_t>() < 0;
+            }
+        }
+    }
+    size_t orders = socket->orders.size();
+    auto samples = [&](const std::string& metric) {
+        return snapshots.count(metric) ? snapshots[metric]["count"].get<uint64_t>() : 0;
+    };
+    std::cout << "{\"event\":\"tracing_check\",\"book_updates\":" << ROUNDS << ",\"orders\":" << orders
+              << ",\"labelled\":" << labelled << ",\"traces\":" << traces << ",\"matched\":" << matched
+              << ",\"negative_stages\":" << negative << ",\"tick_to_ack_samples\":" << samples("trace.tick_to_ack")
+              << ",\"ack_to_fill_samples\":" << samples("trace.ack_to_fill") << "}" << std::endl;
+    for (size_t stage = 0; stage < TRACE_STAGES; ++stage) {
+        std::string metric = std::string("trace.") + traceStageName(static_cast<TraceStage>(stage));
+        if (!snapshots.count(metric)) continue;
+        const json& s = snapshots[metric];
+        std::cout << "{\"event\":\"trace_stage_summary\",\"stage\":\"" << traceStageName(static_cast<TraceStage>(stage)) << "\""
+                  << ",\"samples\":" << s["count"] << ",\"p50_ns\":" << s["p50_ns"] << ",\"p99_ns\":" << s["p99_ns"]
+                  << ",\"max_ns\":" << s["max_ns"] << "}" << std::endl;
+    }
+    bool ok = orders == 2 * static_cast<size_t>(ROUNDS) && labelled == orders && traces == orders && matched == orders &&
+              negative == 0 && samples("trace.tick_to_ack") == orders && samples("trace.ack_to_fill") == orders;
+    return ok ? 0 : 1;
+}
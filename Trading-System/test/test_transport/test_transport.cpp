@@ -0,0 +1,492 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <ctime>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include "../../src/Custom_WebSocket/CSocket.hpp"
+#include "../../src/WebSocketpp/Socket.hpp"
+#ifdef USE_URING
+#include "../../src/Custom_WebSocket/UringSocket.hpp"
+#endif
+
+// Transport benchmark: a local TLS WebSocket server replays the same book
+// feed to CSocket (hand-rolled framing) and Socket (Beast). Each payload
+// carries its send time, so the receive side measures one-way latency on the
+// loopback as well as throughput.
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+
+// Heap allocations per thread, so the client's reader thread can be measured
+// apart from the server running in the same process
+static thread_local long long threadAllocations = 0;
+
+void* operator new(std::size_t size) {
+    ++threadAllocations;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC flags free() on memory from the replaced operator new; they are paired here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+// The production latency clock (TSC once calibrated in main)
+inline long long nowNs() {
+    return BSocket::clockNs();
+}
+
+// CPU time of the calling thread
+inline long long threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1'000'000'000LL + ts.tv_nsec;
+}
+
+// Payloads start with a fixed-width send timestamp that is patched in place
+static constexpr std::string_view STAMP_PREFIX = "{\"sent_ns\":";
+static constexpr size_t STAMP_DIGITS = 19;
+
+static std::string feedMessage() {
+    std::string msg(STAMP_PREFIX);
+    msg.append(STAMP_DIGITS, '0');
+    msg += R"(,"jsonrpc":"2.0","method":"subscription","params":{"channel":"book.BTC-PERPETUAL.raw","data":{"type":"change","timestamp":1718000000123,"prev_change_id":63482781091,"instrument_name":"BTC-PERPETUAL","change_id":63482781092,"bids":[["change",66990.5,12340.0],["delete",66985.0,0.0]],"asks":[["new",67001.0,5000.0]]}}})";
+    return msg;
+}
+
+static void stamp(std::string& msg, long long ns) {
+    char* digits = msg.data() + STAMP_PREFIX.size();
+    for (size_t i = STAMP_DIGITS; i-- > 0;) {
+        digits[i] = static_cast<char>('0' + ns % 10);
+        ns /= 10;
+    }
+}
+
+static long long sentAt(std::string_view payload) {
+    long long ns = 0;
+    if (payload.size() < STAMP_PREFIX.size() + STAMP_DIGITS) return 0;
+    const char* begin = payload.data() + STAMP_PREFIX.size();
+    std::from_chars(begin, begin + STAMP_DIGITS, ns);
+    return ns;
+}
+
+// Self-signed certificate for 127.0.0.1, generated in memory
+static void useSelfSignedCert(ssl::context& ctx) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    SSL_CTX_use_certificate(ctx.native_handle(), cert);
+    SSL_CTX_use_PrivateKey(ctx.native_handle(), key);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+// Accepts one client and sends it `count` feed messages, pausing `gapUs`
+// between them (0 = back to back), then closes
+class FeedServer {
+public:
+    FeedServer(int count, int gapUs)
+        : sslCtx(ssl::context::tlsv12_server), acceptor(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)),
+          count(count), gapUs(gapUs) {
+        useSelfSignedCert(sslCtx);
+        thread = std::thread([this] { run(); });
+    }
+    ~FeedServer() {
+        if (thread.joinable()) thread.join();
+    }
+    unsigned short port() const { return acceptor.local_endpoint().port(); }
+
+private:
+    void run() {
+        try {
+            tcp::socket socket(ioc);
+            acceptor.accept(socket);
+            socket.set_option(tcp::no_delay(true));
+            websocket::stream<beast::ssl_stream<tcp::socket>> ws(std::move(socket), sslCtx);
+            ws.next_layer().handshake(ssl::stream_base::server);
+            ws.accept();
+            ws.text(true);
+            std::string msg = feedMessage();
+            for (int i = 0; i < count; ++i) {
+                if (gapUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(gapUs));
+                stamp(msg, nowNs());
+                ws.write(net::buffer(msg));
+            }
+            beast::error_code ec;
+            ws.close(websocket::close_code::normal, ec);
+        } catch (const std::exception& e) {
+            std::cerr << "FeedServer error: " << e.what() << std::endl;
+        }
+    }
+
+    net::io_context ioc;
+    ssl::context sslCtx;
+    tcp::acceptor acceptor;
+    int count;
+    int gapUs;
+    std::thread thread;
+};
+
+// Accepts one client and reads order frames until `count` have arrived,
+// checking each one unmasked to the expected payload
+class SinkServer {
+public:
+    SinkServer(int count, std::string expected)
+        : sslCtx(ssl::context::tlsv12_server), acceptor(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)),
+          count(count), expected(std::move(expected)) {
+        useSelfSignedCert(sslCtx);
+        thread = std::thread([this] { run(); });
+    }
+    ~SinkServer() {
+        if (thread.joinable()) thread.join();
+    }
+    unsigned short port() const { return acceptor.local_endpoint().port(); }
+    void join() {
+        if (thread.joinable()) thread.join();
+    }
+    int received = 0;
+    int mismatches = 0;
+
+private:
+    void run() {
+        try {
+            tcp::socket socket(ioc);
+            acceptor.accept(socket);
+            socket.set_option(tcp::no_delay(true));
+            websocket::stream<beast::ssl_stream<tcp::socket>> ws(std::move(socket), sslCtx);
+            ws.next_layer().handshake(ssl::stream_base::server);
+            ws.accept();
+            beast::flat_buffer buffer;
+            while (received < count) {
+                buffer.clear();
+                ws.read(buffer);
+                std::string_view msg(static_cast<const char*>(buffer.data().data()), buffer.size());
+                if (msg != expected) ++mismatches;
+                ++received;
+            }
+            beast::error_code ec;
+            ws.close(websocket::close_code::normal, ec);
+        } catch (const std::exception& e) {
+            std::cerr << "SinkServer error: " << e.what() << std::endl;
+        }
+    }
+
+    net::io_context ioc;
+    ssl::context sslCtx;
+    tcp::acceptor acceptor;
+    int count;
+    std::string expected;
+    std::thread thread;
+};
+
+// Accepts one client, sends it a frame header declaring `payloadLen` bytes
+// and nothing else, then reads the close frame the client must answer with
+class BadFrameServer {
+public:
+    explicit BadFrameServer(uint64_t payloadLen)
+        : sslCtx(ssl::context::tlsv12_server), acceptor(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)),
+          payloadLen(payloadLen) {
+        useSelfSignedCert(sslCtx);
+        thread = std::thread([this] { run(); });
+    }
+    ~BadFrameServer() {
+        if (thread.joinable()) thread.join();
+    }
+    unsigned short port() const { return acceptor.local_endpoint().port(); }
+    void join() {
+        if (thread.joinable()) thread.join();
+    }
+    int closeCode = 0;
+
+private:
+    void run() {
+        try {
+            tcp::socket socket(ioc);
+            acceptor.accept(socket);
+            websocket::stream<beast::ssl_stream<tcp::socket>> ws(std::move(socket), sslCtx);
+            ws.next_layer().handshake(ssl::stream_base::server);
+            ws.accept();
+            // Text frame, FIN, 64-bit length, below the WebSocket layer
+            unsigned char header[10] = {0x81, 127};
+            for (int i = 0; i < 8; ++i) header[2 + i] = static_cast<unsigned char>(payloadLen >> (56 - 8 * i));
+            net::write(ws.next_layer(), net::buffer(header));
+            beast::flat_buffer buffer;
+            beast::error_code ec;
+            ws.read(buffer, ec);
+            if (ec == websocket::error::closed) closeCode = ws.reason().code;
+        } catch (const std::exception& e) {
+            std::cerr << "BadFrameServer error: " << e.what() << std::endl;
+        }
+    }
+
+    net::io_context ioc;
+    ssl::context sslCtx;
+    tcp::acceptor acceptor;
+    uint64_t payloadLen;
+    std::thread thread;
+};
+
+// Receive-side statistics, updated from the client's reader thread
+struct FeedStats {
+    std::vector<long long> latencies;
+    std::atomic<int> received{0};
+    long long firstNs = 0;
+    long long lastNs = 0;
+    // Reader-thread allocations between the first and last payload
+    long long firstAllocations = 0;
+    long long lastAllocations = 0;
+    // Reader-thread CPU time over the same span
+    long long firstCpuNs = 0;
+    long long lastCpuNs = 0;
+
+    explicit FeedStats(int count) { latencies.reserve(count); }
+
+    // Latency is taken against the sender's clock, not receivedNs
+    void onPayload(std::string_view payload, long long /*receivedNs*/) {
+        long long now = nowNs();
+        if (received.load(std::memory_order_relaxed) == 0) {
+            firstNs = now;
+            firstAllocations = threadAllocations;
+            firstCpuNs = threadCpuNs();
+        }
+        lastNs = now;
+        lastAllocations = threadAllocations;
+        lastCpuNs = threadCpuNs();
+        latencies.push_back(now - sentAt(payload));
+        received.fetch_add(1, std::memory_order_release);
+    }
+};
+
+static void report(const char* client, const char* mode, FeedStats& stats, int expected) {
+    std::vector<long long>& l = stats.latencies;
+    if (l.empty()) {
+        std::cout << "{\"event\":\"transport_bench_summary\",\"client\":\"" << client
+                  << "\",\"mode\":\"" << mode << "\",\"samples\":0}" << std::endl;
+        return;
+    }
+    std::sort(l.begin(), l.end());
+    long long sum = 0;
+    for (long long v : l) sum += v;
+    double seconds = (stats.lastNs - stats.firstNs) / 1e9;
+    double allocsPerMsg = l.size() > 1 ? static_cast<double>(stats.lastAllocations - stats.firstAllocations) / (l.size() - 1) : 0;
+    long long cpuPerMsg = l.size() > 1 ? (stats.lastCpuNs - stats.firstCpuNs) / static_cast<long long>(l.size() - 1) : 0;
+    std::cout << "{\"event\":\"transport_bench_summary\""
+              << ",\"client\":\"" << client << "\""
+              << ",\"mode\":\"" << mode << "\""
+              << ",\"samples\":" << l.size()
+              << ",\"expected\":" << expected
+              << ",\"avg_ns\":" << sum / static_cast<long long>(l.size())
+              << ",\"min_ns\":" << l.front()
+              << ",\"p50_ns\":" << l[l.size() / 2]
+              << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+              << ",\"max_ns\":" << l.back()
+              << ",\"msgs_per_sec\":" << (seconds > 0 ? static_cast<long long>(l.size() / seconds) : 0)
+              << ",\"allocs_per_msg\":" << allocsPerMsg
+              << ",\"cpu_ns_per_msg\":" << cpuPerMsg
+              << "}" << std::endl;
+}
+
+static void waitFor(FeedStats& stats, int count) {
+    long long deadline = nowNs() + 30'000'000'000LL;
+    while (stats.received.load(std::memory_order_acquire) < count && nowNs() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void runCSocket(const char* mode, int count, int gapUs, const LowLatencyConfig& config = {}) {
+    FeedServer server(count, gapUs);
+    FeedStats stats(count);
+    CustomWebSocket::CSocket client;
+    client.setLowLatency(config);
+    client.setMessageHandler(MessageHandler::bind<FeedStats, &FeedStats::onPayload>(&stats));
+    if (!client.connect("127.0.0.1", "/", std::to_string(server.port()))) return;
+    waitFor(stats, count);
+    client.close();
+    report("csocket", mode, stats, count);
+}
+
+static void runBeastSocket(const char* mode, int count, int gapUs, const LowLatencyConfig& config = {}) {
+    FeedServer server(count, gapUs);
+    FeedStats stats(count);
+    Socket client;
+    client.setLowLatency(config);
+    client.setMessageHandler(MessageHandler::bind<FeedStats, &FeedStats::onPayload>(&stats));
+    if (!client.connect("wss://127.0.0.1:" + std::to_string(server.port()) + "/")) return;
+    waitFor(stats, count);
+    client.close();
+    report("beast_socket", mode, stats, count);
+}
+
+#ifdef USE_URING
+static void runUringSocket(const char* mode, int count, int gapUs, const LowLatencyConfig& config = {}) {
+    FeedServer server(count, gapUs);
+    FeedStats stats(count);
+    CustomWebSocket::UringSocket client;
+    client.setLowLatency(config);
+    client.setMessageHandler(MessageHandler::bind<FeedStats, &FeedStats::onPayload>(&stats));
+    if (!client.connect("wss://127.0.0.1:" + std::to_string(server.port()) + "/")) return;
+    waitFor(stats, count);
+    client.close();
+    report("uring_socket", mode, stats, count);
+}
+#endif
+
+// Order egress: time each CSocket::send call (frame build, mask, TLS write)
+static void runCSocketSend(const char* mode, const std::string& order, int count) {
+    SinkServer server(count, order);
+    CustomWebSocket::CSocket client;
+    if (!client.connect("127.0.0.1", "/", std::to_string(server.port()))) return;
+    std::vector<long long> l;
+    l.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        long long start = nowNs();
+        client.send(order);
+        l.push_back(nowNs() - start);
+    }
+    server.join();
+    client.close();
+    std::sort(l.begin(), l.end());
+    long long sum = 0;
+    for (long long v : l) sum += v;
+    std::cout << "{\"event\":\"transport_send_summary\""
+              << ",\"client\":\"csocket\""
+              << ",\"mode\":\"" << mode << "\""
+              << ",\"bytes\":" << order.size()
+              << ",\"samples\":" << count
+              << ",\"avg_ns\":" << sum / count
+              << ",\"min_ns\":" << l.front()
+              << ",\"p50_ns\":" << l[l.size() / 2]
+              << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+              << ",\"max_ns\":" << l.back()
+              << ",\"received\":" << server.received
+              << ",\"mismatches\":" << server.mismatches << "}" << std::endl;
+}
+
+// Order egress through Socket's write queue: send() cost is the enqueue, and
+// the queue counters show how far the io thread fell behind
+static void runBeastSend(const char* mode, const std::string& order, int count) {
+    SinkServer server(count, order);
+    Socket client;
+    if (!client.connect("wss://127.0.0.1:" + std::to_string(server.port()) + "/")) return;
+    std::vector<long long> l;
+    l.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        // Back off while the queue is full rather than count rejections
+        while (client.writeStats().depth >= WriteQueue::DEFAULT_CAPACITY) std::this_thread::yield();
+        long long start = nowNs();
+        client.send(order);
+        l.push_back(nowNs() - start);
+    }
+    server.join();
+    Socket::WriteStats stats = client.writeStats();
+    client.close();
+    std::sort(l.begin(), l.end());
+    long long sum = 0;
+    for (long long v : l) sum += v;
+    std::cout << "{\"event\":\"transport_send_summary\""
+              << ",\"client\":\"beast_socket\""
+              << ",\"mode\":\"" << mode << "\""
+              << ",\"bytes\":" << order.size()
+              << ",\"samples\":" << count
+              << ",\"avg_ns\":" << sum / count
+              << ",\"min_ns\":" << l.front()
+              << ",\"p50_ns\":" << l[l.size() / 2]
+              << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+              << ",\"max_ns\":" << l.back()
+              << ",\"written\":" << stats.written
+              << ",\"rejected\":" << stats.rejected
+              << ",\"oversized\":" << stats.oversized
+              << ",\"max_depth\":" << stats.maxDepth
+              << ",\"write_avg_ns\":" << stats.avgLatencyNs
+              << ",\"write_max_ns\":" << stats.maxLatencyNs
+              << ",\"received\":" << server.received
+              << ",\"mismatches\":" << server.mismatches << "}" << std::endl;
+}
+
+struct DropFlag {
+    std::atomic<bool> dropped{false};
+    void onDisconnect() { dropped = true; }
+};
+
+// A frame length the client must refuse: it fails the connection with
+// `expectedCode` instead of reading past its buffer or growing it without end
+static bool runBadFrame(const char* mode, uint64_t payloadLen, int expectedCode) {
+    BadFrameServer server(payloadLen);
+    DropFlag flag;
+    CustomWebSocket::CSocket client;
+    client.setDisconnectHandler(ConnectionHandler::bind<DropFlag, &DropFlag::onDisconnect>(&flag));
+    if (!client.connect("127.0.0.1", "/", std::to_string(server.port()))) return false;
+    server.join();
+    long long deadline = nowNs() + 5'000'000'000LL;
+    while (!flag.dropped && nowNs() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    client.close();
+    bool ok = server.closeCode == expectedCode && flag.dropped;
+    std::cout << "{\"event\":\"transport_bad_frame\",\"client\":\"csocket\",\"mode\":\"" << mode
+              << "\",\"payload_len\":" << payloadLen << ",\"close_code\":" << server.closeCode
+              << ",\"disconnected\":" << (flag.dropped ? "true" : "false") << ",\"ok\":" << (ok ? "true" : "false")
+              << "}" << std::endl;
+    return ok;
+}
+
+int main() {
+    TscClock::start();
+    // Throughput: back-to-back messages; latency: paced messages
+    runCSocket("burst", 200000, 0);
+    runBeastSocket("burst", 200000, 0);
+    runCSocket("paced", 20000, 50);
+    runBeastSocket("paced", 20000, 50);
+    // Spinning readers; they yield now and then so the in-process server
+    // keeps its share of a small machine
+    LowLatencyConfig spin;
+    spin.spin = true;
+    spin.spinsBeforeYield = 64;
+    runCSocket("paced_spin", 20000, 50, spin);
+    runBeastSocket("paced_spin", 20000, 50, spin);
+#ifdef USE_URING
+    runUringSocket("burst", 200000, 0);
+    runUringSocket("paced", 20000, 50);
+    runUringSocket("paced_spin", 20000, 50, spin);
+#endif
+    // Egress: an order-sized frame, and a large one for the 64-bit length path
+    std::string order = R"({"jsonrpc":"2.0","method":"private/buy","params":{"access_token":"1582198456231.1Ml2bJjR.vv4HFu1pZlAcuCn1rTCyhXzQKbQtFOajd8fOrQqXnEqf","instrument_name":"BTC-PERPETUAL","type":"limit","amount":10,"price":66980.5},"id":42})";
+    runCSocketSend("order", order, 20000);
+    runBeastSend("order", order, 20000);
+    std::string large(100003, 'x');
+    runCSocketSend("large", large, 100);
+    // Larger than a write queue slot: goes out through the heap overflow path
+    runBeastSend("large", large, 100);
+    // Lengths a server must never send: top bit set (one that would wrap the
+    // frame length to 4 bytes), and one far over the message size limit
+    bool ok = runBadFrame("msb_set", ~uint64_t{0} - 5, CustomWebSocket::CLOSE_PROTOCOL_ERROR);
+    ok = runBadFrame("too_big", uint64_t{1} << 40, CustomWebSocket::CLOSE_MESSAGE_TOO_BIG) && ok;
+    return ok ? 0 : 1;
+}
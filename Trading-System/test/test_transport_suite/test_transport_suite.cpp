@@ -0,0 +1,326 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include "../../src/Custom_WebSocket/CSocket.hpp"
+#include "../../src/WebSocketpp/Socket.hpp"
+#if __has_include(<websocketpp/config/asio_client.hpp>)
+#include "../../src/WebSocketpp/Socketpp.hpp"
+#define HAVE_SOCKETPP
+#endif
+#ifdef USE_URING
+#include "../../src/Custom_WebSocket/UringSocket.hpp"
+#endif
+
+// Transport comparison: each production BSocket connects to the same local
+// echo server, over plain TCP (ws://) and TLS (wss://, self-signed), and
+// sends identical messages at identical rates. Every message carries its send
+// time, so the echo gives the round trip. Reported per run: throughput,
+// p50/p99/p99.9 round trip, and client CPU per message (sending thread plus
+// the transport's reader thread).
+//
+// Modes:
+//   pingpong - one message in flight: the bare round trip
+//   paced    - open loop at a fixed rate, as a feed-driven strategy would send
+//   flood    - as fast as the transport takes them, WINDOW messages in flight
+
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+using tcp = net::ip::tcp;
+
+static constexpr int WINDOW = 256;
+static constexpr long long TIMEOUT_NS = 20'000'000'000LL;
+
+// The production latency clock (TSC once calibrated in main)
+inline long long nowNs() {
+    return BSocket::clockNs();
+}
+
+// CPU time of the calling thread
+inline long long threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1'000'000'000LL + ts.tv_nsec;
+}
+
+// Payloads start with a fixed-width send timestamp that is patched in place
+static constexpr std::string_view STAMP_PREFIX = "{\"sent_ns\":";
+static constexpr size_t STAMP_DIGITS = 19;
+
+// A JSON-looking message of exactly `bytes` bytes
+static std::string makeMessage(size_t bytes) {
+    std::string msg(STAMP_PREFIX);
+    msg.append(STAMP_DIGITS, '0');
+    msg += ",\"pad\":\"";
+    size_t tail = 2; // closing "}
+    if (bytes > msg.size() + tail) msg.append(bytes - msg.size() - tail, 'x');
+    msg += "\"}";
+    return msg;
+}
+
+static void stamp(std::string& msg, long long ns) {
+    char* digits = msg.data() + STAMP_PREFIX.size();
+    for (size_t i = STAMP_DIGITS; i-- > 0;) {
+        digits[i] = static_cast<char>('0' + ns % 10);
+        ns /= 10;
+    }
+}
+
+static long long sentAt(std::string_view payload) {
+    long long ns = 0;
+    if (payload.size() < STAMP_PREFIX.size() + STAMP_DIGITS) return 0;
+    const char* begin = payload.data() + STAMP_PREFIX.size();
+    std::from_chars(begin, begin + STAMP_DIGITS, ns);
+    return ns;
+}
+
+// Self-signed certificate for 127.0.0.1, generated in memory
+static void useSelfSignedCert(ssl::context& ctx) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    SSL_CTX_use_certificate(ctx.native_handle(), cert);
+    SSL_CTX_use_PrivateKey(ctx.native_handle(), key);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+// Accepts one client and echoes every message back until it closes
+class EchoServer {
+public:
+    explicit EchoServer(bool secure)
+        : secure(secure), sslCtx(ssl::context::tlsv12_server),
+          acceptor(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)) {
+        useSelfSignedCert(sslCtx);
+        thread = std::thread([this] { run(); });
+    }
+    ~EchoServer() {
+        if (thread.joinable()) thread.join();
+    }
+    std::string url() const {
+        return std::string(secure ? "wss" : "ws") + "://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port()) + "/";
+    }
+
+private:
+    void run() {
+        try {
+            tcp::socket socket(ioc);
+            acceptor.accept(socket);
+            socket.set_option(tcp::no_delay(true));
+            if (secure) {
+                websocket::stream<beast::ssl_stream<tcp::socket>> ws(std::move(socket), sslCtx);
+                ws.next_layer().handshake(ssl::stream_base::server);
+                echo(ws);
+            } else {
+                websocket::stream<tcp::socket> ws(std::move(socket));
+                echo(ws);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "EchoServer error: " << e.what() << std::endl;
+        }
+    }
+
+    template<typename Stream>
+    void echo(Stream& ws) {
+        ws.accept();
+        beast::flat_buffer buffer;
+        for (;;) {
+            beast::error_code ec;
+            ws.read(buffer, ec);
+            // The client's close is answered inside read()
+            if (ec) break;
+            ws.text(ws.got_text());
+            ws.write(buffer.data(), ec);
+            if (ec) break;
+            buffer.consume(buffer.size());
+        }
+    }
+
+    bool secure;
+    net::io_context ioc;
+    ssl::context sslCtx;
+    tcp::acceptor acceptor;
+    std::thread thread;
+};
+
+// Round trips, recorded from the client's reader thread
+struct EchoStats {
+    std::vector<long long> roundTrips;
+    std::atomic<int> received{0};
+    long long firstNs = 0;
+    long long lastNs = 0;
+    // Reader-thread CPU time between the first and last echo
+    long long firstCpuNs = 0;
+    long long lastCpuNs = 0;
+
+    explicit EchoStats(int count) { roundTrips.reserve(count); }
+
+    void onEcho(std::string_view payload, long long /*receivedNs*/) {
+        long long now = nowNs();
+        long long cpu = threadCpuNs();
+        if (received.load(std::memory_order_relaxed) == 0) {
+            firstNs = now;
+            firstCpuNs = cpu;
+        }
+        lastNs = now;
+        lastCpuNs = cpu;
+        roundTrips.push_back(now - sentAt(payload));
+        received.fetch_add(1, std::memory_order_release);
+    }
+};
+
+struct RunConfig {
+    const char* mode;
+    int count;
+    int ratePerSec; // paced mode only
+};
+
+static std::unique_ptr<BSocket> makeClient(const std::string& name) {
+    if (name == "csocket") return std::make_unique<CustomWebSocket::CSocket>();
+    if (name == "beast_socket") return std::make_unique<Socket>();
+#ifdef HAVE_SOCKETPP
+    if (name == "socketpp") return std::make_unique<Socketpp>();
+#endif
+#ifdef USE_URING
+    if (name == "uring_socket") return std::make_unique<CustomWebSocket::UringSocket>();
+#endif
+    return nullptr;
+}
+
+// Block until `count` echoes are in; false on timeout
+static bool waitFor(EchoStats& stats, int count, long long deadline) {
+    while (stats.received.load(std::memory_order_acquire) < count) {
+        if (nowNs() > deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+static void report(const std::string& client, bool secure, size_t bytes, const RunConfig& run, EchoStats& stats,
+                   long long senderCpuNs) {
+    std::vector<long long>& l = stats.roundTrips;
+    std::cout << "{\"event\":\"transport_suite_summary\""
+              << ",\"client\":\"" << client << "\""
+              << ",\"tls\":" << (secure ? "true" : "false")
+              << ",\"bytes\":" << bytes
+              << ",\"mode\":\"" << run.mode << "\"";
+    if (run.ratePerSec > 0) std::cout << ",\"rate\":" << run.ratePerSec;
+    std::cout << ",\"samples\":" << l.size() << ",\"expected\":" << run.count;
+    if (l.size() > 1) {
+        std::sort(l.begin(), l.end());
+        long long sum = 0;
+        for (long long v : l) sum += v;
+        double seconds = (stats.lastNs - stats.firstNs) / 1e9;
+        long long cpuNs = senderCpuNs + (stats.lastCpuNs - stats.firstCpuNs);
+        std::cout << ",\"msgs_per_sec\":" << (seconds > 0 ? static_cast<long long>((l.size() - 1) / seconds) : 0)
+                  << ",\"avg_ns\":" << sum / static_cast<long long>(l.size())
+                  << ",\"min_ns\":" << l.front()
+                  << ",\"p50_ns\":" << l[l.size() / 2]
+                  << ",\"p99_ns\":" << l[l.size() * 99 / 100]
+                  << ",\"p999_ns\":" << l[l.size() * 999 / 1000]
+                  << ",\"max_ns\":" << l.back()
+                  << ",\"cpu_ns_per_msg\":" << cpuNs / static_cast<long long>(l.size());
+    }
+    std::cout << "}" << std::endl;
+}
+
+static void runTransport(const std::string& name, bool secure, size_t bytes, const RunConfig& run) {
+    EchoServer server(secure);
+    EchoStats stats(run.count);
+    std::unique_ptr<BSocket> client = makeClient(name);
+    client->setMessageHandler(MessageHandler::bind<EchoStats, &EchoStats::onEcho>(&stats));
+    if (!client->connect(server.url())) {
+        std::cerr << name << " failed to connect to " << server.url() << std::endl;
+        return;
+    }
+    std::string msg = makeMessage(bytes);
+    long long deadline = nowNs() + TIMEOUT_NS;
+    long long intervalNs = run.ratePerSec > 0 ? 1'000'000'000LL / run.ratePerSec : 0;
+    long long senderCpuNs = 0;
+    long long start = nowNs();
+    bool ok = true;
+    for (int i = 0; i < run.count && ok; ++i) {
+        if (run.ratePerSec > 0) {
+            // Open loop: the schedule does not wait for the echoes
+            long long due = start + i * intervalNs;
+            while (nowNs() < due) std::this_thread::yield();
+        } else {
+            // Closed loop: at most 1 (pingpong) or WINDOW (flood) in flight
+            int inFlight = run.mode == std::string_view("pingpong") ? 1 : WINDOW;
+            ok = waitFor(stats, i - inFlight + 1, deadline);
+            if (!ok) break;
+        }
+        // Only the send itself counts toward the sender's CPU, not the waiting
+        long long cpuStart = threadCpuNs();
+        stamp(msg, nowNs());
+        ok = client->send(msg);
+        senderCpuNs += threadCpuNs() - cpuStart;
+    }
+    if (ok && !waitFor(stats, run.count, deadline)) {
+        std::cerr << name << " " << run.mode << ": timed out with " << stats.received << " of " << run.count << " echoes"
+                  << std::endl;
+    }
+    client->close();
+    report(name, secure, bytes, run, stats, senderCpuNs);
+}
+
+int main(int argc, char** argv) {
+    TscClock::start();
+    // Transports to compare; all built-in ones by default
+    std::vector<std::string> clients;
+    for (int i = 1; i < argc; ++i) clients.push_back(argv[i]);
+    if (clients.empty()) {
+        clients = {"csocket", "beast_socket"};
+#ifdef HAVE_SOCKETPP
+        clients.push_back("socketpp");
+#endif
+#ifdef USE_URING
+        clients.push_back("uring_socket");
+#endif
+    }
+    const RunConfig runs[] = {
+        {"pingpong", 10000, 0},
+        {"paced", 20000, 10000},
+        {"flood", 50000, 0},
+    };
+    // A small order, a book update and the largest message a Socket queue slot holds inline
+    const size_t sizes[] = {64, 512, 2048};
+    for (const std::string& name : clients) {
+        if (!makeClient(name)) {
+            std::cerr << "Unknown or unavailable transport: " << name << std::endl;
+            continue;
+        }
+        for (bool secure : {false, true}) {
+            // Socketpp is built on the TLS-only WebSocket++ config
+            if (!secure && name == "socketpp") continue;
+            for (size_t bytes : sizes) {
+                for (const RunConfig& run : runs) runTransport(name, secure, bytes, run);
+            }
+        }
+    }
+    return 0;
+}
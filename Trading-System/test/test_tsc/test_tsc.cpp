@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include "../../src/WebSocketpp/TscClock.hpp"
+
+// TSC clock benchmark. Calibrates, then compares the cost of one timestamp
+// (TscClock::nowNs against clock_gettime and the std::chrono clocks Api
+// used to call), and tracks TscClock against CLOCK_MONOTONIC and
+// CLOCK_REALTIME over a few seconds of recalibration, checking that readings
+// never go backwards.
+
+static constexpr int BATCH = 1000;
+static constexpr int BATCHES = 2000;
+static constexpr auto RECALIBRATE_EVERY = std::chrono::milliseconds(200);
+static constexpr auto TRACK_FOR = std::chrono::seconds(3);
+
+static void report(const char* mode, std::vector<long long>& l) {
+    std::sort(l.begin(), l.end());
+    long long sum = 0;
+    for (long long v : l) sum += v;
+    std::cout << "{\"event\":\"clock_bench_summary\",\"clock\":\"" << mode << "\""
+              << ",\"batches\":" << l.size()
+              << ",\"avg_ns\":" << sum / static_cast<long long>(l.size())
+              << ",\"p50_ns\":" << l[l.size() / 2]
+              << ",\"p99_ns\":" << l[l.size() * 99 / 100] << "}" << std::endl;
+}
+
+// Per-call cost, timed in batches on CLOCK_MONOTONIC
+template<typename Read>
+static void cost(const char* mode, Read read) {
+    std::vector<long long> perCall;
+    perCall.reserve(BATCHES);
+    long long sink = 0;
+    for (int b = 0; b < BATCHES; ++b) {
+        long long start = TscClock::monotonicNs();
+        for (int i = 0; i < BATCH; ++i) sink += read();
+        perCall.push_back((TscClock::monotonicNs() - start) / BATCH);
+    }
+    if (sink == 42) std::cout << "";
+    report(mode, perCall);
+}
+
+int main() {
+    bool tsc = TscClock::start(true, RECALIBRATE_EVERY);
+    std::cout << "{\"event\":\"tsc_calibration\",\"invariant_tsc\":" << (TscClock::invariantTsc() ? "true" : "false")
+              << ",\"using_tsc\":" << (tsc ? "true" : "false")
+              << ",\"ticks_per_us\":" << TscClock::ticksPerUs() << "}" << std::endl;
+
+    using namespace std::chrono;
+    cost("tsc", [] { return TscClock::nowNs(); });
+    cost("tsc_ordered", [] { return TscClock::nowNsOrdered(); });
+    cost("clock_gettime_monotonic", [] { return TscClock::monotonicNs(); });
+    cost("steady_clock", [] { return static_cast<long long>(steady_clock::now().time_since_epoch().count()); });
+    cost("high_resolution_clock", [] { return static_cast<long long>(high_resolution_clock::now().time_since_epoch().count()); });
+
+    // A reader checks monotonicity through the recalibrations while the main
+    // thread samples the error against the kernel clocks
+    std::atomic<bool> done{false};
+    long long backwards = 0;
+    long long reads = 0;
+    std::thread reader([&] {
+        long long last = TscClock::nowNs();
+        while (!done.load(std::memory_order_relaxed)) {
+            long long now = TscClock::nowNs();
+            if (now < last) ++backwards;
+            last = now;
+            ++reads;
+        }
+    });
+    long long maxError = 0;
+    long long maxWallError = 0;
+    int samples = 0;
+    auto end = steady_clock::now() + TRACK_FOR;
+    while (steady_clock::now() < end) {
+        // Bracket a TSC reading between two kernel readings
+        long long before = TscClock::monotonicNs();
+        long long tscNs = TscClock::nowNsOrdered();
+        long long after = TscClock::monotonicNs();
+        long long wall = TscClock::realtimeNs();
+        long long error = tscNs < before ? before - tscNs : tscNs > after ? tscNs - after : 0;
+        maxError = std::max(maxError, error);
+        long long wallError = TscClock::toWallNs(tscNs) - wall;
+        maxWallError = std::max(maxWallError, wallError < 0 ? -wallError : wallError);
+        ++samples;
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    done.store(true);
+    reader.join();
+    TscClock::stop();
+
+    std::cout << "{\"event\":\"tsc_tracking\",\"seconds\":" << duration_cast<seconds>(TRACK_FOR).count()
+              << ",\"samples\":" << samples
+              << ",\"max_error_ns\":" << maxError
+              << ",\"max_wall_error_ns\":" << maxWallError
+              << ",\"last_drift_ns\":" << TscClock::lastDriftNs()
+              << ",\"reads\":" << reads
+              << ",\"backwards\":" << backwards << "}" << std::endl;
+    // Within a few microseconds of the kernel clock (more under heavy
+    // preemption), and never backwards
+    return maxError < 50'000 && backwards == 0 ? 0 : 1;
+}